@@ -0,0 +1,47 @@
+#pragma once
+#include <QtCore>
+
+// ===============================================
+// bench/bench.h
+// 基准与核对工具：cloudmeeting-bench <名称> [--键 值 ...]
+// - 每项一个入口函数，在 main.cpp 的表中登记；返回 0 表示完成（核对类在不一致时返回 1）
+// - 需要控件的项在表中标记 gui，此时 main 创建 QApplication
+// - 结果统一以 "[BENCH 名称] ..." 行输出
+// ===============================================
+
+namespace Bench {
+
+// --key value 形式的参数；未给出时返回 def
+QString argStr(const QStringList& args, const QString& key, const QString& def = QString());
+int     argInt(const QStringList& args, const QString& key, int def);
+double  argDouble(const QStringList& args, const QString& key, double def);
+bool    hasFlag(const QStringList& args, const QString& key);
+
+// 耗时/时延样本（微秒），报告平均与分位
+struct Samples {
+    QVector<qint64> us;
+    void add(qint64 v) { us.push_back(v); }
+    int count() const { return us.size(); }
+    double avgMs() const;
+    double pctMs(double p) const;   // p 取 0..1；无样本返回 0
+};
+
+void report(const char* name, const QString& line);
+
+// 调用线程已消耗的 CPU 时间（毫秒，CLOCK_THREAD_CPUTIME_ID）；非 Linux 返回 -1
+double threadCpuMs();
+
+} // namespace Bench
+
+int benchBlockDiff(const QStringList& args);
+int benchForward(const QStringList& args);
+int benchFraming(const QStringList& args);
+int benchGuiTiles(const QStringList& args);
+int benchHubLoad(const QStringList& args);
+int benchJpeg(const QStringList& args);
+int benchReassembly(const QStringList& args);
+int benchRelayLoad(const QStringList& args);
+int benchScreenCodec(const QStringList& args);
+int benchScreenCorpus(const QStringList& args);
+int benchUdmLoss(const QStringList& args);
+int benchYuv(const QStringList& args);
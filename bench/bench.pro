@@ -0,0 +1,65 @@
+TEMPLATE = app
+TARGET   = cloudmeeting-bench
+
+# 基准与核对工具：直接编译被测的客户端/服务器源文件，不复制实现
+QT += core gui widgets network multimedia concurrent
+CONFIG += console c++17
+QMAKE_CXXFLAGS += -Wall
+macx: CONFIG -= app_bundle
+
+CLIENT_DIR = $$PWD/../client
+SERVER_DIR = $$PWD/../server/src
+
+# 与客户端相同：libjpeg-turbo 可用时 JpegCodec 走 TurboJPEG
+CONFIG += link_pkgconfig
+packagesExist(libturbojpeg) {
+    PKGCONFIG += libturbojpeg
+    DEFINES += HAVE_TURBOJPEG
+}
+
+include($$PWD/../common/common.pri)
+INCLUDEPATH += $$CLIENT_DIR/Headers/comm $$SERVER_DIR
+
+HEADERS += \
+    $$PWD/bench.h \
+    $$PWD/desktopseq.h \
+    $$CLIENT_DIR/Headers/comm/blockdiff.h \
+    $$CLIENT_DIR/Headers/comm/jpegcodec.h \
+    $$CLIENT_DIR/Headers/comm/motionsearch.h \
+    $$CLIENT_DIR/Headers/comm/screencodec.h \
+    $$CLIENT_DIR/Headers/comm/udpmedia.h \
+    $$CLIENT_DIR/Headers/comm/videosurface.h \
+    $$CLIENT_DIR/Headers/comm/yuvconvert.h \
+    $$SERVER_DIR/hubstats.h \
+    $$SERVER_DIR/retranscache.h \
+    $$SERVER_DIR/roomhub.h \
+    $$SERVER_DIR/roomshard.h \
+    $$SERVER_DIR/sendqueue.h \
+    $$SERVER_DIR/udprelay.h
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/desktopseq.cpp \
+    $$PWD/dirtyblocks.cpp \
+    $$PWD/guitiles.cpp \
+    $$PWD/hubload.cpp \
+    $$PWD/jpeg.cpp \
+    $$PWD/reasm.cpp \
+    $$PWD/relayload.cpp \
+    $$PWD/relaypath.cpp \
+    $$PWD/screendelta.cpp \
+    $$PWD/udmloss.cpp \
+    $$PWD/yuv.cpp \
+    $$CLIENT_DIR/Sources/comm/blockdiff.cpp \
+    $$CLIENT_DIR/Sources/comm/jpegcodec.cpp \
+    $$CLIENT_DIR/Sources/comm/motionsearch.cpp \
+    $$CLIENT_DIR/Sources/comm/screencodec.cpp \
+    $$CLIENT_DIR/Sources/comm/udpmedia.cpp \
+    $$CLIENT_DIR/Sources/comm/videosurface.cpp \
+    $$CLIENT_DIR/Sources/comm/yuvconvert.cpp \
+    $$SERVER_DIR/hubstats.cpp \
+    $$SERVER_DIR/retranscache.cpp \
+    $$SERVER_DIR/roomhub.cpp \
+    $$SERVER_DIR/roomshard.cpp \
+    $$SERVER_DIR/sendqueue.cpp \
+    $$SERVER_DIR/udprelay.cpp
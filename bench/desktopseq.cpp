@@ -0,0 +1,142 @@
+#include "desktopseq.h"
+
+namespace {
+
+quint32 nextRand(quint32& s)
+{
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+void fillRect(QImage& img, const QRect& r, QRgb c)
+{
+    const QRect q = r & img.rect();
+    for (int y = q.top(); y <= q.bottom(); ++y) {
+        QRgb* p = reinterpret_cast<QRgb*>(img.scanLine(y));
+        std::fill(p + q.left(), p + q.right() + 1, c);
+    }
+}
+
+// 8x14 的“字形”：随机竖笔画，近似文本的稀疏前景
+void drawGlyph(QImage& img, int x, int y, quint32& seed)
+{
+    const QRgb fg = qRgb(30, 30, 30);
+    for (int k = 0; k < 3; ++k) {
+        const int gx = x + 1 + int(nextRand(seed) % 6);
+        const int gy = y + 2 + int(nextRand(seed) % 4);
+        fillRect(img, QRect(gx, gy, 1 + int(nextRand(seed) % 2), 6 + int(nextRand(seed) % 5)), fg);
+    }
+}
+
+void drawTextLine(QImage& img, int y, int x0, int x1, quint32& seed)
+{
+    for (int x = x0; x + 8 <= x1; x += 9) {
+        if (nextRand(seed) % 7 == 0) continue;   // 词间空格
+        drawGlyph(img, x, y, seed);
+    }
+}
+
+// 照片类内容：随帧移动的平滑渐变叠加小幅噪声
+void drawPhoto(QImage& img, const QRect& r, int frame, quint32& seed)
+{
+    const QRect q = r & img.rect();
+    for (int y = q.top(); y <= q.bottom(); ++y) {
+        QRgb* p = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int x = q.left(); x <= q.right(); ++x) {
+            const int n = int(nextRand(seed) % 9) - 4;
+            const int u = x - q.left() + frame * 3, v = y - q.top() + frame;
+            p[x] = qRgb(qBound(0, 96 + (u % 256) / 2 + n, 255),
+                        qBound(0, 64 + (v % 256) / 2 + n, 255),
+                        qBound(0, 128 + ((u + v) % 256) / 4 + n, 255));
+        }
+    }
+}
+
+// 合成桌面：背景 + 任务栏 + 编辑器窗口（满屏文本）
+QImage makeDesktop(const QSize& sz, quint32 seed)
+{
+    QImage img(sz, QImage::Format_RGB32);
+    img.fill(qRgb(58, 110, 165));
+    const int W = sz.width(), H = sz.height();
+    fillRect(img, QRect(0, H - 40, W, 40), qRgb(32, 32, 32));
+    for (int i = 0; i < 8; ++i) fillRect(img, QRect(8 + i * 48, H - 36, 40, 32), qRgb(70 + i * 15, 70, 90));
+    fillRect(img, QRect(40, 30, W - 80, H - 100), qRgb(250, 250, 250));
+    fillRect(img, QRect(40, 30, W - 80, 28), qRgb(220, 220, 225));
+    for (int y = 70; y + 16 < H - 80; y += 16) drawTextLine(img, y, 60, W - 120, seed);
+    return img;
+}
+
+} // namespace
+
+namespace Bench {
+
+DesktopSequence::DesktopSequence(const QString& scene, const QSize& size, int frames)
+    : name_(scene), frames_(frames), seed_(quint32(size.width() * 131 + scene.size()))
+{
+    desk_ = makeDesktop(size, seed_);
+    win_ = QRect(100, 120, qMin(600, size.width() / 2), qMin(400, size.height() / 2));
+    if (scene == "video") {
+        fillRect(desk_, win_.adjusted(-4, -28, 4, 4), qRgb(45, 45, 48));   // 播放器窗口边框与标题栏
+    }
+    cur_ = desk_.copy();
+}
+
+DesktopSequence::DesktopSequence(const QString& dir, int frames)
+    : name_(QDir(dir).dirName()), frames_(frames), dir_(dir)
+{
+    files_ = QDir(dir).entryList({"*.png", "*.bmp", "*.jpg"}, QDir::Files, QDir::Name);
+}
+
+bool DesktopSequence::next(QImage& out)
+{
+    if (produced_ > frames_) return false;
+    if (!dir_.isEmpty()) {
+        while (fileIdx_ < files_.size()) {
+            QImage img(QDir(dir_).filePath(files_.at(fileIdx_++)));
+            if (img.isNull()) continue;
+            img = img.convertToFormat(QImage::Format_RGB32);
+            if (!size_.isEmpty() && img.size() != size_) continue;
+            size_ = img.size();
+            out = img;
+            ++produced_;
+            return true;
+        }
+        return false;
+    }
+    if (produced_ > 0 || name_ == "video") step();
+    out = cur_.copy();
+    ++produced_;
+    return true;
+}
+
+void DesktopSequence::step()
+{
+    const int W = cur_.width(), H = cur_.height();
+    if (name_ == "typing") {
+        for (int k = 0; k < 3; ++k) {
+            fillRect(cur_, QRect(caretX_, caretY_, 9, 16), qRgb(250, 250, 250));
+            drawGlyph(cur_, caretX_, caretY_, seed_);
+            caretX_ += 9;
+            if (caretX_ + 8 > W - 120) { caretX_ = 60; caretY_ += 16; }
+        }
+    } else if (name_ == "scroll") {
+        const int top = 70, bottom = H - 100, dy = 16;
+        for (int y = top; y + dy < bottom; ++y)
+            memcpy(cur_.scanLine(y) + 40 * 4, cur_.constScanLine(y + dy) + 40 * 4, size_t(W - 80) * 4);
+        fillRect(cur_, QRect(40, bottom - dy, W - 80, dy), qRgb(250, 250, 250));
+        drawTextLine(cur_, bottom - dy, 60, W - 120, seed_);
+    } else if (name_ == "drag") {
+        // 还原旧位置下的桌面，再在新位置画窗口
+        for (int y = win_.top(); y <= win_.bottom(); ++y)
+            memcpy(cur_.scanLine(y) + win_.left() * 4, desk_.constScanLine(y) + win_.left() * 4,
+                   size_t(win_.width()) * 4);
+        win_.translate(8, produced_ % 2 ? 4 : 0);
+        if (win_.right() >= W || win_.bottom() >= H - 40) win_.moveTo(100, 120);
+        fillRect(cur_, win_, qRgb(240, 240, 240));
+        fillRect(cur_, QRect(win_.left(), win_.top(), win_.width(), 24), qRgb(60, 90, 160));
+    } else if (name_ == "video") {
+        drawPhoto(cur_, win_, produced_, seed_);
+    }
+}
+
+} // namespace Bench
@@ -0,0 +1,44 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+// ===============================================
+// bench/desktopseq.h
+// 桌面帧序列（blockdiff / screen-codec / screen-corpus 共用）
+// - 合成场景：static 不变；typing 每帧追加 3 个字形；scroll 文本区上移 16 行；
+//   drag 600x400 窗口每帧平移；video 窗口内播放照片类内容（平滑渐变 + 噪声，逐帧变化）
+// - 合成桌面只用纯色块与“字形”小块，贴近截屏内容的平坦色区
+// - 录制场景：目录下按文件名排序的 PNG/BMP/JPG，尺寸与首帧不同的跳过
+// ===============================================
+
+namespace Bench {
+
+class DesktopSequence {
+public:
+    DesktopSequence(const QString& scene, const QSize& size, int frames);   // 合成
+    DesktopSequence(const QString& dir, int frames);                        // 录制
+
+    QString name() const { return name_; }
+
+    // 依次给出初始参考帧与其后 frames 帧（逐帧产生，4K 整段放不进内存）；结束返回 false
+    // 每帧都是独立的深拷贝，计时中不会发生隐式共享分离
+    bool next(QImage& out);
+
+    static QStringList scenes() { return { "static", "typing", "scroll", "drag", "video" }; }
+
+private:
+    void step();
+
+    QString name_;
+    int frames_ = 0, produced_ = 0;
+    quint32 seed_ = 1;
+    QImage desk_, cur_;
+    int caretX_ = 60, caretY_ = 70 + 16 * 10;
+    QRect win_;
+    QString dir_;
+    QStringList files_;
+    int fileIdx_ = 0;
+    QSize size_;
+};
+
+} // namespace Bench
@@ -0,0 +1,110 @@
+#include "bench.h"
+#include "blockdiff.h"
+#include "desktopseq.h"
+
+// BlockDiff 计时与核对：1280x720 / 1920x1080 / 3840x2160，每种尺寸回放 desktopseq.h 的各场景，
+// --dir 可改为回放录制的帧序列
+// - legacy：基线逐块逐行 memcmp（仅保留在此用于对比）；Compare/Hash 为 BlockDiff 两种模式
+// - Compare 位图须与 legacy 完全一致；Hash 位图与 legacy 的差异（哈希碰撞）单独列出
+namespace {
+
+using Bench::DesktopSequence;
+
+// 基线：逐块、块内逐行 memcmp
+int legacyDetect(const QImage& prev, const QImage& curr, int bs, QVector<quint8>& dirty)
+{
+    const int W = curr.width(), H = curr.height();
+    const int bx = (W + bs - 1) / bs, by = (H + bs - 1) / bs;
+    dirty.fill(0, bx * by);
+    int count = 0;
+    for (int gy = 0; gy < by; ++gy) {
+        for (int gx = 0; gx < bx; ++gx) {
+            const int x = gx * bs, y = gy * bs;
+            const int w = qMin(bs, W - x), h = qMin(bs, H - y);
+            for (int row = 0; row < h; ++row) {
+                if (memcmp(prev.constScanLine(y + row) + x * 4, curr.constScanLine(y + row) + x * 4, size_t(w) * 4)) {
+                    dirty[gy * bx + gx] = 1;
+                    ++count;
+                    break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int countDiff(const QVector<quint8>& a, const QVector<quint8>& b)
+{
+    if (a.size() != b.size()) return qMax(a.size(), b.size());
+    int n = 0;
+    for (int i = 0; i < a.size(); ++i) n += (a[i] != 0) != (b[i] != 0);
+    return n;
+}
+
+// 回放一段序列，返回 Compare 与 legacy 位图不一致的帧数
+int runSequence(DesktopSequence& seq, int block, const QString& label)
+{
+    QImage prev, curr;
+    if (!seq.next(prev)) return 0;
+    Bench::Samples legacy, compare, hash;
+    BlockDiff cmp, hsh;
+    hsh.setMode(BlockDiff::Hash);
+    QVector<quint8> dl, dc, dh;
+    hsh.detect(QImage(), prev, block, dh);   // 以首帧建立哈希缓存
+    int n = 0, mismatch = 0, collisions = 0;
+    qint64 dirtyBlocks = 0;
+    while (seq.next(curr)) {
+        QElapsedTimer t; t.start();
+        dirtyBlocks += legacyDetect(prev, curr, block, dl);
+        legacy.add(t.nsecsElapsed() / 1000);
+        t.restart();
+        cmp.detect(prev, curr, block, dc);
+        compare.add(t.nsecsElapsed() / 1000);
+        t.restart();
+        hsh.detect(prev, curr, block, dh);
+        hash.add(t.nsecsElapsed() / 1000);
+        if (countDiff(dl, dc)) ++mismatch;
+        collisions += countDiff(dl, dh);
+        prev = curr;
+        ++n;
+    }
+    if (n == 0) return 0;
+    const QSize sz = prev.size();
+    const int blocks = ((sz.width() + block - 1) / block) * ((sz.height() + block - 1) / block);
+    Bench::report("blockdiff", QString("%1 %2x%3 %4 frames=%5 dirty=%6% legacy=%7ms compare=%8ms (%9x) hash=%10ms (%11x) "
+                                       "compareMismatch=%12 hashMiss=%13 %14")
+                  .arg(label, -8).arg(sz.width()).arg(sz.height()).arg(seq.name(), -7).arg(n)
+                  .arg(100.0 * dirtyBlocks / (double(blocks) * n), 0, 'f', 1)
+                  .arg(legacy.avgMs(), 0, 'f', 3).arg(compare.avgMs(), 0, 'f', 3)
+                  .arg(compare.avgMs() > 0 ? legacy.avgMs() / compare.avgMs() : 0.0, 0, 'f', 1)
+                  .arg(hash.avgMs(), 0, 'f', 3)
+                  .arg(hash.avgMs() > 0 ? legacy.avgMs() / hash.avgMs() : 0.0, 0, 'f', 1)
+                  .arg(mismatch).arg(collisions).arg(mismatch ? "FAIL" : "OK"));
+    return mismatch;
+}
+
+} // namespace
+
+int benchBlockDiff(const QStringList& args)
+{
+    const int frames = qMax(1, Bench::argInt(args, "--frames", 30));
+    const int block  = qMax(8, Bench::argInt(args, "--block", 32));
+    const QString dir = Bench::argStr(args, "--dir");
+    int failures = 0;
+
+    Bench::report("blockdiff", QString("isa=%1 block=%2").arg(BlockDiff::isaName()).arg(block));
+    if (!dir.isEmpty()) {
+        DesktopSequence seq(dir, frames);
+        return runSequence(seq, block, "recorded") ? 1 : 0;
+    }
+
+    const QSize sizes[] = { QSize(1280, 720), QSize(1920, 1080), QSize(3840, 2160) };
+    const char* labels[] = { "720p", "1080p", "4K" };
+    for (int k = 0; k < 3; ++k) {
+        for (const QString& scene : DesktopSequence::scenes()) {
+            DesktopSequence seq(scene, sizes[k], frames);
+            if (runSequence(seq, block, QLatin1String(labels[k]))) ++failures;
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+#include <QtWidgets>
+#include "bench.h"
+#include "videosurface.h"
+
+// 九宫格视频显示的 GUI 线程开销：9 格按 --fps 错开送帧，统计 GUI 线程 CPU 毫秒/秒
+// - setpixmap：基线 QPixmap::fromImage + 平滑缩放 + QLabel::setPixmap（原 fitLabelImage，仅保留在此用于对比）
+// - surface：VideoSurface::setFrame，缩放推迟到 paintEvent 并按尺寸缓存
+// 默认送入按显示尺寸合成好的帧（与 MainWindow 按 frameTarget/控件尺寸合成一致）；--raw 改为直接送 640x480 源帧
+// 格子的尺寸、边框与对齐同 MainWindow 的 makeTile；未设置 QT_QPA_PLATFORM 时用 offscreen 平台
+// 核对：结束时每格中心像素与最后送入帧的中心像素每通道相差不超过 kTolerance
+namespace {
+
+const int kTiles = 9;
+const int kFramesPerTile = 8;   // 每格轮流送入的不同帧（cacheKey 各不相同）
+const int kTolerance = 24;
+
+// 基线：每帧转换并缩放成 QPixmap 后 setPixmap
+void fitLabelImage(QLabel* lbl, const QImage& img)
+{
+    if (!lbl) return;
+    if (img.isNull()) { lbl->clear(); return; }
+    const QSize s = lbl->size();
+    if (s.width() < 2 || s.height() < 2) return;
+    QPixmap pm = QPixmap::fromImage(img).scaled(s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    lbl->setPixmap(pm);
+    lbl->setText(QString());
+}
+
+// 平滑渐变，缩放后中心像素仍可核对；蓝色通道区分格子与帧
+QImage makeFrame(const QSize& sz, int tile, int n)
+{
+    QImage img(sz, QImage::Format_RGB32);
+    const int b = 30 + (tile * 25 + n * 12) % 200;
+    for (int y = 0; y < sz.height(); ++y) {
+        QRgb* p = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int x = 0; x < sz.width(); ++x)
+            p[x] = qRgb(40 + x * 160 / sz.width(), 40 + y * 160 / sz.height(), b);
+    }
+    return img;
+}
+
+void settle(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+bool closeTo(QRgb a, QRgb b)
+{
+    return qAbs(qRed(a) - qRed(b)) <= kTolerance && qAbs(qGreen(a) - qGreen(b)) <= kTolerance
+        && qAbs(qBlue(a) - qBlue(b)) <= kTolerance;
+}
+
+struct RunResult {
+    double seconds = 0;
+    double cpuMs = -1;
+    qint64 delivered = 0;
+    QSize tile, src;
+    int bad = 0;
+};
+
+RunResult runMode(bool surface, const QSize& win, int fps, int seconds, bool raw)
+{
+    RunResult r;
+    QWidget window;
+    auto* grid = new QGridLayout(&window);
+    grid->setContentsMargins(2, 2, 2, 2);
+    grid->setSpacing(4);
+    QVector<QLabel*> tiles;
+    for (int i = 0; i < kTiles; ++i) {
+        QLabel* l = surface ? new VideoSurface(QStringLiteral("等待视频/屏幕..."), &window)
+                            : new QLabel(QStringLiteral("等待视频/屏幕..."), &window);
+        l->setMinimumSize(200, 150);
+        l->setStyleSheet("border:1px solid #888;");
+        l->setAlignment(Qt::AlignCenter);
+        l->setScaledContents(false);
+        l->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+        grid->addWidget(l, i / 3, i % 3);
+        tiles.push_back(l);
+    }
+    window.resize(win);
+    window.show();
+    settle(200);   // 等布局与首次绘制完成
+
+    // 各格的帧：默认为合成尺寸（surface 取 frameTarget，基线取控件尺寸，与各自调用方一致）
+    QVector<QVector<QImage>> frames(kTiles);
+    for (int i = 0; i < kTiles; ++i) {
+        const QSize sz = raw ? QSize(640, 480)
+                       : surface ? static_cast<VideoSurface*>(tiles[i])->frameTarget() : tiles[i]->size();
+        for (int n = 0; n < kFramesPerTile; ++n) frames[i].push_back(makeFrame(sz, i, n));
+    }
+    r.tile = tiles[0]->size();
+    r.src = frames[0][0].size();
+
+    // 按格轮流送帧，9 路到达时刻错开
+    QVector<int> last(kTiles, -1);
+    qint64 tick = 0;
+    QTimer feed;
+    feed.setTimerType(Qt::PreciseTimer);
+    feed.setInterval(qMax(1, 1000 / (fps * kTiles)));
+    QObject::connect(&feed, &QTimer::timeout, &feed, [&]{
+        const int i = int(tick % kTiles), n = int((tick / kTiles) % kFramesPerTile);
+        if (surface) static_cast<VideoSurface*>(tiles[i])->setFrame(frames[i][n]);
+        else fitLabelImage(tiles[i], frames[i][n]);
+        last[i] = n;
+        ++tick;
+    });
+
+    const double cpu0 = Bench::threadCpuMs();
+    QElapsedTimer clock; clock.start();
+    feed.start();
+    settle(seconds * 1000);
+    feed.stop();
+    const double cpu1 = Bench::threadCpuMs();
+    r.seconds = clock.nsecsElapsed() / 1e9;
+    if (cpu0 >= 0 && cpu1 >= 0) r.cpuMs = cpu1 - cpu0;
+    r.delivered = tick;
+
+    settle(100);
+    for (int i = 0; i < kTiles; ++i) {
+        if (last[i] < 0) { ++r.bad; continue; }
+        const QImage shot = tiles[i]->grab().toImage().convertToFormat(QImage::Format_RGB32);
+        const QImage& f = frames[i][last[i]];
+        const QRgb want = f.pixel(f.width() / 2, f.height() / 2);
+        const QRect cr = tiles[i]->contentsRect();
+        if (shot.isNull() || !closeTo(shot.pixel(cr.center()), want)) ++r.bad;
+    }
+    return r;
+}
+
+} // namespace
+
+int benchGuiTiles(const QStringList& args)
+{
+    const int fps     = qBound(1, Bench::argInt(args, "--fps", 15), 60);
+    const int seconds = qMax(1, Bench::argInt(args, "--seconds", 5));
+    const QSize win(Bench::argInt(args, "--w", 1280), Bench::argInt(args, "--h", 800));
+    const bool raw = Bench::hasFlag(args, "--raw");
+
+    Bench::report("gui-tiles", QString("platform=%1 tiles=%2 fps=%3 window=%4x%5 seconds=%6 src=%7")
+                  .arg(QGuiApplication::platformName()).arg(kTiles).arg(fps)
+                  .arg(win.width()).arg(win.height()).arg(seconds).arg(raw ? "raw" : "composed"));
+    int failures = 0;
+    for (bool surface : { false, true }) {
+        const RunResult r = runMode(surface, win, fps, seconds, raw);
+        if (r.bad) ++failures;
+        Bench::report("gui-tiles", QString("%1 tile=%2x%3 src=%4x%5 frames=%6/s gui cpu=%7 %8")
+                      .arg(surface ? "surface  " : "setpixmap")
+                      .arg(r.tile.width()).arg(r.tile.height()).arg(r.src.width()).arg(r.src.height())
+                      .arg(r.seconds > 0 ? r.delivered / r.seconds : 0.0, 0, 'f', 1)
+                      .arg(r.cpuMs >= 0 ? QString("%1ms/s").arg(r.cpuMs / r.seconds, 0, 'f', 1) : QString("n/a"))
+                      .arg(r.bad ? QString("FAIL(%1 tiles)").arg(r.bad) : QString("OK")));
+    }
+    return failures ? 1 : 0;
+}
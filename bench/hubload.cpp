@@ -0,0 +1,221 @@
+#include <QtNetwork>
+#include "bench.h"
+#include "protocol.h"
+#include "roomhub.h"
+
+// RoomHub 压测：数百个 TCP 客户端分布在多个房间，每房间若干发送者按帧率发 v1 视频帧
+// - 默认在进程内启动 RoomHub（--shards），也可用 --host/--port 压外部 cloudmeeting-hub
+// - 客户端分摊到 --threads 个生成线程；帧 bin 前 8 字节为发送时刻（进程内单调时钟），
+//   接收端据此统计端到端扇出时延（发送 -> 中继 -> 接收）
+// - 测量窗口内按 /proc/stat 统计每个 CPU 核的占用（仅 Linux）
+namespace {
+
+struct LoadConfig {
+    QString host;
+    quint16 port = 0;
+    int clients = 0, rooms = 0, senders = 0, fps = 0, bin = 0;
+};
+
+class LoadWorker : public QObject {
+public:
+    LoadWorker(const LoadConfig& cfg, int first, int count, const QElapsedTimer* clock)
+        : cfg_(cfg), first_(first), count_(count), clock_(clock) {}
+
+    // 以下在生成线程内调用
+    void start() {
+        for (int i = first_; i < first_ + count_; ++i) {
+            Client* c = new Client;
+            c->room = i % cfg_.rooms;
+            c->sender = i / cfg_.rooms < cfg_.senders;
+            c->sock = new QTcpSocket(this);
+            c->sock->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            connect(c->sock, &QTcpSocket::connected, this, [c]{
+                const QJsonObject j{{"roomId", QString("load-%1").arg(c->room)},
+                                    {"user", QString("u%1").arg(quintptr(c))}, {"proto", 1}};
+                c->sock->write(buildPacket(MSG_JOIN_WORKORDER, j));
+            });
+            connect(c->sock, &QTcpSocket::readyRead, this, [this, c]{ onReadyRead(c); });
+            c->sock->connectToHost(cfg_.host, cfg_.port);
+            clients_.push_back(c);
+        }
+        pace_ = new QTimer(this);
+        pace_->setInterval(1000 / qMax(1, cfg_.fps));
+        connect(pace_, &QTimer::timeout, this, [this]{ sendFrames(); });
+        pace_->start();
+    }
+    void setMeasuring(bool on) { measuring_ = on; }
+    void stop() {
+        pace_->stop();
+        for (Client* c : clients_) { c->sock->abort(); delete c; }
+        clients_.clear();
+    }
+
+    // 生成线程结束后读取
+    QVector<qint64> latencyUs;
+    qint64 sent = 0, received = 0, connected = 0;
+
+private:
+    struct Client {
+        QTcpSocket* sock = nullptr;
+        RecvBuffer rx;
+        int room = 0;
+        bool sender = false;
+    };
+
+    void sendFrames() {
+        connected = 0;
+        for (Client* c : clients_) {
+            if (c->sock->state() != QAbstractSocket::ConnectedState) continue;
+            ++connected;
+            if (!c->sender || c->sock->bytesToWrite() > 1024 * 1024) continue;  // 发送端自身积压时跳过
+            QByteArray bin(cfg_.bin, 'x');
+            qToBigEndian<qint64>(clock_->nsecsElapsed(), reinterpret_cast<uchar*>(bin.data()));
+            const QJsonObject j{{"roomId", QString("load-%1").arg(c->room)}, {"sender", "load"},
+                                {"media", "camera"}, {"w", 640}, {"h", 480}};
+            c->sock->write(buildPacket(MSG_VIDEO_FRAME, j, bin));
+            if (measuring_) ++sent;
+        }
+    }
+    void onReadyRead(Client* c) {
+        c->rx.append(c->sock->readAll());
+        QVector<PacketView> pkts;
+        if (!drainPacketViews(c->rx, pkts)) return;
+        const qint64 now = clock_->nsecsElapsed();
+        for (const PacketView& p : pkts) {
+            if (p.type != MSG_VIDEO_FRAME || p.bin.size() < 8 || !measuring_) continue;
+            const qint64 t = qFromBigEndian<qint64>(reinterpret_cast<const uchar*>(p.bin.constData()));
+            latencyUs.push_back((now - t) / 1000);
+            ++received;
+        }
+    }
+
+    LoadConfig cfg_;
+    int first_, count_;
+    const QElapsedTimer* clock_;
+    QVector<Client*> clients_;
+    QTimer* pace_ = nullptr;
+    bool measuring_ = false;   // 仅生成线程读写
+};
+
+// /proc/stat 中每个 cpuN 的 [忙, 总] 时钟数
+QVector<QPair<quint64, quint64>> cpuTimes()
+{
+    QVector<QPair<quint64, quint64>> out;
+#ifdef Q_OS_LINUX
+    QFile f("/proc/stat");
+    if (!f.open(QIODevice::ReadOnly)) return out;
+    for (const QByteArray& line : f.readAll().split('\n')) {
+        if (!line.startsWith("cpu") || line.size() < 4 || line.at(3) < '0' || line.at(3) > '9') continue;
+        const QList<QByteArray> v = line.simplified().split(' ');
+        quint64 total = 0, idle = 0;
+        for (int i = 1; i < v.size(); ++i) {
+            const quint64 x = v.at(i).toULongLong();
+            total += x;
+            if (i == 4 || i == 5) idle += x;   // idle + iowait
+        }
+        out.push_back(qMakePair(total - idle, total));
+    }
+#endif
+    return out;
+}
+
+} // namespace
+
+int benchHubLoad(const QStringList& args)
+{
+    LoadConfig cfg;
+    cfg.host    = Bench::argStr(args, "--host", "127.0.0.1");
+    cfg.port    = quint16(Bench::argInt(args, "--port", 19000));
+    cfg.clients = qMax(1, Bench::argInt(args, "--clients", 300));
+    cfg.rooms   = qBound(1, Bench::argInt(args, "--rooms", 30), cfg.clients);
+    cfg.senders = qMax(1, Bench::argInt(args, "--senders", 1));
+    cfg.fps     = qBound(1, Bench::argInt(args, "--fps", 15), 100);
+    cfg.bin     = qMax(8, Bench::argInt(args, "--bin", 20000));
+    const int threads = qBound(1, Bench::argInt(args, "--threads", 2), 64);
+    const int seconds = qMax(1, Bench::argInt(args, "--seconds", 10));
+    const bool external = Bench::hasFlag(args, "--host");
+
+    QScopedPointer<RoomHub> hub;
+    if (!external) {
+        hub.reset(new RoomHub);
+        if (!hub->start(cfg.port, Bench::argInt(args, "--shards", 0))) return 1;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    QVector<QThread*> gens;
+    QVector<LoadWorker*> workers;
+    for (int t = 0; t < threads; ++t) {
+        const int first = cfg.clients * t / threads, last = cfg.clients * (t + 1) / threads;
+        auto* th = new QThread;
+        th->setObjectName(QString("load-gen-%1").arg(t));
+        auto* w = new LoadWorker(cfg, first, last - first, &clock);
+        w->moveToThread(th);
+        th->start();
+        QMetaObject::invokeMethod(w, [w]{ w->start(); }, Qt::QueuedConnection);
+        gens.push_back(th);
+        workers.push_back(w);
+    }
+
+    // 1 秒预热（连接、加入、迁移到房间所在分片），之后进入测量窗口
+    QEventLoop loop;
+    QTimer::singleShot(1000, &loop, &QEventLoop::quit);
+    loop.exec();
+    for (LoadWorker* w : workers) QMetaObject::invokeMethod(w, [w]{ w->setMeasuring(true); }, Qt::QueuedConnection);
+    const auto cpu0 = cpuTimes();
+    QElapsedTimer window; window.start();
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+    const auto cpu1 = cpuTimes();
+    const double windowS = window.nsecsElapsed() / 1e9;
+    const QJsonObject hubStats = hub ? hub->statsJson() : QJsonObject();
+
+    for (int t = 0; t < threads; ++t) {
+        LoadWorker* w = workers[t];
+        QMetaObject::invokeMethod(w, [w]{ w->setMeasuring(false); w->stop(); }, Qt::BlockingQueuedConnection);
+        gens[t]->quit();
+        gens[t]->wait();
+    }
+
+    Bench::Samples latency;
+    qint64 sent = 0, received = 0, connected = 0;
+    for (LoadWorker* w : workers) {
+        latency.us += w->latencyUs;
+        sent += w->sent;
+        received += w->received;
+        connected += w->connected;
+        delete w;
+    }
+    qDeleteAll(gens);
+
+    const int perRoom = (cfg.clients + cfg.rooms - 1) / cfg.rooms;
+    const qint64 expected = sent * (perRoom - 1);
+    Bench::report("hub-load", QString("clients=%1 (connected %2) rooms=%3 senders/room=%4 fps=%5 bin=%6 threads=%7 window=%8s %9")
+                  .arg(cfg.clients).arg(connected).arg(cfg.rooms).arg(cfg.senders).arg(cfg.fps).arg(cfg.bin)
+                  .arg(threads).arg(windowS, 0, 'f', 1).arg(external ? "external hub" : "in-process hub"));
+    Bench::report("hub-load", QString("frames sent=%1 (%2/s) received=%3 (%4/s, ~%5% of fan-out)")
+                  .arg(sent).arg(sent / windowS, 0, 'f', 0).arg(received).arg(received / windowS, 0, 'f', 0)
+                  .arg(expected > 0 ? 100.0 * received / expected : 0.0, 0, 'f', 1));
+    Bench::report("hub-load", QString("end-to-end fan-out latency avg=%1ms p50=%2ms p99=%3ms max=%4ms")
+                  .arg(latency.avgMs(), 0, 'f', 2).arg(latency.pctMs(0.50), 0, 'f', 2)
+                  .arg(latency.pctMs(0.99), 0, 'f', 2).arg(latency.pctMs(1.0), 0, 'f', 2));
+    if (hub) {
+        const QJsonArray shards = hubStats.value("shards").toArray();
+        for (int i = 0; i < shards.size(); ++i) {
+            const QJsonObject s = shards.at(i).toObject();
+            const QJsonObject f = s.value("fanout").toObject();
+            Bench::report("hub-load", QString("shard %1 clients=%2 drops=%3 broadcast p50<=%4us p99<=%5us")
+                          .arg(i).arg(s.value("clients").toInt()).arg(s.value("drops").toDouble())
+                          .arg(f.value("p50Us").toDouble()).arg(f.value("p99Us").toDouble()));
+        }
+    }
+    if (cpu0.size() == cpu1.size() && !cpu0.isEmpty()) {
+        QStringList cores;
+        for (int i = 0; i < cpu0.size(); ++i) {
+            const quint64 busy = cpu1[i].first - cpu0[i].first, total = cpu1[i].second - cpu0[i].second;
+            cores << QString("%1:%2%").arg(i).arg(total ? 100.0 * busy / total : 0.0, 0, 'f', 0);
+        }
+        Bench::report("hub-load", "cpu busy per core " + cores.join(' '));
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "bench.h"
+#include "desktopseq.h"
+#include "jpegcodec.h"
+
+// JpegCodec 对比基线 QImageWriter/QImageReader（每帧新建 QBuffer/QByteArray，解码后 convertToFormat）
+// - 分辨率取项目实际使用的：摄像头 640x480 / 480x360 / 320x240（按会议人数），屏幕关键帧 1280x720 / 1920x1080
+// - 摄像头内容为照片类合成图，屏幕内容为 desktopseq.h 的合成桌面
+// - encode：RGB32 直接编码，输出缓冲复用；encodeI420：三平面直接编码（对比先转 RGB 再走基线）
+// - decode：解到复用的 RGB32 目标图；thumb：解到 320x180 以内（JpegCodec 用 DCT 缩放，基线全尺寸解码后平滑缩放）
+// - 核对：解码尺寸正确，且与原图的平均误差不比基线大 1.5 以上
+namespace {
+
+quint32 nextRand(quint32& s)
+{
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+QImage makeCameraFrame(const QSize& sz, int n)
+{
+    QImage img(sz, QImage::Format_RGB32);
+    quint32 seed = quint32(n * 977 + 1);
+    for (int y = 0; y < sz.height(); ++y) {
+        QRgb* p = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int x = 0; x < sz.width(); ++x) {
+            const int e = int(nextRand(seed) % 13) - 6;
+            const int cx = x - sz.width() / 2, cy = y - sz.height() / 3;
+            const int face = cx * cx + cy * cy < sz.height() * sz.height() / 16 ? 60 : 0;   // 近似人脸的亮区
+            p[x] = qRgb(qBound(0, 70 + face + x * 100 / sz.width() + e, 255),
+                        qBound(0, 60 + face / 2 + y * 80 / sz.height() + e, 255),
+                        qBound(0, 50 + (x + y + n * 4) % 64 + e, 255));
+        }
+    }
+    return img;
+}
+
+// BT.601 有限范围 RGB32 -> I420（2x2 取平均色度）
+void toI420(const QImage& img, QByteArray planes[3])
+{
+    const int w = img.width(), h = img.height();
+    planes[0] = QByteArray(w * h, Qt::Uninitialized);
+    planes[1] = QByteArray((w / 2) * (h / 2), Qt::Uninitialized);
+    planes[2] = QByteArray((w / 2) * (h / 2), Qt::Uninitialized);
+    uchar* py = reinterpret_cast<uchar*>(planes[0].data());
+    uchar* pu = reinterpret_cast<uchar*>(planes[1].data());
+    uchar* pv = reinterpret_cast<uchar*>(planes[2].data());
+    for (int y = 0; y < h; ++y) {
+        const QRgb* s = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        for (int x = 0; x < w; ++x)
+            py[y * w + x] = uchar((66 * qRed(s[x]) + 129 * qGreen(s[x]) + 25 * qBlue(s[x]) + 128) / 256 + 16);
+    }
+    for (int y = 0; y < h / 2; ++y) {
+        const QRgb* s0 = reinterpret_cast<const QRgb*>(img.constScanLine(2 * y));
+        const QRgb* s1 = reinterpret_cast<const QRgb*>(img.constScanLine(2 * y + 1));
+        for (int x = 0; x < w / 2; ++x) {
+            const QRgb q[4] = { s0[2 * x], s0[2 * x + 1], s1[2 * x], s1[2 * x + 1] };
+            int r = 0, g = 0, b = 0;
+            for (QRgb c : q) { r += qRed(c); g += qGreen(c); b += qBlue(c); }
+            r /= 4; g /= 4; b /= 4;
+            pu[y * (w / 2) + x] = uchar((-38 * r - 74 * g + 112 * b + 128) / 256 + 128);
+            pv[y * (w / 2) + x] = uchar((112 * r - 94 * g - 18 * b + 128) / 256 + 128);
+        }
+    }
+}
+
+// 平均每通道绝对误差
+double meanAbsError(const QImage& a, const QImage& b)
+{
+    if (a.size() != b.size() || a.isNull()) return 255.0;
+    qint64 sum = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const QRgb* p = reinterpret_cast<const QRgb*>(a.constScanLine(y));
+        const QRgb* q = reinterpret_cast<const QRgb*>(b.constScanLine(y));
+        for (int x = 0; x < a.width(); ++x)
+            sum += qAbs(qRed(p[x]) - qRed(q[x])) + qAbs(qGreen(p[x]) - qGreen(q[x])) + qAbs(qBlue(p[x]) - qBlue(q[x]));
+    }
+    return double(sum) / (3.0 * a.width() * a.height());
+}
+
+// 基线编码：每帧新建缓冲与 QImageWriter
+QByteArray legacyEncode(const QImage& img, int quality)
+{
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "jpeg");
+    writer.setQuality(quality);
+    writer.setOptimizedWrite(true);
+    if (!writer.write(img)) return QByteArray();
+    buffer.close();
+    return jpeg;
+}
+
+// 基线解码：QImageReader + convertToFormat(RGB32)
+QImage legacyDecode(const QByteArray& jpeg)
+{
+    QByteArray data = jpeg;
+    QBuffer buf(&data);
+    buf.open(QIODevice::ReadOnly);
+    QImageReader reader(&buf, "jpeg");
+    reader.setAutoTransform(true);
+    return reader.read().convertToFormat(QImage::Format_RGB32);
+}
+
+struct Case {
+    const char* label;
+    QSize size;
+    int quality;   // 与客户端实际取值一致：摄像头按会议人数，屏幕关键帧 60
+    bool screen;
+};
+
+} // namespace
+
+int benchJpeg(const QStringList& args)
+{
+    const int iters   = qMax(1, Bench::argInt(args, "--iters", 30));
+    const int forceQ  = Bench::argInt(args, "--quality", 0);   // 给出时覆盖各分辨率的默认质量
+    const QSize thumb(320, 180);
+
+    const Case cases[] = {
+        { "camera", QSize(320, 240),   50, false },
+        { "camera", QSize(480, 360),   55, false },
+        { "camera", QSize(640, 480),   60, false },
+        { "screen", QSize(1280, 720),  60, true },
+        { "screen", QSize(1920, 1080), 60, true },
+    };
+    Bench::report("jpeg", QString("backend=%1 iters=%2 thumb=%3x%4")
+                  .arg(JpegCodec::backend()).arg(iters).arg(thumb.width()).arg(thumb.height()));
+
+    JpegCodec codec;
+    QByteArray out;   // 跨帧复用
+    QImage dst, small;
+    int failures = 0;
+    for (const Case& c : cases) {
+        const int quality = forceQ > 0 ? qBound(1, forceQ, 100) : c.quality;
+        QImage src;
+        if (c.screen) {
+            Bench::DesktopSequence seq("typing", c.size, 0);
+            seq.next(src);
+        } else {
+            src = makeCameraFrame(c.size, 1);
+        }
+        QByteArray planes[3];
+        toI420(src, planes);
+        const uchar* pp[3] = { reinterpret_cast<const uchar*>(planes[0].constData()),
+                               reinterpret_cast<const uchar*>(planes[1].constData()),
+                               reinterpret_cast<const uchar*>(planes[2].constData()) };
+        const int strides[3] = { c.size.width(), c.size.width() / 2, c.size.width() / 2 };
+
+        Bench::Samples lEnc, lDec, lThumb, jEnc, jEncI420, jDec, jThumb;
+        QByteArray legacyJpeg, i420Jpeg;
+        QImage legacyImg;
+        bool ok = true;
+        for (int i = 0; i < iters && ok; ++i) {
+            QElapsedTimer t; t.start();
+            legacyJpeg = legacyEncode(src, quality);
+            lEnc.add(t.nsecsElapsed() / 1000);
+            t.restart();
+            legacyImg = legacyDecode(legacyJpeg);
+            lDec.add(t.nsecsElapsed() / 1000);
+            t.restart();
+            const QImage legacyThumb = legacyDecode(legacyJpeg).scaled(thumb, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            lThumb.add(t.nsecsElapsed() / 1000);
+            Q_UNUSED(legacyThumb);
+
+            t.restart();
+            ok = codec.encode(src, quality, out);
+            jEnc.add(t.nsecsElapsed() / 1000);
+            t.restart();
+            ok = ok && codec.encodeI420(pp, strides, c.size.width(), c.size.height(), quality, i420Jpeg);
+            jEncI420.add(t.nsecsElapsed() / 1000);
+            t.restart();
+            ok = ok && codec.decode(out, dst);
+            jDec.add(t.nsecsElapsed() / 1000);
+            t.restart();
+            ok = ok && codec.decode(out, small, thumb);
+            jThumb.add(t.nsecsElapsed() / 1000);
+        }
+
+        const double lErr = meanAbsError(src, legacyImg);
+        const double jErr = meanAbsError(src, dst);
+        const QSize wantThumb = JpegCodec::scaledSize(c.size, thumb);
+        const bool pass = ok && dst.size() == c.size && small.size() == wantThumb && jErr <= lErr + 1.5;
+        if (!pass) ++failures;
+        Bench::report("jpeg", QString("%1 %2x%3 q%18 qt: enc=%4ms dec=%5ms thumb=%6ms %7B err=%8 | "
+                                      "codec: enc=%9ms encI420=%10ms dec=%11ms thumb=%12ms(%13x%14) %15B err=%16 %17")
+                      .arg(QLatin1String(c.label)).arg(c.size.width()).arg(c.size.height())
+                      .arg(lEnc.avgMs(), 0, 'f', 2).arg(lDec.avgMs(), 0, 'f', 2).arg(lThumb.avgMs(), 0, 'f', 2)
+                      .arg(legacyJpeg.size()).arg(lErr, 0, 'f', 2)
+                      .arg(jEnc.avgMs(), 0, 'f', 2).arg(jEncI420.avgMs(), 0, 'f', 2)
+                      .arg(jDec.avgMs(), 0, 'f', 2).arg(jThumb.avgMs(), 0, 'f', 2)
+                      .arg(small.width()).arg(small.height())
+                      .arg(out.size()).arg(jErr, 0, 'f', 2).arg(pass ? "OK" : "FAIL").arg(quality));
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+#include <QApplication>
+#include <algorithm>
+#include <cmath>
+#include "bench.h"
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+namespace Bench {
+
+QString argStr(const QStringList& args, const QString& key, const QString& def)
+{
+    const int i = args.indexOf(key);
+    return (i >= 0 && i + 1 < args.size()) ? args.at(i + 1) : def;
+}
+
+int argInt(const QStringList& args, const QString& key, int def)
+{
+    bool ok = false;
+    const int v = argStr(args, key).toInt(&ok);
+    return ok ? v : def;
+}
+
+double argDouble(const QStringList& args, const QString& key, double def)
+{
+    bool ok = false;
+    const double v = argStr(args, key).toDouble(&ok);
+    return ok ? v : def;
+}
+
+bool hasFlag(const QStringList& args, const QString& key)
+{
+    return args.contains(key);
+}
+
+double Samples::avgMs() const
+{
+    if (us.isEmpty()) return 0.0;
+    qint64 sum = 0;
+    for (qint64 v : us) sum += v;
+    return sum / 1000.0 / us.size();
+}
+
+double Samples::pctMs(double p) const
+{
+    if (us.isEmpty()) return 0.0;
+    QVector<qint64> s = us;
+    std::sort(s.begin(), s.end());
+    const int i = qBound(0, int(std::ceil(p * s.size())) - 1, s.size() - 1);
+    return s.at(i) / 1000.0;
+}
+
+void report(const char* name, const QString& line)
+{
+    qInfo().noquote() << QString("[BENCH %1] %2").arg(QLatin1String(name), line);
+}
+
+double threadCpuMs()
+{
+#ifdef Q_OS_LINUX
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#endif
+    return -1;
+}
+
+} // namespace Bench
+
+namespace {
+struct Entry {
+    const char* name;
+    int (*run)(const QStringList& args);
+    const char* usage;
+    bool gui = false;   // 需要 QApplication（控件绘制）
+};
+
+const Entry kBenches[] = {
+    { "framing", benchFraming,
+      "服务器拆包：基线 left/remove/right、drainPackets、RecvBuffer+视图，统计每帧耗时与复制字节\n"
+      "    --frames 2000 --bin 30000 --read 65536" },
+    { "forward", benchForward,
+      "服务器转发吞吐：基线拆包+buildPacket 重新打包 vs 视图拆包+原样转发，单线程帧/秒\n"
+      "    --frames 5000 --bin 30000 --read 65536 --peers 3" },
+    { "gui-tiles", benchGuiTiles,
+      "九宫格视频显示：基线 QPixmap::fromImage + 平滑缩放 + setPixmap 对比 VideoSurface，统计 GUI 线程 CPU 毫秒/秒并核对显示\n"
+      "    --fps 15 --seconds 5 --w 1280 --h 800 --raw", true },
+    { "hub-load", benchHubLoad,
+      "RoomHub 压测：数百个 TCP 客户端分布在多个房间按帧率发视频帧，统计端到端扇出时延 p99、分片广播耗时与每核 CPU 占用\n"
+      "    --clients 300 --rooms 30 --senders 1 --fps 15 --bin 20000 --threads 2 --seconds 10 --shards 0 --port 19000 [--host 地址 压外部 hub]" },
+    { "udp-relay", benchRelayLoad,
+      "UdpRelay 回环吞吐：批量 recvmmsg/sendmmsg 与逐包 QUdpSocket，统计数据报/秒与每转发 1MB 的中继线程 CPU\n"
+      "    --peers 4 --chunk 1200 --rate 20000 --seconds 5 --port 19002 --no-batch --batch-only" },
+    { "screen-codec", benchScreenCodec,
+      "屏幕增量帧：基线 DS01 (qCompress 6) 与 DS02 zlib/lz/jpeg/auto 的每帧编码/解码耗时与字节，核对解码背板\n"
+      "    --frames 30 --w 1920 --h 1080 --quality 60 [--dir 录制帧目录]" },
+    { "screen-corpus", benchScreenCorpus,
+      "屏幕增量帧字节：基线 DS01 对比 DS02（差值预测 + 调色板）及再加区域复制，全部无损并核对解码结果\n"
+      "    --frames 60 --w 1920 --h 1080 [--dir 录制帧目录]" },
+    { "udm-loss", benchUdmLoss,
+      "回环 UDP：发送端 -> UdpRelay -> 丢包链路 -> 接收端，统计 FEC/NACK 恢复与丢帧\n"
+      "    --frames 300 --size 60000 --fps 15 --loss 5 --burst 1 --fec 8 --no-nack --no-batch --port 19001 --seed 1" },
+    { "udm-reasm", benchReassembly,
+      "UdpMediaClient 重组：合成 v3 分片流，对比基线重组、裸 socket 底数与现实现的每帧堆分配次数（glibc）\n"
+      "    --frames 1000 --size 60000" },
+    { "blockdiff", benchBlockDiff,
+      "BlockDiff 每帧耗时：720p/1080p/4K × static/typing/scroll/drag/video 桌面序列，基线逐块 memcmp 对比 Compare/Hash，核对位图\n"
+      "    --frames 30 --block 32 [--dir 录制帧目录]" },
+    { "jpeg", benchJpeg,
+      "JpegCodec 对比基线 QImageWriter/QImageReader：摄像头与屏幕关键帧各分辨率的编码/解码/缩略图解码耗时与字节，核对尺寸与误差\n"
+      "    --iters 30 [--quality 覆盖默认质量]" },
+    { "yuv", benchYuv,
+      "YuvConvert 计时与核对：6 种源格式 × 640x480/1280x720/1920x1080，原尺寸与一半尺寸，对照标量 yuvToRgb\n"
+      "    --iters 30" },
+};
+
+void usage()
+{
+    qInfo().noquote() << "usage: cloudmeeting-bench <name> [options]";
+    for (const Entry& e : kBenches)
+        qInfo().noquote() << QString("  %1  %2").arg(QLatin1String(e.name), QString::fromUtf8(e.usage));
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const Entry* entry = nullptr;
+    for (const Entry& e : kBenches) {
+        if (argc >= 2 && qstrcmp(argv[1], e.name) == 0) entry = &e;
+    }
+    // 控件类基准默认走 offscreen 平台，无显示环境也能运行
+    if (entry && entry->gui && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QScopedPointer<QCoreApplication> app(entry && entry->gui ? new QApplication(argc, argv)
+                                                             : new QCoreApplication(argc, argv));
+    if (!entry) { usage(); return 2; }
+
+    QStringList args = app->arguments();
+    args.removeFirst();
+    args.removeFirst();
+    return entry->run(args);
+}
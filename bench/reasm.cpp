@@ -0,0 +1,307 @@
+#include <QtNetwork>
+#include "bench.h"
+#include "udpmedia.h"
+
+// UdpMediaClient 重组：合成 v3 分片流，统计每帧堆分配次数
+// - 计数方式：本文件在 glibc 上接管 malloc/calloc/realloc（转调 __libc_*），只统计“已开启计数的线程”
+//   上的调用；operator new 与 QByteArray/QVector 的分配都经过 malloc，一并计入
+// - legacy：基线重组（每包 QByteArray + QDataStream、sender|fid 字符串键、每片 QByteArray、整帧拼接），
+//   仅保留在此用于对比，进程内直接喂入同一分片流
+// - socket：同一分片流经回环送入一个裸 QUdpSocket（复用缓冲读取后丢弃），即事件循环与 socket 本身的分配底数
+// - client：同一分片流经回环送入 UdpMediaClient，本进程充当中继完成注册与名单回执
+// 发送在独立线程，不计入；各项均在预热若干帧之后开始计数
+namespace {
+
+thread_local bool g_counting = false;
+thread_local quint64 g_allocs = 0;
+
+struct CountScope {
+    CountScope() { g_allocs = 0; g_counting = true; }
+    ~CountScope() { g_counting = false; }
+    void stop() { g_counting = false; }
+};
+
+} // namespace
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t n)
+{
+    if (g_counting) ++g_allocs;
+    return __libc_malloc(n);
+}
+void* calloc(size_t n, size_t m)
+{
+    if (g_counting) ++g_allocs;
+    return __libc_calloc(n, m);
+}
+void* realloc(void* p, size_t n)
+{
+    if (g_counting) ++g_allocs;
+    return __libc_realloc(p, n);
+}
+}
+#define BENCH_COUNTS_ALLOCS 1
+#else
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+namespace {
+
+const int kChunk = 1200;   // 与 UdpMediaClient::kChunkPayload 一致
+const quint32 kTxSession = 1, kRxSession = 2;
+
+QByteArray framePayload(int n, int size)
+{
+    QByteArray d(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) d[i] = char(n * 7 + i);
+    return d;
+}
+
+// 一帧的全部 v3 分片
+QVector<QByteArray> frameChunks(int n, int size)
+{
+    const QByteArray f = framePayload(n, size);
+    const int cnt = (size + kChunk - 1) / kChunk;
+    QVector<QByteArray> out;
+    for (int i = 0; i < cnt; ++i) {
+        const int len = qMin(kChunk, size - i * kChunk);
+        QByteArray d(kUdmChunkV3Size + len, Qt::Uninitialized);
+        UdmChunkV3 c;
+        c.session = kTxSession;
+        c.frameId = quint32(n + 1);
+        c.idx = quint16(i);
+        c.cnt = quint16(cnt);
+        c.w = 1280; c.h = 720;
+        c.ts = quint64(n + 1);
+        c.len = quint32(len);
+        writeUdmChunkV3(reinterpret_cast<uchar*>(d.data()), c);
+        memcpy(d.data() + kUdmChunkV3Size, f.constData() + i * kChunk, size_t(len));
+        out.push_back(d);
+    }
+    return out;
+}
+
+// 基线重组（仅 v3 数据分片路径）
+class LegacyReassembler {
+public:
+    LegacyReassembler() { roster_.insert(kTxSession, "tx"); roster_.insert(kRxSession, "rx"); }
+    int delivered = 0;
+    QByteArray last;
+
+    // 与基线 onReadyRead 相同：每个数据报先复制进新的 QByteArray
+    void onDatagram(const char* data, int size) {
+        QByteArray d;
+        d.resize(size);
+        memcpy(d.data(), data, size_t(size));
+        parse(d);
+    }
+
+private:
+    struct Assembly {
+        int chunkCnt = 0;
+        qint64 startMs = 0;
+        QVector<QByteArray> parts;
+        int received = 0;
+    };
+
+    void parse(const QByteArray& dgram) {
+        const uchar* raw = reinterpret_cast<const uchar*>(dgram.constData());
+        quint8 ver = 0, type = 0;
+        if (!readUdmHeader(raw, dgram.size(), ver, type)) return;
+        QDataStream ds(dgram);
+        ds.setByteOrder(QDataStream::BigEndian);
+        ds.skipRawData(kUdmHeaderSize);
+        if (type != UDM_CHUNK) return;
+        UdmChunkV3 c;
+        if (!readUdmChunkV3(raw, dgram.size(), c)) return;
+        const QString sender = roster_.value(c.session);
+        if (sender.isEmpty()) return;
+        const char* payload = dgram.constData() + kUdmChunkV3Size;
+
+        const QString key = sender + '|' + QString::number(c.frameId);
+        auto& as = reassem_[key];
+        if (as.startMs == 0) {
+            as.startMs = QDateTime::currentMSecsSinceEpoch();
+            as.chunkCnt = c.cnt;
+            as.parts.resize(c.cnt);
+        }
+        if (as.chunkCnt != c.cnt) return;
+        if (c.idx < as.parts.size() && as.parts[c.idx].isEmpty()) {
+            as.parts[c.idx] = QByteArray(payload, int(c.len));
+            as.received++;
+        }
+        if (as.received == as.chunkCnt) {
+            QByteArray blob;
+            blob.reserve(as.chunkCnt * 1000);
+            for (int i = 0; i < as.chunkCnt; ++i) blob.append(as.parts[i]);
+            last = blob;
+            ++delivered;
+            reassem_.remove(key);
+        }
+    }
+
+    QHash<quint32, QString> roster_;
+    QHash<QString, Assembly> reassem_;
+};
+
+// 发送线程：把预先构造的分片按帧匀速发往 port（每帧后让出约 1ms，避免回环接收缓冲溢出）
+QThread* startSender(const QVector<QVector<QByteArray>>& frames, quint16 port)
+{
+    return QThread::create([frames, port]{
+        QUdpSocket out;
+        out.bind(QHostAddress::LocalHost, 0);
+        for (const QVector<QByteArray>& f : frames) {
+            for (const QByteArray& d : f) out.writeDatagram(d, QHostAddress::LocalHost, port);
+            QThread::usleep(1000);
+        }
+    });
+}
+
+double perFrame(quint64 allocs, int frames)
+{
+    return frames > 0 ? double(allocs) / frames : 0.0;
+}
+
+} // namespace
+
+int benchReassembly(const QStringList& args)
+{
+    const int frames = qMax(20, Bench::argInt(args, "--frames", 1000));
+    const int size   = qMax(kChunk + 1, Bench::argInt(args, "--size", 60000));
+    const int warm   = qMin(frames / 2, 10);
+
+    if (!BENCH_COUNTS_ALLOCS) {
+        Bench::report("udm-reasm", "allocation counting needs glibc without ASan; nothing to measure");
+        return 0;
+    }
+
+    QVector<QVector<QByteArray>> stream;
+    for (int n = 0; n < frames; ++n) stream.push_back(frameChunks(n, size));
+    const int chunksPerFrame = stream.first().size();
+    Bench::report("udm-reasm", QString("frames=%1 size=%2 chunks/frame=%3 warmup=%4")
+                  .arg(frames).arg(size).arg(chunksPerFrame).arg(warm));
+
+    int failures = 0;
+
+    // legacy：进程内直接喂入
+    {
+        LegacyReassembler legacy;
+        for (int n = 0; n < warm; ++n)
+            for (const QByteArray& d : stream[n]) legacy.onDatagram(d.constData(), d.size());
+        quint64 allocs = 0;
+        {
+            CountScope count;
+            for (int n = warm; n < frames; ++n)
+                for (const QByteArray& d : stream[n]) legacy.onDatagram(d.constData(), d.size());
+            count.stop();
+            allocs = g_allocs;
+        }
+        const bool ok = legacy.delivered == frames && legacy.last == framePayload(frames - 1, size);
+        if (!ok) ++failures;
+        Bench::report("udm-reasm", QString("legacy  %1 allocs/frame (delivered %2/%3) %4")
+                      .arg(perFrame(allocs, frames - warm), 0, 'f', 1).arg(legacy.delivered).arg(frames)
+                      .arg(ok ? "OK" : "FAIL"));
+    }
+
+    // socket：事件循环 + QUdpSocket 读取的分配底数
+    double floor = 0;
+    {
+        QUdpSocket sock;
+        sock.bind(QHostAddress::LocalHost, 0);
+        sock.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+        QByteArray buf(2048, Qt::Uninitialized);
+        int got = 0;
+        QEventLoop loop;
+        QObject::connect(&sock, &QUdpSocket::readyRead, &sock, [&]{
+            while (sock.hasPendingDatagrams()) {
+                sock.readDatagram(buf.data(), buf.size());
+                if (++got == warm * chunksPerFrame) { g_allocs = 0; g_counting = true; }
+                if (got == frames * chunksPerFrame) { g_counting = false; loop.quit(); }
+            }
+        });
+        QThread* sender = startSender(stream, sock.localPort());
+        sender->start();
+        QTimer::singleShot(frames * 10 + 3000, &loop, &QEventLoop::quit);
+        loop.exec();
+        g_counting = false;
+        sender->wait();
+        delete sender;
+        const int counted = got / chunksPerFrame - warm;
+        floor = perFrame(g_allocs, counted);
+        Bench::report("udm-reasm", QString("socket  %1 allocs/frame (event loop + readDatagram floor, %2/%3 chunks)")
+                      .arg(floor, 0, 'f', 1).arg(got).arg(frames * chunksPerFrame));
+    }
+
+    // client：本进程充当中继，完成注册回执后由发送线程送入分片流
+    {
+        QUdpSocket relay;
+        relay.bind(QHostAddress::LocalHost, 0);
+        UdpMediaClient client;
+        client.setNackEnabled(false);
+        QEventLoop reg, loop;   // 注册阶段与收流阶段各用一个，避免注册超时定时器打断收流
+        quint16 clientPort = 0;
+        QObject::connect(&relay, &QUdpSocket::readyRead, &relay, [&]{
+            const bool was = g_counting;   // 模拟中继自身的分配不计入
+            g_counting = false;
+            while (relay.hasPendingDatagrams()) {
+                QHostAddress from; quint16 port = 0;
+                QByteArray d(int(relay.pendingDatagramSize()), Qt::Uninitialized);
+                relay.readDatagram(d.data(), d.size(), &from, &port);
+                quint8 ver = 0, type = 0;
+                if (!readUdmHeader(reinterpret_cast<const uchar*>(d.constData()), d.size(), ver, type) ||
+                    type != UDM_REGISTER || clientPort) continue;
+                clientPort = port;
+                QByteArray roster;
+                QDataStream ds(&roster, QIODevice::WriteOnly);
+                ds.setByteOrder(QDataStream::BigEndian);
+                ds << quint32(kUdmMagic) << quint8(UDM_V3) << quint8(UDM_ROSTER) << quint16(0);
+                ds << kRxSession << quint16(2) << kTxSession << QString("tx") << kRxSession << QString("rx");
+                relay.writeDatagram(roster, from, port);
+                QTimer::singleShot(100, &reg, &QEventLoop::quit);   // 等名单回执被处理
+            }
+            g_counting = was;
+        });
+        client.configureServer("127.0.0.1", relay.localPort());
+        client.setIdentity("bench", "rx");
+        QTimer::singleShot(2000, &reg, &QEventLoop::quit);
+        reg.exec();
+        if (!clientPort) {
+            Bench::report("udm-reasm", "client  FAILED (no register received)");
+            return 1;
+        }
+
+        int delivered = 0, corrupt = 0;
+        QObject::connect(&client, &UdpMediaClient::udpScreenFrame, &client,
+                         [&](const QString&, QByteArray jpeg, int, int, qint64 ts) {
+            ++delivered;
+            if (delivered == warm) { g_allocs = 0; g_counting = true; }
+            if (ts == frames || ts == 1) {   // 抽查首末帧内容（比较本身不计入）
+                const bool was = g_counting;
+                g_counting = false;
+                if (jpeg != framePayload(int(ts) - 1, size)) ++corrupt;
+                g_counting = was;
+            }
+            if (delivered == frames) { g_counting = false; loop.quit(); }
+        });
+        QThread* sender = startSender(stream, clientPort);
+        sender->start();
+        QTimer::singleShot(frames * 10 + 3000, &loop, &QEventLoop::quit);
+        loop.exec();
+        g_counting = false;
+        sender->wait();
+        delete sender;
+        const quint64 allocs = g_allocs;
+        const int counted = delivered - warm;
+        const double per = perFrame(allocs, counted);
+        if (corrupt || delivered < warm) ++failures;
+        Bench::report("udm-reasm", QString("client  %1 allocs/frame, %2 above the socket floor (delivered %3/%4, corrupt %5) %6")
+                      .arg(per, 0, 'f', 1).arg(per - floor, 0, 'f', 1).arg(delivered).arg(frames).arg(corrupt)
+                      .arg(corrupt || delivered < warm ? "FAIL" : "OK"));
+    }
+    return failures ? 1 : 0;
+}
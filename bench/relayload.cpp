@@ -0,0 +1,204 @@
+#include <QtNetwork>
+#include "bench.h"
+#include "udprelay.h"
+
+// UdpRelay 回环吞吐：1 个发送端按 --rate 匀速发 v3 分片，中继转发给同房间 --peers 个接收端
+// - 中继运行在独立线程，发送端在另一线程按 1ms 节拍成批发送，接收端在主线程计数
+// - 依次测批量（recvmmsg/sendmmsg）与逐包（QUdpSocket）两条路径
+// - 中继线程 CPU 时间取 CLOCK_THREAD_CPUTIME_ID（仅 Linux），折算为每转发 1MB 的毫秒数
+namespace {
+
+struct RunResult {
+    bool ok = false;
+    bool batched = false;
+    double seconds = 0;
+    double dgramIn = 0, forwarded = 0, bytesOut = 0, batches = 0, sendErrors = 0;
+    qint64 sent = 0, received = 0;
+    double relayCpuMs = -1;
+};
+
+QByteArray registerPacket(const QString& room, const QString& user)
+{
+    QByteArray d;
+    QDataStream ds(&d, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(kUdmMagic) << quint8(UDM_V2) << quint8(UDM_REGISTER) << quint16(0);
+    ds << room << user;
+    return d;
+}
+
+// 发送线程：注册、等待回执中的会话 id，之后按速率发送 seconds 秒；返回已发分片数，注册失败返回 -1
+qint64 sendLoop(quint16 port, const QString& room, int chunk, int rate, int seconds)
+{
+    QUdpSocket out;
+    out.bind(QHostAddress::LocalHost, 0);
+    const QByteArray reg = registerPacket(room, "tx");
+    out.writeDatagram(reg, QHostAddress::LocalHost, port);
+
+    quint32 session = 0;
+    QElapsedTimer t; t.start();
+    while (!session && t.elapsed() < 2000 && out.waitForReadyRead(200)) {
+        while (out.hasPendingDatagrams()) {
+            uchar buf[2048];
+            const qint64 n = out.readDatagram(reinterpret_cast<char*>(buf), sizeof(buf));
+            quint8 ver = 0, type = 0;
+            if (n >= kUdmHeaderSize + 4 && readUdmHeader(buf, int(n), ver, type) && type == UDM_ROSTER)
+                session = qMax(session, qFromBigEndian<quint32>(buf + kUdmHeaderSize));
+        }
+    }
+    if (!session) return -1;
+
+    QByteArray d(kUdmChunkV3Size + chunk, 'x');
+    UdmChunkV3 c;
+    c.session = session;
+    c.cnt = 50;   // 约 60KB 一帧
+    c.w = 1280; c.h = 720;
+    c.len = quint32(chunk);
+    qint64 sent = 0, lastBeat = 0;
+    t.restart();
+    while (t.elapsed() < seconds * 1000) {
+        const qint64 due = rate * t.nsecsElapsed() / 1000000000;
+        for (; sent < due; ++sent) {
+            c.frameId = quint32(sent / c.cnt);
+            c.idx = quint16(sent % c.cnt);
+            c.ts = c.frameId;
+            writeUdmChunkV3(reinterpret_cast<uchar*>(d.data()), c);
+            out.writeDatagram(d, QHostAddress::LocalHost, port);
+        }
+        if (t.elapsed() - lastBeat >= 2000) {   // 心跳，避免被当作超时会话
+            lastBeat = t.elapsed();
+            out.writeDatagram(reg, QHostAddress::LocalHost, port);
+        }
+        char skip[64];
+        while (out.hasPendingDatagrams()) out.readDatagram(skip, sizeof(skip));   // 丢弃名单更新
+        QThread::usleep(1000);
+    }
+    return sent;
+}
+
+RunResult runOnce(bool batched, quint16 port, int peers, int chunk, int rate, int seconds)
+{
+    RunResult r;
+
+    // 中继对象在其线程内构造与析构，内部 socket/定时器都归属该线程
+    QThread relayThread;
+    relayThread.setObjectName("udp-relay");
+    QObject ctx;
+    ctx.moveToThread(&relayThread);
+    relayThread.start();
+    UdpRelay* relay = nullptr;
+    QMetaObject::invokeMethod(&ctx, [&]{
+        relay = new UdpRelay;
+        r.ok = relay->start(port, batched);
+        r.batched = relay->isBatched();
+    }, Qt::BlockingQueuedConnection);
+
+    // 接收端：注册后只计数分片；每 2 秒重发注册作为心跳
+    const QString room = QString("bench-%1").arg(port);
+    QVector<QUdpSocket*> rx;
+    for (int i = 0; r.ok && i < peers; ++i) {
+        auto* s = new QUdpSocket;
+        s->bind(QHostAddress::LocalHost, 0);
+        s->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+        QObject::connect(s, &QUdpSocket::readyRead, s, [s, &r]{
+            char buf[2048];
+            while (s->hasPendingDatagrams()) {
+                const qint64 n = s->readDatagram(buf, sizeof(buf));
+                if (n > kUdmHeaderSize && quint8(buf[5]) == UDM_CHUNK) ++r.received;
+            }
+        });
+        rx.push_back(s);
+    }
+    auto registerAll = [&]{
+        for (int i = 0; i < rx.size(); ++i)
+            rx[i]->writeDatagram(registerPacket(room, QString("rx%1").arg(i)), QHostAddress::LocalHost, port);
+    };
+    registerAll();
+    QTimer heartbeat;
+    heartbeat.setInterval(2000);
+    QObject::connect(&heartbeat, &QTimer::timeout, &heartbeat, registerAll);
+    heartbeat.start();
+
+    if (r.ok) {
+        QJsonObject s0, s1;
+        double cpu0 = 0, cpu1 = 0;
+        QMetaObject::invokeMethod(&ctx, [&]{ cpu0 = Bench::threadCpuMs(); s0 = relay->statsJson(); },
+                                  Qt::BlockingQueuedConnection);
+        QElapsedTimer clock; clock.start();
+
+        qint64 sent = 0;
+        QEventLoop loop;
+        QThread* sender = QThread::create([&]{ sent = sendLoop(port, room, chunk, rate, seconds); });
+        QObject::connect(sender, &QThread::finished, &loop, &QEventLoop::quit);
+        sender->start();
+        loop.exec();
+        sender->wait();
+        delete sender;
+        // 排空在途数据报
+        QTimer::singleShot(200, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        QMetaObject::invokeMethod(&ctx, [&]{ cpu1 = Bench::threadCpuMs(); s1 = relay->statsJson(); },
+                                  Qt::BlockingQueuedConnection);
+        r.seconds = clock.nsecsElapsed() / 1e9;
+        r.ok = sent >= 0;
+        r.sent = qMax<qint64>(0, sent);
+        auto delta = [&](const char* k) { return s1.value(k).toDouble() - s0.value(k).toDouble(); };
+        r.dgramIn = delta("dgramIn");
+        r.forwarded = delta("forwarded");
+        r.bytesOut = delta("bytesOut");
+        r.batches = delta("batches");
+        r.sendErrors = delta("sendErrors");
+        if (cpu0 >= 0 && cpu1 >= 0) r.relayCpuMs = cpu1 - cpu0;
+    }
+
+    heartbeat.stop();
+    qDeleteAll(rx);
+    QMetaObject::invokeMethod(&ctx, [&]{ delete relay; }, Qt::BlockingQueuedConnection);
+    relayThread.quit();
+    relayThread.wait();
+    return r;
+}
+
+} // namespace
+
+int benchRelayLoad(const QStringList& args)
+{
+    const int peers   = qBound(1, Bench::argInt(args, "--peers", 4), 256);
+    const int chunk   = qBound(64, Bench::argInt(args, "--chunk", 1200), 1400);
+    const int rate    = qMax(1, Bench::argInt(args, "--rate", 20000));
+    const int seconds = qMax(1, Bench::argInt(args, "--seconds", 5));
+    const quint16 port = quint16(Bench::argInt(args, "--port", 19002));
+
+    QVector<bool> modes;
+    if (!Bench::hasFlag(args, "--no-batch")) modes << true;
+    if (!Bench::hasFlag(args, "--batch-only")) modes << false;
+
+    Bench::report("udp-relay", QString("peers=%1 chunk=%2B rate=%3 dgram/s seconds=%4")
+                  .arg(peers).arg(chunk).arg(rate).arg(seconds));
+    int failures = 0;
+    for (bool batched : modes) {
+        const RunResult r = runOnce(batched, port, peers, chunk, rate, seconds);
+        const char* mode = batched ? "batched" : "plain";
+        if (!r.ok) {
+            Bench::report("udp-relay", QString("%1 FAILED (relay did not start or no session)").arg(mode));
+            ++failures;
+            continue;
+        }
+        if (batched && !r.batched) mode = "batched->plain fallback";
+        const double mb = r.bytesOut / (1024.0 * 1024.0);
+        const double expected = double(r.sent) * peers;
+        Bench::report("udp-relay", QString("%1 in=%2 dgram/s forwarded=%3 dgram/s (%4 MB/s) received=%5 (%6%) "
+                                           "sendErrors=%7 dgram/batch=%8")
+                      .arg(mode).arg(r.dgramIn / r.seconds, 0, 'f', 0).arg(r.forwarded / r.seconds, 0, 'f', 0)
+                      .arg(mb / r.seconds, 0, 'f', 1).arg(r.received)
+                      .arg(expected > 0 ? 100.0 * r.received / expected : 0.0, 0, 'f', 1)
+                      .arg(r.sendErrors).arg(r.batches > 0 ? r.dgramIn / r.batches : 1.0, 0, 'f', 1));
+        if (r.relayCpuMs >= 0)
+            Bench::report("udp-relay", QString("%1 relay thread cpu=%2ms (%3% of one core) %4 ms per forwarded MB")
+                          .arg(mode).arg(r.relayCpuMs, 0, 'f', 0)
+                          .arg(100.0 * r.relayCpuMs / (r.seconds * 1000), 0, 'f', 1)
+                          .arg(mb > 0 ? r.relayCpuMs / mb : 0.0, 0, 'f', 2));
+    }
+    return failures ? 1 : 0;
+}
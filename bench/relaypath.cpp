@@ -0,0 +1,226 @@
+#include <QRandomGenerator>
+#include "bench.h"
+#include "protocol.h"
+
+// 服务器接收/转发路径基准
+// framing：TCP 字节流 -> 拆包，对比三种实现
+// - legacy：基线实现（每帧 left + remove(0, n) + right），仅保留在此用于对比
+// - packets：drainPackets（整批一次 remove，bin 复制一次）
+// - views：RecvBuffer + drainPacketViews（游标缓冲，raw/json/bin 均为接收缓冲上的视图）
+// 拷贝字节数按各实现的复制点逐项累计（socket 读入与写出两端的复制三者相同，不计入）
+// forward：拆包 + 转发的单线程吞吐（帧/秒），基线为 legacy 拆包后 buildPacket 重新打包，
+// 现路径为视图拆包后原样转发 raw；两者都把结果写入 --peers 个模拟 socket 缓冲
+namespace {
+
+const int kLenFieldSize = 4;
+const int kTypeSize     = 2;
+const int kJsonSizeSize = 4;
+
+// 基线 drainPackets，copied 累计其中的复制字节
+bool legacyDrain(QByteArray& buffer, QVector<Packet>& out, qint64& copied)
+{
+    bool produced = false;
+    for (;;) {
+        if (buffer.size() < kLenFieldSize) break;
+        quint32 length = 0;
+        {
+            QDataStream peek(buffer.left(kLenFieldSize));
+            peek.setByteOrder(QDataStream::BigEndian);
+            peek >> length;
+        }
+        if (length < static_cast<quint32>(kTypeSize + kJsonSizeSize) || length > kMaxPacketLen) {
+            buffer.clear();
+            break;
+        }
+        const int totalNeed = kLenFieldSize + static_cast<int>(length);
+        if (buffer.size() < totalNeed) break;
+
+        QByteArray block = buffer.left(totalNeed);
+        buffer.remove(0, totalNeed);
+        copied += totalNeed + buffer.size();   // left 复制整帧，remove 搬移剩余字节
+
+        QDataStream ds(block);
+        ds.setByteOrder(QDataStream::BigEndian);
+        quint32 lenField = 0; ds >> lenField; Q_UNUSED(lenField);
+        quint16 type = 0;     ds >> type;
+        quint32 jsonSize = 0; ds >> jsonSize;
+        const int payloadBytes = totalNeed - kLenFieldSize - kTypeSize - kJsonSizeSize;
+        if (jsonSize > static_cast<quint32>(payloadBytes) || jsonSize > kMaxJsonLen) continue;
+
+        QByteArray jsonBytes(int(jsonSize), Qt::Uninitialized);
+        if (jsonSize > 0) ds.readRawData(jsonBytes.data(), jsonBytes.size());
+        QByteArray bin;
+        const int binSize = payloadBytes - static_cast<int>(jsonSize);
+        if (binSize > 0) bin = block.right(binSize);
+        copied += jsonSize + binSize;
+
+        Packet pkt;
+        pkt.type = type;
+        pkt.json = fromJsonBytes(jsonBytes);
+        pkt.bin  = bin;
+        out.push_back(std::move(pkt));
+        produced = true;
+    }
+    return produced;
+}
+
+// 中继典型负载：v1 视频帧（JSON 头 + JPEG 大小的 bin）
+QByteArray makeVideoFrame(int i, int binSize)
+{
+    const QJsonObject j{{"roomId", "room-1"}, {"sender", "alice"}, {"media", "camera"},
+                        {"w", 640}, {"h", 480}, {"ts", 1700000000000.0 + i}};
+    return buildPacket(MSG_VIDEO_FRAME, j, QByteArray(binSize, char(i)));
+}
+
+// 把整段字节流切成随机大小的“读”，模拟 readAll 的返回
+QVector<QByteArray> splitReads(const QByteArray& stream, int maxRead, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    QVector<QByteArray> reads;
+    for (int off = 0; off < stream.size(); ) {
+        const int n = qMin(stream.size() - off, 1 + int(rng.bounded(quint32(maxRead))));
+        reads.push_back(stream.mid(off, n));
+        off += n;
+    }
+    return reads;
+}
+
+} // namespace
+
+int benchFraming(const QStringList& args)
+{
+    const int frames  = qMax(1, Bench::argInt(args, "--frames", 2000));
+    const int binSize = Bench::argInt(args, "--bin", 30000);
+    const int maxRead = qMax(64, Bench::argInt(args, "--read", 65536));
+
+    QByteArray stream;
+    for (int i = 0; i < frames; ++i) stream += makeVideoFrame(i, binSize);
+    const QVector<QByteArray> reads = splitReads(stream, maxRead, 1);
+    const double frameBytes = double(stream.size()) / frames;
+    Bench::report("framing", QString("frames=%1 frameBytes=%2 reads=%3 (max %4B)")
+                  .arg(frames).arg(frameBytes, 0, 'f', 0).arg(reads.size()).arg(maxRead));
+
+    auto line = [&](const char* path, qint64 ns, qint64 copied, int got) {
+        Bench::report("framing", QString("%1 %2us/frame copied=%3B/frame (%4x frame) frames=%5")
+                      .arg(QLatin1String(path), -8).arg(ns / 1000.0 / frames, 0, 'f', 2)
+                      .arg(double(copied) / frames, 0, 'f', 0).arg(copied / frameBytes / frames, 0, 'f', 2)
+                      .arg(got));
+    };
+
+    {
+        QByteArray buf;
+        qint64 copied = 0;
+        int got = 0;
+        QElapsedTimer t; t.start();
+        for (const QByteArray& r : reads) {
+            buf.append(r);
+            copied += r.size();
+            QVector<Packet> out;
+            legacyDrain(buf, out, copied);
+            got += out.size();
+        }
+        line("legacy", t.nsecsElapsed(), copied, got);
+    }
+    {
+        QByteArray buf;
+        qint64 copied = 0;
+        int got = 0;
+        QElapsedTimer t; t.start();
+        for (const QByteArray& r : reads) {
+            buf.append(r);
+            copied += r.size();
+            QVector<Packet> out;
+            drainPackets(buf, out);
+            for (const Packet& p : out) copied += p.bin.size();
+            if (!out.isEmpty()) copied += buf.size();   // 整批消费后剩余字节搬移一次
+            got += out.size();
+        }
+        line("packets", t.nsecsElapsed(), copied, got);
+    }
+    {
+        RecvBuffer buf;
+        qint64 copied = 0;
+        int got = 0, views = 0;
+        QElapsedTimer t; t.start();
+        for (const QByteArray& r : reads) {
+            // 有未读尾部时 append 需搬移尾部并追加新数据（上界）；否则直接共享新数据块
+            if (buf.size() > 0) copied += buf.size() + r.size();
+            buf.append(r);
+            const char* lo = buf.data();   // 本轮拆包前的读位置
+            QVector<PacketView> out;
+            drainPacketViews(buf, out);
+            got += out.size();
+            // 视图须落在本轮消费的接收缓冲区间内，才算零拷贝
+            for (const PacketView& v : out) {
+                if (v.raw.constData() >= lo && v.raw.constData() + v.raw.size() <= buf.data()) ++views;
+            }
+        }
+        line("views", t.nsecsElapsed(), copied, got);
+        Bench::report("framing", QString("views sharing the receive buffer: %1/%2").arg(views).arg(got));
+    }
+    return 0;
+}
+
+int benchForward(const QStringList& args)
+{
+    const int frames  = qMax(1, Bench::argInt(args, "--frames", 5000));
+    const int binSize = Bench::argInt(args, "--bin", 30000);
+    const int maxRead = qMax(64, Bench::argInt(args, "--read", 65536));
+    const int peers   = qMax(0, Bench::argInt(args, "--peers", 3));
+
+    QByteArray stream;
+    for (int i = 0; i < frames; ++i) stream += makeVideoFrame(i, binSize);
+    const QVector<QByteArray> reads = splitReads(stream, maxRead, 2);
+    Bench::report("forward", QString("frames=%1 bin=%2 peers=%3").arg(frames).arg(binSize).arg(peers));
+
+    // 模拟对端 socket 写缓冲：写满 4MB 清空一次（写出成本两条路径相同）
+    QVector<QByteArray> sinks(peers);
+    auto fanOut = [&](const QByteArray& pkt) {
+        for (QByteArray& s : sinks) {
+            if (s.size() > 4 * 1024 * 1024) s.resize(0);
+            s.append(pkt);
+        }
+    };
+
+    double oldFps = 0;
+    {
+        QByteArray buf;
+        int got = 0;
+        qint64 copied = 0;
+        QElapsedTimer t; t.start();
+        for (const QByteArray& r : reads) {
+            buf.append(r);
+            QVector<Packet> out;
+            legacyDrain(buf, out, copied);
+            for (const Packet& p : out) fanOut(buildPacket(p.type, p.json, p.bin));
+            got += out.size();
+        }
+        oldFps = got * 1e9 / qMax<qint64>(1, t.nsecsElapsed());
+        Bench::report("forward", QString("legacy  parse+rebuild %1 frames/s (%2 frames)").arg(oldFps, 0, 'f', 0).arg(got));
+    }
+    {
+        RecvBuffer buf;
+        int got = 0, same = 0;
+        QElapsedTimer t; t.start();
+        for (const QByteArray& r : reads) {
+            buf.append(r);
+            QVector<PacketView> out;
+            drainPacketViews(buf, out);
+            for (const PacketView& p : out) fanOut(p.raw);
+            got += out.size();
+        }
+        const double fps = got * 1e9 / qMax<qint64>(1, t.nsecsElapsed());
+        // 原样转发：抽查输出与输入字节一致
+        if (peers > 0 && got == frames) {
+            RecvBuffer check;
+            check.append(stream);
+            QVector<PacketView> all;
+            drainPacketViews(check, all);
+            same = all.size() == frames && sinks[0].endsWith(all.constLast().raw) ? 1 : 0;
+        }
+        Bench::report("forward", QString("views   raw forward   %1 frames/s (%2 frames) speedup=%3x lastFrameIdentical=%4")
+                      .arg(fps, 0, 'f', 0).arg(got).arg(oldFps > 0 ? fps / oldFps : 0.0, 0, 'f', 2)
+                      .arg(peers > 0 ? (same ? "yes" : "no") : "n/a"));
+    }
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include "bench.h"
+#include "blockdiff.h"
+#include "desktopseq.h"
+#include "motionsearch.h"
+#include "screencodec.h"
+
+// 屏幕增量帧编解码基准，场景见 desktopseq.h
+// screen-codec：按编码选择统计每帧编码/解码耗时（墙钟，含线程池并行）与字节
+// - ds01-zlib6：基线 DS01（逐矩形串行 qCompress 等级 6，仅保留在此用于对比），由 decodeDelta 的 DS01 路径解码
+// - zlib / lz / jpeg / auto：DS02 各 Policy
+// 变化矩形与 ScreenDiffStage 相同（BlockDiff 32 块，同行相邻块合并）；超过 kMaxRects 时按关键帧处理，
+// 两端直接以当前帧为参考，不计入增量统计
+// 核对：DS02 解码背板须与编码端镜像逐像素一致；无损编码还须与原帧一致
+// screen-corpus：同一语料上的每帧字节，基线 DS01 对比 DS02（差值预测 + 调色板），以及再加滚动/拖动区域复制
+// - 区域复制的检测与 ScreenDiffStage 相同：变化块数达到 kMotionMinBlocks 时做平移检测，复制后剩余块更少才采用
+// - 各项均为无损编码，解码背板须与原帧逐像素一致
+namespace {
+
+using Bench::DesktopSequence;
+using namespace ScreenCodec;
+
+const int kBlock = 32;
+const int kMaxRects = 120;
+const int kMotionMinBlocks = 16;
+
+// 按块比较得到变化矩形（同一行相邻块合并），超过 kMaxRects 返回 false
+// motion 非空时先做平移检测，得到的区域复制写入 copies
+bool collectRects(BlockDiff& diff, const QImage& prev, const QImage& curr, QVector<QRect>& out,
+                  MotionSearch* motion = nullptr, QVector<CopyOp>* copies = nullptr)
+{
+    QVector<quint8> dirty;
+    int changed = diff.detect(prev, curr, kBlock, dirty);
+    if (copies) copies->clear();
+    QVector<CopyOp> ops;
+    if (motion && copies && changed >= kMotionMinBlocks && motion->find(prev, curr, dirty, kBlock, ops)) {
+        QImage pred = prev.copy();
+        for (const CopyOp& op : ops) applyCopy(pred, op);
+        QVector<quint8> after;
+        if (diff.detectAgainst(pred, curr, kBlock, after) < changed) {
+            *copies = ops;
+            dirty = after;
+        }
+    }
+    const int W = curr.width(), H = curr.height();
+    const int bx = (W + kBlock - 1) / kBlock;
+    out.clear();
+    for (int i = 0; i < dirty.size(); ++i) {
+        if (!dirty[i]) continue;
+        const int x = (i % bx) * kBlock, y = (i / bx) * kBlock;
+        const QRect r(x, y, qMin(kBlock, W - x), qMin(kBlock, H - y));
+        if (!out.isEmpty()) {
+            QRect& last = out.last();
+            if (last.y() == r.y() && last.height() == r.height() && last.right() + 1 >= r.x() - 1) {
+                last.setRight(qMax(last.right(), r.right()));
+                continue;
+            }
+        }
+        if (out.size() >= kMaxRects) return false;
+        out.push_back(r);
+    }
+    return true;
+}
+
+// 基线 DS01：逐矩形提取原始像素，串行 qCompress 等级 6
+QByteArray encodeDs01(const QImage& curr, const QVector<QRect>& rects)
+{
+    QByteArray blob;
+    QDataStream ds(&blob, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << kMagicDS01 << quint16(rects.size());
+    QByteArray raw;
+    for (const QRect& r : rects) {
+        raw.resize(0);
+        for (int row = 0; row < r.height(); ++row)
+            raw.append(reinterpret_cast<const char*>(curr.constScanLine(r.y() + row) + r.x() * 4), r.width() * 4);
+        const QByteArray comp = qCompress(raw, 6);
+        ds << quint16(r.x()) << quint16(r.y()) << quint16(r.width()) << quint16(r.height());
+        ds << quint32(comp.size());
+        ds.writeRawData(comp.constData(), comp.size());
+    }
+    return blob;
+}
+
+// 两图每通道最大差值；尺寸不同返回 256
+int maxDiff(const QImage& a, const QImage& b)
+{
+    if (a.size() != b.size()) return 256;
+    int m = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const QRgb* p = reinterpret_cast<const QRgb*>(a.constScanLine(y));
+        const QRgb* q = reinterpret_cast<const QRgb*>(b.constScanLine(y));
+        if (!memcmp(p, q, size_t(a.width()) * 4)) continue;
+        for (int x = 0; x < a.width(); ++x) {
+            m = qMax(m, qMax(qAbs(qRed(p[x]) - qRed(q[x])),
+                        qMax(qAbs(qGreen(p[x]) - qGreen(q[x])), qAbs(qBlue(p[x]) - qBlue(q[x])))));
+        }
+    }
+    return m;
+}
+
+struct CodecChoice {
+    const char* name;
+    bool legacy;
+    Policy policy;
+    bool lossless;
+};
+
+} // namespace
+
+int benchScreenCodec(const QStringList& args)
+{
+    const int frames  = qMax(1, Bench::argInt(args, "--frames", 30));
+    const int w       = Bench::argInt(args, "--w", 1920);
+    const int h       = Bench::argInt(args, "--h", 1080);
+    const int quality = qBound(1, Bench::argInt(args, "--quality", 60), 100);
+    const QString dir = Bench::argStr(args, "--dir");
+
+    const CodecChoice choices[] = {
+        { "ds01-zlib6", true,  ForceZlib, true },
+        { "zlib",       false, ForceZlib, true },
+        { "lz",         false, ForceLz,   true },
+        { "jpeg",       false, ForceJpeg, false },
+        { "auto",       false, AutoCodec, false },
+    };
+    QStringList scenes = DesktopSequence::scenes();
+    scenes.removeAll("static");
+    if (!dir.isEmpty()) scenes = QStringList{ dir };
+
+    Bench::report("screen-codec", QString("size=%1x%2 frames=%3 quality=%4 pool=%5 threads")
+                  .arg(w).arg(h).arg(frames).arg(quality).arg(QThreadPool::globalInstance()->maxThreadCount()));
+    int failures = 0;
+    for (const QString& scene : scenes) {
+        for (const CodecChoice& c : choices) {
+            DesktopSequence seq = dir.isEmpty() ? DesktopSequence(scene, QSize(w, h), frames)
+                                                : DesktopSequence(dir, frames);
+            QImage prev, curr;
+            if (!seq.next(prev)) break;
+            Mirror mirror;   // 两端同一进程同一解码器，关键帧按无损处理
+            mirror.img = prev.copy();
+            mirror.markAll(false);
+            QImage back = prev.copy();
+            BlockDiff diff;
+            QVector<QRect> rects;
+            Bench::Samples enc, dec;
+            qint64 bytes = 0, raw = 0;
+            int keys = 0, deltas = 0, bad = 0, lossy = 0;
+            while (seq.next(curr)) {
+                if (!collectRects(diff, prev, curr, rects)) {
+                    ++keys;
+                    mirror.img = curr.copy();
+                    mirror.markAll(false);
+                    back = curr.copy();
+                    prev = curr;
+                    continue;
+                }
+                for (const QRect& r : rects) raw += qint64(r.width()) * r.height() * 4;
+                QElapsedTimer t; t.start();
+                const QByteArray blob = c.legacy ? encodeDs01(curr, rects)
+                                                 : encodeDelta(curr, rects, {}, mirror, c.policy, quality);
+                enc.add(t.nsecsElapsed() / 1000);
+                t.restart();
+                const bool ok = decodeDelta(blob, back);
+                dec.add(t.nsecsElapsed() / 1000);
+                bytes += blob.size();
+                ++deltas;
+
+                if (!ok || maxDiff(back, c.legacy ? curr : mirror.img) != 0) ++bad;
+                else if (c.lossless && maxDiff(back, curr) != 0) ++bad;
+                if (!c.lossless) lossy = qMax(lossy, maxDiff(back, curr));
+                if (c.legacy) mirror.img = curr.copy();
+                prev = curr;
+            }
+            if (bad) ++failures;
+            Bench::report("screen-codec", QString("%1 %2 deltas=%3 keys=%4 enc=%5ms dec=%6ms bytes/frame=%7 ratio=%8 %9 %10")
+                          .arg(seq.name(), -7).arg(QLatin1String(c.name), -10).arg(deltas).arg(keys)
+                          .arg(enc.avgMs(), 0, 'f', 2).arg(dec.avgMs(), 0, 'f', 2)
+                          .arg(deltas ? double(bytes) / deltas : 0.0, 0, 'f', 0)
+                          .arg(bytes ? double(raw) / bytes : 0.0, 0, 'f', 1)
+                          .arg(c.lossless ? QString("lossless") : QString("maxDiff=%1").arg(lossy))
+                          .arg(bad ? QString("FAIL(%1 frames)").arg(bad) : QString("OK")));
+        }
+    }
+    Bench::report("screen-codec", statsSummary());
+    return failures ? 1 : 0;
+}
+
+int benchScreenCorpus(const QStringList& args)
+{
+    const int frames  = qMax(1, Bench::argInt(args, "--frames", 60));
+    const int w       = Bench::argInt(args, "--w", 1920);
+    const int h       = Bench::argInt(args, "--h", 1080);
+    const QString dir = Bench::argStr(args, "--dir");
+
+    struct Variant {
+        const char* name;
+        bool legacy;
+        Policy policy;
+        bool copies;
+    };
+    const Variant variants[] = {
+        { "ds01-zlib6",     true,  ForceZlib, false },
+        { "ds02-zlib",      false, ForceZlib, false },
+        { "ds02-zlib+copy", false, ForceZlib, true },
+        { "ds02-lz+copy",   false, ForceLz,   true },
+    };
+    QStringList scenes = DesktopSequence::scenes();
+    scenes.removeAll("static");
+    if (!dir.isEmpty()) scenes = QStringList{ dir };
+
+    Bench::report("screen-corpus", QString("size=%1x%2 frames=%3").arg(w).arg(h).arg(frames));
+    int failures = 0;
+    for (const QString& scene : scenes) {
+        double baseline = 0;
+        for (const Variant& v : variants) {
+            DesktopSequence seq = dir.isEmpty() ? DesktopSequence(scene, QSize(w, h), frames)
+                                                : DesktopSequence(dir, frames);
+            QImage prev, curr;
+            if (!seq.next(prev)) break;
+            Mirror mirror;
+            mirror.img = prev.copy();
+            mirror.markAll(false);
+            QImage back = prev.copy();
+            BlockDiff diff;
+            MotionSearch motion;
+            QVector<QRect> rects;
+            QVector<CopyOp> copies;
+            qint64 bytes = 0, copyPx = 0;
+            int keys = 0, deltas = 0, bad = 0;
+            while (seq.next(curr)) {
+                if (!collectRects(diff, prev, curr, rects, v.copies ? &motion : nullptr, &copies)) {
+                    ++keys;
+                    mirror.img = curr.copy();
+                    mirror.markAll(false);
+                    back = curr.copy();
+                    prev = curr;
+                    continue;
+                }
+                for (const CopyOp& op : copies) copyPx += qint64(op.dst.width()) * op.dst.height();
+                const QByteArray blob = v.legacy ? encodeDs01(curr, rects)
+                                                 : encodeDelta(curr, rects, copies, mirror, v.policy);
+                if (!decodeDelta(blob, back) || maxDiff(back, curr) != 0) ++bad;
+                bytes += blob.size();
+                ++deltas;
+                prev = curr;
+            }
+            if (bad) ++failures;
+            const double perFrame = deltas ? double(bytes) / deltas : 0.0;
+            if (v.legacy) baseline = perFrame;
+            Bench::report("screen-corpus", QString("%1 %2 deltas=%3 keys=%4 bytes/frame=%5 vs ds01=%6x copyPx/frame=%7 %8")
+                          .arg(seq.name(), -7).arg(QLatin1String(v.name), -14).arg(deltas).arg(keys)
+                          .arg(perFrame, 0, 'f', 0)
+                          .arg(perFrame > 0 ? baseline / perFrame : 0.0, 0, 'f', 2)
+                          .arg(deltas ? double(copyPx) / deltas : 0.0, 0, 'f', 0)
+                          .arg(bad ? QString("FAIL(%1 frames)").arg(bad) : QString("OK")));
+        }
+    }
+    Bench::report("screen-corpus", statsSummary());
+    return failures ? 1 : 0;
+}
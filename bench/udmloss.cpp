@@ -0,0 +1,174 @@
+#include <QtNetwork>
+#include "bench.h"
+#include "udpmedia.h"
+#include "udprelay.h"
+
+// 回环丢包回放：发送端 UdpMediaClient -> UdpRelay -> 丢包链路 -> 接收端 UdpMediaClient
+// - 链路只对中继发往接收端的分片/校验分片按比例丢弃（可成串丢弃），其余报文原样转发
+// - 接收端的 NACK 经链路回到中继，由中继的重传缓存补发；补发的分片同样经过丢包链路
+// - 帧负载首 4 字节为序号，其余字节由序号确定，交付后逐字节核对
+// - 帧时间戳字段携带 序号+1，链路据此记录哪些帧丢过分片，交付时区分“无损”与“恢复”
+namespace {
+
+QByteArray makeFrame(int n, int size)
+{
+    QByteArray d(size, Qt::Uninitialized);
+    uchar* p = reinterpret_cast<uchar*>(d.data());
+    qToBigEndian<quint32>(quint32(n), p);
+    quint32 x = quint32(n) * 2654435761u + 1;
+    for (int i = 4; i < size; ++i) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        p[i] = uchar(x);
+    }
+    return d;
+}
+
+// 中继与接收端之间的丢包链路：down 面向接收端，up 面向中继（中继把 up 的端点当作接收端）
+class LossyLink {
+public:
+    LossyLink(quint16 relayPort, double lossPct, int burst, quint32 seed)
+        : relayPort_(relayPort), loss_(lossPct / 100.0), burst_(qMax(1, burst)), rng_(seed)
+    {
+        down_.bind(QHostAddress::LocalHost, 0);
+        up_.bind(QHostAddress::LocalHost, 0);
+        QObject::connect(&down_, &QUdpSocket::readyRead, &down_, [this]{ onDown(); });
+        QObject::connect(&up_, &QUdpSocket::readyRead, &up_, [this]{ onUp(); });
+    }
+
+    quint16 port() const { return down_.localPort(); }
+
+    int chunks = 0, dropped = 0;
+    QSet<quint64> lossyTs;   // 丢过数据分片的帧（按时间戳字段）；只丢校验分片不算
+
+private:
+    // 接收端 -> 中继：注册/NACK/接收报告，不丢
+    void onDown() {
+        while (down_.hasPendingDatagrams()) {
+            QHostAddress from; quint16 port = 0;
+            const QByteArray d = readOne(down_, &from, &port);
+            rxAddr_ = from; rxPort_ = port;
+            up_.writeDatagram(d, QHostAddress::LocalHost, relayPort_);
+        }
+    }
+    // 中继 -> 接收端：分片按比例丢弃
+    void onUp() {
+        while (up_.hasPendingDatagrams()) {
+            const QByteArray d = readOne(up_, nullptr, nullptr);
+            const uchar* p = reinterpret_cast<const uchar*>(d.constData());
+            quint8 ver = 0, type = 0;
+            UdmChunkV3 c;
+            if (readUdmHeader(p, d.size(), ver, type) && ver >= UDM_V3 &&
+                (type == UDM_CHUNK || type == UDM_PARITY) && readUdmChunkV3(p, d.size(), c)) {
+                ++chunks;
+                if (dropRun_ == 0 && rng_.generateDouble() < loss_ / burst_) dropRun_ = burst_;
+                if (dropRun_ > 0) {
+                    --dropRun_;
+                    ++dropped;
+                    if (type == UDM_CHUNK) lossyTs.insert(c.ts);
+                    continue;
+                }
+            }
+            if (rxPort_) down_.writeDatagram(d, rxAddr_, rxPort_);
+        }
+    }
+    static QByteArray readOne(QUdpSocket& s, QHostAddress* from, quint16* port) {
+        QByteArray d(int(s.pendingDatagramSize()), Qt::Uninitialized);
+        const qint64 n = s.readDatagram(d.data(), d.size(), from, port);
+        d.resize(int(qMax<qint64>(0, n)));
+        return d;
+    }
+
+    QUdpSocket down_, up_;
+    quint16 relayPort_;
+    QHostAddress rxAddr_;
+    quint16 rxPort_ = 0;
+    double loss_;
+    int burst_;
+    int dropRun_ = 0;
+    QRandomGenerator rng_;
+};
+
+} // namespace
+
+int benchUdmLoss(const QStringList& args)
+{
+    const int frames   = Bench::argInt(args, "--frames", 300);
+    const int size     = qMax(8, Bench::argInt(args, "--size", 60000));
+    const int fps      = qBound(1, Bench::argInt(args, "--fps", 15), 120);
+    const double loss  = Bench::argDouble(args, "--loss", 5.0);
+    const int burst    = Bench::argInt(args, "--burst", 1);
+    const int fec      = Bench::argInt(args, "--fec", 8);
+    const bool nack    = !Bench::hasFlag(args, "--no-nack");
+    const bool batched = !Bench::hasFlag(args, "--no-batch");
+    const quint16 port = quint16(Bench::argInt(args, "--port", 19001));
+    const quint32 seed = quint32(Bench::argInt(args, "--seed", 1));
+
+    UdpRelay relay;
+    if (!relay.start(port, batched)) return 1;
+    LossyLink link(port, loss, burst, seed);
+
+    UdpMediaClient tx, rx;
+    tx.setFecGroup(fec);
+    rx.setNackEnabled(nack);
+    tx.configureServer("127.0.0.1", port);
+    tx.setIdentity("bench", "tx");
+    rx.configureServer("127.0.0.1", link.port());
+    rx.setIdentity("bench", "rx");
+
+    QElapsedTimer clock;
+    clock.start();
+    QVector<qint64> sentUs(frames, -1);
+    Bench::Samples latency;
+    int delivered = 0, recovered = 0, corrupt = 0, dup = 0;
+    QVector<bool> seen(frames, false);
+    QObject::connect(&rx, &UdpMediaClient::udpScreenFrame, &rx,
+                     [&](const QString&, QByteArray jpeg, int, int, qint64 ts) {
+        const int n = int(ts) - 1;
+        if (n < 0 || n >= frames) { ++corrupt; return; }
+        if (seen[n]) { ++dup; return; }
+        seen[n] = true;
+        ++delivered;
+        if (jpeg != makeFrame(n, size)) ++corrupt;
+        if (link.lossyTs.contains(quint64(ts))) ++recovered;
+        latency.add(clock.nsecsElapsed() / 1000 - sentUs[n]);
+    });
+
+    // 注册回执（会话 id 与名单）到齐后再开始发送，之后按帧率匀速发送
+    QEventLoop loop;
+    QTimer pace;
+    pace.setInterval(1000 / fps);
+    int next = 0;
+    QObject::connect(&pace, &QTimer::timeout, &pace, [&]{
+        if (next >= frames) {
+            pace.stop();
+            QTimer::singleShot(1500, &loop, &QEventLoop::quit);   // 等待最后几帧的 NACK 补发
+            return;
+        }
+        const QByteArray f = makeFrame(next, size);
+        sentUs[next] = clock.nsecsElapsed() / 1000;
+        tx.sendScreenJpeg(f, 1280, 720, next + 1);
+        ++next;
+    });
+    QTimer::singleShot(500, &pace, [&]{ pace.start(); });
+    loop.exec();
+
+    const QJsonObject rs = relay.statsJson();
+    const int missed = frames - delivered;
+    Bench::report("udm-loss", QString("frames=%1 size=%2 fps=%3 loss=%4% burst=%5 fec=%6 nack=%7 batched=%8")
+                  .arg(frames).arg(size).arg(fps).arg(loss, 0, 'f', 1).arg(burst).arg(fec)
+                  .arg(nack ? "on" : "off").arg(relay.isBatched() ? "yes" : "no"));
+    Bench::report("udm-loss", QString("chunks relayed->rx=%1 dropped=%2 (%3%)")
+                  .arg(link.chunks).arg(link.dropped)
+                  .arg(link.chunks ? 100.0 * link.dropped / link.chunks : 0.0, 0, 'f', 2));
+    Bench::report("udm-loss", QString("frames delivered=%1 (clean %2, recovered %3) missed=%4 (%5%) corrupt=%6 dup=%7")
+                  .arg(delivered).arg(delivered - recovered).arg(recovered).arg(missed)
+                  .arg(frames ? 100.0 * missed / frames : 0.0, 0, 'f', 2).arg(corrupt).arg(dup));
+    Bench::report("udm-loss", QString("fecRecovered=%1 nacksSent=%2 relay retransmits=%3 nackMiss=%4 nackLimited=%5")
+                  .arg(rx.fecRecovered()).arg(rx.nacksSent())
+                  .arg(rs.value("retransmits").toDouble()).arg(rs.value("nackMiss").toDouble())
+                  .arg(rs.value("nackLimited").toDouble()));
+    Bench::report("udm-loss", QString("latency avg=%1ms p50=%2ms p99=%3ms")
+                  .arg(latency.avgMs(), 0, 'f', 2).arg(latency.pctMs(0.50), 0, 'f', 2)
+                  .arg(latency.pctMs(0.99), 0, 'f', 2));
+    return corrupt ? 1 : 0;
+}
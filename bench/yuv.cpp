@@ -0,0 +1,239 @@
+#include "bench.h"
+#include "yuvconvert.h"
+
+// YuvConvert 计时与核对：每种源格式 × 640x480 / 1280x720 / 1920x1080，输出为原尺寸与一半尺寸
+// - 源帧为随机样本（含有限范围外的值，覆盖截断），行距带填充
+// - I420 参考按定义逐点计算：比例 1 直接取样，比例 r>=2 取采样中心两侧相邻两点（横纵组合后平均，四舍五入）
+// - RGB 参考对参考 I420 逐像素调用标量 yuvToRgb；I420 须完全一致，RGB 每通道差异不超过 1
+namespace {
+
+using namespace YuvConvert;
+
+const char* formatName(Format f)
+{
+    switch (f) {
+    case YUYV: return "YUYV";
+    case UYVY: return "UYVY";
+    case NV12: return "NV12";
+    case NV21: return "NV21";
+    case I420: return "I420";
+    case YV12: return "YV12";
+    default:   return "?";
+    }
+}
+
+// 逻辑平面：Y 为 w×h，U/V 为 cw×ch（4:2:2 时 ch = h）
+struct Plane {
+    int w = 0, h = 0;
+    QVector<uchar> px;
+    uchar at(int x, int y) const { return px[y * w + x]; }
+};
+
+struct SourceFrame {
+    Plane y, u, v;
+    QByteArray buf[3];
+    Frame frame;
+};
+
+void fillRandom(Plane& p, int w, int h, quint32& seed)
+{
+    p.w = w; p.h = h;
+    p.px.resize(w * h);
+    for (uchar& c : p.px) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        c = uchar(seed >> 8);
+    }
+}
+
+// 按格式把逻辑平面排布进带填充的缓冲
+void buildSource(Format fmt, int w, int h, quint32 seed, SourceFrame& s)
+{
+    const bool packed = fmt == YUYV || fmt == UYVY;
+    const int pad = 32;
+    fillRandom(s.y, w, h, seed);
+    fillRandom(s.u, w / 2, packed ? h : h / 2, seed);
+    fillRandom(s.v, w / 2, packed ? h : h / 2, seed);
+
+    Frame& f = s.frame;
+    f = Frame();
+    f.fmt = fmt;
+    f.width = w;
+    f.height = h;
+    if (packed) {
+        const int stride = w * 2 + pad;
+        s.buf[0] = QByteArray(stride * h, '\0');
+        for (int y = 0; y < h; ++y) {
+            uchar* r = reinterpret_cast<uchar*>(s.buf[0].data()) + y * stride;
+            for (int x = 0; x < w / 2; ++x) {
+                uchar* q = r + 4 * x;
+                const uchar y0 = s.y.at(2 * x, y), y1 = s.y.at(2 * x + 1, y);
+                const uchar u = s.u.at(x, y), v = s.v.at(x, y);
+                if (fmt == YUYV) { q[0] = y0; q[1] = u; q[2] = y1; q[3] = v; }
+                else             { q[0] = u; q[1] = y0; q[2] = v; q[3] = y1; }
+            }
+        }
+        f.planes[0] = reinterpret_cast<const uchar*>(s.buf[0].constData());
+        f.strides[0] = stride;
+        return;
+    }
+
+    const int ys = w + pad;
+    s.buf[0] = QByteArray(ys * h, '\0');
+    for (int y = 0; y < h; ++y)
+        memcpy(s.buf[0].data() + y * ys, s.y.px.constData() + y * w, size_t(w));
+    f.planes[0] = reinterpret_cast<const uchar*>(s.buf[0].constData());
+    f.strides[0] = ys;
+
+    const int cw = w / 2, ch = h / 2;
+    if (fmt == NV12 || fmt == NV21) {
+        const int cs = w + pad;
+        s.buf[1] = QByteArray(cs * ch, '\0');
+        for (int y = 0; y < ch; ++y) {
+            uchar* r = reinterpret_cast<uchar*>(s.buf[1].data()) + y * cs;
+            for (int x = 0; x < cw; ++x) {
+                r[2 * x]     = fmt == NV12 ? s.u.at(x, y) : s.v.at(x, y);
+                r[2 * x + 1] = fmt == NV12 ? s.v.at(x, y) : s.u.at(x, y);
+            }
+        }
+        f.planes[1] = reinterpret_cast<const uchar*>(s.buf[1].constData());
+        f.strides[1] = cs;
+        return;
+    }
+
+    // I420：planes[1] = U；YV12：planes[1] = V
+    const int cs = cw + pad / 2;
+    const Plane* order[2] = { fmt == I420 ? &s.u : &s.v, fmt == I420 ? &s.v : &s.u };
+    for (int i = 0; i < 2; ++i) {
+        s.buf[i + 1] = QByteArray(cs * ch, '\0');
+        for (int y = 0; y < ch; ++y)
+            memcpy(s.buf[i + 1].data() + y * cs, order[i]->px.constData() + y * cw, size_t(cw));
+        f.planes[i + 1] = reinterpret_cast<const uchar*>(s.buf[i + 1].constData());
+        f.strides[i + 1] = cs;
+    }
+}
+
+// 比例 r 下输出第 i 个样本使用的源位置
+int taps(int i, int r, int* pos)
+{
+    if (r == 1) { pos[0] = i; return 1; }
+    pos[0] = r * i + r / 2 - 1;
+    pos[1] = pos[0] + 1;
+    return 2;
+}
+
+Plane reference(const Plane& src, int dw, int dh)
+{
+    Plane out;
+    out.w = dw; out.h = dh;
+    out.px.resize(dw * dh);
+    const int rx = src.w / dw, ry = src.h / dh;
+    int px[2], py[2];
+    for (int y = 0; y < dh; ++y) {
+        const int ny = taps(y, ry, py);
+        for (int x = 0; x < dw; ++x) {
+            const int nx = taps(x, rx, px);
+            int sum = 0;
+            for (int j = 0; j < ny; ++j)
+                for (int i = 0; i < nx; ++i) sum += src.at(px[i], py[j]);
+            const int n = nx * ny;
+            out.px[y * dw + x] = uchar((sum + n / 2) / n);
+        }
+    }
+    return out;
+}
+
+int countMismatch(const Plane& ref, const uchar* p, int stride)
+{
+    int bad = 0;
+    for (int y = 0; y < ref.h; ++y)
+        for (int x = 0; x < ref.w; ++x)
+            if (p[y * stride + x] != ref.at(x, y)) ++bad;
+    return bad;
+}
+
+} // namespace
+
+int benchYuv(const QStringList& args)
+{
+    const int iters = qMax(1, Bench::argInt(args, "--iters", 30));
+    const QSize sizes[] = { QSize(640, 480), QSize(1280, 720), QSize(1920, 1080) };
+    const Format formats[] = { YUYV, UYVY, NV12, NV21, I420, YV12 };
+    int failures = 0;
+
+    for (const QSize& sz : sizes) {
+        for (Format fmt : formats) {
+            SourceFrame src;
+            buildSource(fmt, sz.width(), sz.height(), quint32(sz.width() * 31 + int(fmt)), src);
+
+            for (int div = 1; div <= 2; ++div) {
+                const QSize dst(sz.width() / div, sz.height() / div);
+                Planar planar;
+                QImage rgb;
+                Bench::Samples scale, convert;
+                bool ok = true;
+                for (int i = 0; i < iters && ok; ++i) {
+                    QElapsedTimer t; t.start();
+                    ok = scaleToI420(src.frame, dst, planar);
+                    scale.add(t.nsecsElapsed() / 1000);
+                    t.restart();
+                    ok = ok && i420ToRgb32(planar, rgb);
+                    convert.add(t.nsecsElapsed() / 1000);
+                }
+                if (!ok) {
+                    Bench::report("yuv", QString("%1 %2x%3 -> %4x%5 FAILED (conversion returned false)")
+                                  .arg(formatName(fmt)).arg(sz.width()).arg(sz.height())
+                                  .arg(dst.width()).arg(dst.height()));
+                    ++failures;
+                    continue;
+                }
+
+                // 核对 I420
+                const Plane ry = reference(src.y, dst.width(), dst.height());
+                const Plane ru = reference(src.u, dst.width() / 2, dst.height() / 2);
+                const Plane rv = reference(src.v, dst.width() / 2, dst.height() / 2);
+                const int badI420 = countMismatch(ry, planar.plane(0), planar.stride(0))
+                                  + countMismatch(ru, planar.plane(1), planar.stride(1))
+                                  + countMismatch(rv, planar.plane(2), planar.stride(2));
+
+                // 核对 RGB：参考 I420 逐像素走标量公式（整帧计时，作为标量基线）
+                const int w = dst.width();
+                QVector<QRgb> ref(w * dst.height());
+                QElapsedTimer t; t.start();
+                for (int y = 0; y < dst.height(); ++y)
+                    for (int x = 0; x < w; ++x)
+                        ref[y * w + x] = yuvToRgb(ry.at(x, y), ru.at(x / 2, y / 2), rv.at(x / 2, y / 2));
+                const double scalarMs = t.nsecsElapsed() / 1e6;
+                int maxDiff = 0, offByOne = 0;
+                for (int y = 0; y < dst.height(); ++y) {
+                    const QRgb* row = reinterpret_cast<const QRgb*>(rgb.constScanLine(y));
+                    const QRgb* want = ref.constData() + y * w;
+                    for (int x = 0; x < w; ++x) {
+                        const int d = qMax(qAbs(qRed(row[x]) - qRed(want[x])),
+                                      qMax(qAbs(qGreen(row[x]) - qGreen(want[x])),
+                                           qAbs(qBlue(row[x]) - qBlue(want[x]))));
+                        maxDiff = qMax(maxDiff, d);
+                        if (d == 1) ++offByOne;
+                    }
+                }
+
+                const bool pass = badI420 == 0 && maxDiff <= 1;
+                if (!pass) ++failures;
+                Bench::report("yuv", QString("%1 %2x%3 -> %4x%5 scaleToI420=%6ms i420ToRgb32=%7ms (scalar %8ms) "
+                                             "i420Mismatch=%9 rgbMaxDiff=%10 offBy1=%11 %12")
+                              .arg(formatName(fmt)).arg(sz.width()).arg(sz.height())
+                              .arg(dst.width()).arg(dst.height())
+                              .arg(scale.avgMs(), 0, 'f', 3).arg(convert.avgMs(), 0, 'f', 3)
+                              .arg(scalarMs, 0, 'f', 3)
+                              .arg(badI420).arg(maxDiff).arg(offByOne)
+                              .arg(pass ? "OK" : "FAIL"));
+            }
+        }
+    }
+#if defined(__SSE2__) || defined(_M_X64)
+    const char* isa = "sse2";
+#else
+    const char* isa = "scalar";
+#endif
+    Bench::report("yuv", QString("iters=%1 isa=%2 failures=%3").arg(iters).arg(isa).arg(failures));
+    return failures ? 1 : 0;
+}
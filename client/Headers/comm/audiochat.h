@@ -59,6 +59,7 @@ private:
     void onMicReadyRead();
     void mixTick();
     void shrinkQueueIfNeeded(QByteArray& q);
+    void enqueuePeer(const QString& sender, const QByteArray& payload, bool mulaw);
 
     ClientConn* conn_ = nullptr;
     QString roomId_;
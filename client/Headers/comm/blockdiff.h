@@ -0,0 +1,45 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+// 整帧分块变化检测（RGB32）
+// - 行主序单遍扫描：逐行对仍未判脏的块比较该行片段，判脏后该块剩余行直接跳过
+// - 行片段比较按 CPU 能力选择 AVX2 / SSE2 / memcmp（启动时探测一次）
+// - Hash 模式：缓存参考帧每块的 64 位哈希，只读当前帧即可判定，不再访问旧图
+class BlockDiff {
+public:
+    enum Mode { Compare, Hash };
+
+    void setMode(Mode m) { if (m != mode_) { mode_ = m; reset(); } }
+    Mode mode() const { return mode_; }
+
+    // 计算 curr 相对参考帧的变化位图（bx*by，行主序，非 0 为变化），返回变化块数
+    // Compare 模式参考帧为 prev；Hash 模式忽略 prev，参考帧为上一次调用的 curr
+    // 尺寸/块大小变化或无参考时全部判脏
+    int detect(const QImage& prev, const QImage& curr, int block, QVector<quint8>& dirty);
+
+    // 总是逐块比较 ref 与 curr（ref 可为参考帧经平移预测后的图像）；Hash 模式同时以 curr 刷新哈希缓存
+    int detectAgainst(const QImage& ref, const QImage& curr, int block, QVector<quint8>& dirty);
+
+    // 运动检测用的线段哈希（按条带主序）：
+    // stripHashes 把图像按 bs 宽切成竖条，out[gx*H + y] 为第 gx 条第 y 行片段的哈希
+    // bandHashes  把图像按 bs 高切成横带，out[gy*W + x] 为第 gy 带第 x 列片段的哈希
+    static void stripHashes(const QImage& img, int bs, QVector<quint64>& out);
+    static void bandHashes(const QImage& img, int bs, QVector<quint64>& out);
+
+    // 丢弃哈希缓存（下一帧全部判脏）
+    void reset() { hashes_.clear(); }
+
+    static const char* isaName();
+
+private:
+    int detectCompare(const QImage& prev, const QImage& curr, int block, QVector<quint8>& dirty);
+    int detectHash(const QImage& curr, int block, QVector<quint8>& dirty);
+    static void hashBlocks(const QImage& curr, int bs, QVector<quint64>& out);
+
+    Mode mode_ = Compare;
+    QVector<quint64> hashes_;
+    QVector<quint64> scratch_;
+    QSize hashSize_;
+    int hashBlock_ = 0;
+};
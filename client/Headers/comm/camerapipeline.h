@@ -0,0 +1,74 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+#include <QVideoFrame>
+#include "jpegcodec.h"
+#include "yuvconvert.h"
+
+// 摄像头发送管线（独立线程）：取帧、限流、转换、压缩、打包都不占用 GUI 线程
+// - submit 可在任意线程调用；上一帧未处理完时直接丢弃（容量 1，不积压相机缓冲）
+// - 超出目标帧率的帧在 map/转换之前丢弃
+// - YUV 来源一次缩小到发送尺寸的 I420 后直接压缩，RGB 只按预览尺寸生成；RGB 来源复制后缩放压缩
+// - 输出打包好的整帧，由连接直接写出；GUI 只收到预览图
+// 各阶段耗时每 5 秒输出一次 [CAMERA]
+class CameraPipeline : public QObject {
+    Q_OBJECT
+public:
+    CameraPipeline();
+
+    void submit(const QVideoFrame& frame);
+
+public slots:
+    // v2 为 false 或 streamId 为 0 时按 v1（JSON 头）打包
+    void setIdentity(QString roomId, QString sender, bool mediaV2, quint16 streamId);
+    void setParams(QSize sendSize, int fps, int quality);
+    void setPreviewBound(QSize bound);
+
+signals:
+    void packetReady(QByteArray frame);
+    void previewReady(QImage img);
+    void formatChanged(int pixelFormat);
+    void statsUpdated(QJsonObject stats);
+
+private slots:
+    void process(QVideoFrame frame, qint64 submitUs);
+    void onStatsTimer();
+
+private:
+    struct Stage {
+        qint64 us = 0, maxUs = 0;
+        int n = 0;
+        void add(qint64 v) { us += v; maxUs = qMax(maxUs, v); ++n; }
+        double avgMs() const { return n ? us / 1000.0 / n : 0.0; }
+    };
+
+    QByteArray pack(const QSize& size);
+    qint64 nowUs() const { return clock_.nsecsElapsed() / 1000; }
+
+    QAtomicInt pending_{0};
+    QAtomicInt dropBusy_{0};
+    QElapsedTimer clock_;       // 构造时启动，之后只读
+
+    // 以下只在管线线程访问
+    QString roomId_, sender_;
+    bool mediaV2_ = false;
+    quint16 streamId_ = 0;
+    QSize sendSize_ = QSize(640, 480);
+    int targetFps_ = 10;
+    int quality_ = 55;
+    QSize previewBound_;
+    QElapsedTimer lastSend_;
+    quint32 seq_ = 0;
+    QVideoFrame::PixelFormat lastFormat_ = QVideoFrame::Format_Invalid;
+
+    YuvConvert::Planar planar_;         // 发送尺寸的 I420，跨帧复用
+    YuvConvert::Planar previewPlanar_;
+    JpegCodec jpeg_;
+    QByteArray jpegBuf_;
+
+    Stage wait_, convert_, preview_, encode_, pack_, total_;
+    int frames_ = 0, dropRate_ = 0, failed_ = 0;
+    qint64 bytes_ = 0;
+    QElapsedTimer statsClock_;
+    QTimer statsTimer_;
+};
@@ -10,6 +10,15 @@ public:
     void connectTo(const QString& host, quint16 port);
     void disconnectFromHost();                    // 新增：断开连接
     void send(quint16 type, const QJsonObject& json, const QByteArray& bin = QByteArray());
+    // v2 媒体帧：无 JSON，调用方需先确认 mediaV2()
+    void sendMedia(quint16 type, const MediaHeader& h, const QByteArray& payload);
+    // 已打包好的整帧（如摄像头管线线程打包的结果）
+    void sendRaw(const QByteArray& frame);
+
+    // 加入房间时协商出的 v2 媒体参数
+    bool mediaV2() const { return mediaV2_; }
+    quint16 localStreamId() const { return localStreamId_; }
+    QString senderOfStream(quint16 streamId) const { return streamSenders_.value(streamId); }
 
     bool isConnected() const { return sock_.state() == QAbstractSocket::ConnectedState; }
     qint64 bytesToWrite() const { return sock_.bytesToWrite(); }
@@ -26,6 +35,12 @@ private slots:
     void onError(QAbstractSocket::SocketError);
 
 private:
+    void trackStreams(const Packet& p);
+
     QTcpSocket sock_;
-    QByteArray buf_;
+    RecvBuffer buf_;
+
+    bool mediaV2_ = false;
+    quint16 localStreamId_ = 0;
+    QHash<quint16, QString> streamSenders_; // streamId -> user
 };
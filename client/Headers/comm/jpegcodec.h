@@ -0,0 +1,44 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+// JPEG 编解码（摄像头、屏幕关键帧与 JPEG 矩形共用）
+// - 构建时找到 libjpeg-turbo（pkg-config libturbojpeg）则直接调用 TurboJPEG：
+//   RGB32 按 BGRX 原样压缩、I420 平面直接压缩，解码直接写入调用方的 RGB32 目标图
+// - 否则回退 QImageWriter / QImageReader，接口与缓冲复用方式不变
+// - 输出 QByteArray 与目标 QImage 由调用方持有并跨帧复用：容量足够且未被共享时不再分配
+// 单个实例不可并发使用；工作线程用 forThread() 取本线程实例
+class JpegCodec {
+public:
+    JpegCodec();
+    ~JpegCodec();
+    JpegCodec(const JpegCodec&) = delete;
+    JpegCodec& operator=(const JpegCodec&) = delete;
+
+    static JpegCodec& forThread();
+    static const char* backend();   // "turbojpeg" / "qt"
+
+    // RGB32/ARGB32 -> JPEG（4:2:0）
+    bool encode(const QImage& img, int quality, QByteArray& out);
+    // I420 三平面 -> JPEG，免去先转 RGB
+    bool encodeI420(const uchar* const planes[3], const int strides[3], int w, int h,
+                    int quality, QByteArray& out);
+
+    // JPEG -> RGB32，尺寸或格式不符时才重建 dst
+    // fitWithin 有效时利用 DCT 缩放（1/2、1/4、1/8）解到不小于 fitWithin 的最小尺寸
+    bool decode(const char* data, int len, QImage& dst, const QSize& fitWithin = QSize());
+    bool decode(const QByteArray& jpeg, QImage& dst, const QSize& fitWithin = QSize()) {
+        return decode(jpeg.constData(), jpeg.size(), dst, fitWithin);
+    }
+
+    // 只解析头部得到原始尺寸；失败返回无效尺寸
+    QSize imageSize(const char* data, int len);
+
+    // 按 DCT 缩放可得到的最小尺寸，保证等比放入 fitWithin 时不需要放大（fitWithin 无效时为原尺寸）
+    static QSize scaledSize(const QSize& full, const QSize& fitWithin);
+
+private:
+    void* enc_ = nullptr;   // tjhandle
+    void* dec_ = nullptr;
+    QImage convBuf_;        // 非 RGB32 输入的转换缓冲（回退路径与 TurboJPEG 共用）
+};
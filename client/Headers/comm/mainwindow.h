@@ -6,10 +6,12 @@
 #include <QImage>
 #include <QSize>
 #include <QElapsedTimer>
+#include <QThread>
 #include <QVideoFrame>
 
 class QWidget;
 class QLabel;
+class VideoSurface;
 class QToolButton;
 class QTimer;
 class QLineEdit;
@@ -32,19 +34,25 @@ class UdpMediaClient;
 
 #include "clientconn.h" // ClientConn 为值成员，需要完整类型
 #include "protocol.h"   // 使用 Packet
+#include "jpegcodec.h"
+#include "remotedecoder.h"
+#include "tilecompositor.h"
+#include "camerapipeline.h"
 
 // 单个视频窗口（本地或远端）
 struct VideoTile {
     QString      key;
     QWidget*     box       = nullptr;
     QLabel*      name      = nullptr;
-    QLabel*      video     = nullptr;
+    VideoSurface* video    = nullptr;
     QToolButton* volBtn    = nullptr;
     QTimer*      timer     = nullptr;
 
     QImage       lastCam;
     QImage       lastScreen;
     bool         camPrimary = false;  // true: 相机为大图；false: 屏幕为大图
+    TileCompositor thumbComp;         // 窗口内合成
+    TileCompositor mainComp;          // 作为主画面时的合成
     int          volPercent = 100;
 };
 
@@ -53,6 +61,7 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 public:
     explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow() override;
 
     enum class ViewMode { Grid, Focus };
 
@@ -89,7 +98,7 @@ private:
     void updateMainFitted();
     void refreshTilePixmap(VideoTile* t);
     void togglePiP(VideoTile* t);
-    QImage composeTileImage(const VideoTile* t, const QSize& target);
+    QSize remoteCamDecodeSize(const VideoTile* t) const;
 
     // 摄像头/屏幕共享
     void startCamera();
@@ -97,10 +106,11 @@ private:
     void configureCamera(QCamera* cam);
     void hookCameraLogs(QCamera* cam);
 
-    // 帧处理与发送
-    QImage makeImageFromFrame(const QVideoFrame &frame);
+    // 帧处理与发送（转换/压缩/打包在 CameraPipeline 线程）
     void updateLocalPreview(const QImage& img);
-    void sendImage(const QImage& img);
+    QSize localPreviewBound() const;
+    void syncCameraIdentity();
+    void syncCameraParams();
 
     // 共享画质
     void applyShareQualityPreset();
@@ -131,7 +141,7 @@ private:
     // Focus 模式
     QWidget*     focusPage_           = nullptr;
     QWidget*     mainArea_            = nullptr;
-    QLabel*      mainVideo_           = nullptr;
+    VideoSurface* mainVideo_          = nullptr;
     QLabel*      mainName_            = nullptr;
     QWidget*     focusThumbContainer_ = nullptr;
     QGridLayout* focusThumbLayout_    = nullptr;
@@ -158,8 +168,8 @@ private:
     QString                    mainKey_;
     static constexpr const char* kLocalKey_ = "__local__";
 
-    // 屏幕增量还原背板
-    QMap<QString, QImage>      screenBack_;
+    // 远端视频解码（含屏幕增量还原背板），在工作线程完成后回投
+    RemoteDecoder*             decoder_ = nullptr;
 
     // 媒体/网络
     ClientConn     conn_;
@@ -170,11 +180,12 @@ private:
     // 摄像头
     QCamera*                     camera_ = nullptr;
     QVideoProbe*                 probe_  = nullptr;
-    QVideoFrame::PixelFormat     lastLoggedFormat_ = QVideoFrame::Format_Invalid;
+    QThread                      camThread_;
+    CameraPipeline*              camPipeline_ = nullptr;
+    QSize                        camPreviewBound_;   // 已同步给管线的预览尺寸
 
     // 发送参数
     QSize                        sendSize_ = QSize(640, 480);
     int                          targetFps_ = 10;
     int                          jpegQuality_ = 55;
-    QElapsedTimer                lastSend_;
 };
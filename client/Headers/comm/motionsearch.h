@@ -0,0 +1,30 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+#include "screencodec.h"
+
+// 屏幕区域平移检测（滚动/拖动），输出可由接收端背板直接执行的区域复制
+// - 竖直：图像按块宽切成竖条，各竖条在其变化行范围内用行片段哈希投票求偏移
+// - 水平：竖直无结果时，按块高切成横带，用列片段哈希同样处理
+// - 偏移相同的相邻条带合并为一个区域，取所有条带同时匹配的最长连续段
+// 同一帧只输出同一方向的复制，各复制的源与目标落在互不相交的条带内，顺序执行互不影响
+class MotionSearch {
+public:
+    enum {
+        kMinVotes = 8,   // 单条带内唯一片段投票数下限
+        kMinRun   = 48,  // 复制区域沿运动方向的最小长度（像素）
+        kMaxOps   = 4    // 每帧最多复制数（按面积取大者）
+    };
+
+    // dirty 为 prev->curr 的变化位图（bs 块，行主序）；找到平移区域时返回 true
+    bool find(const QImage& prev, const QImage& curr, const QVector<quint8>& dirty, int bs,
+              QVector<ScreenCodec::CopyOp>& ops);
+
+private:
+    // lanes 条带、每条 len 个位置的哈希（条带主序）；span 为各条带的变化范围 [a,b)，a>=b 表示无变化
+    void searchAxis(int lanes, int len, const QVector<QPair<int,int>>& span, QVector<ScreenCodec::CopyOp>& ops,
+                    bool vertical, int bs, int laneLimit);
+
+    QVector<quint64> prevH_, currH_;
+    QVector<int> laneOffset_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+// 远端视频接收解码池（GUI 线程持有，解码在内部线程池完成，避免阻塞界面与混音定时器）
+// - 每个发送端一条通道，同一时刻只在一个工作线程上运行；屏幕增量按到达顺序应用到该发送端背板
+// - 落后时合并：摄像头帧只保留最新一帧；新关键帧到达即丢弃其前尚未处理的增量；
+//   待处理增量超过 kMaxPendingDeltas 时整体丢弃并请求关键帧
+// - 结果回投 GUI 线程：每条通道最多一个在途通知，未取走的结果被新结果覆盖
+// 以上被合并掉的帧都计入 skipped
+class RemoteDecoder : public QObject {
+    Q_OBJECT
+public:
+    enum { kMaxPendingDeltas = 30, kMaxDirtyRects = 64 };
+
+    explicit RemoteDecoder(QObject* parent = nullptr);
+    ~RemoteDecoder() override;
+
+    // fitWithin 为显示尺寸，按 DCT 缩放解码（无效时全尺寸）
+    void submitCamera(const QString& sender, const QByteArray& jpeg, const QSize& fitWithin);
+    void submitScreenKey(const QString& sender, const QByteArray& jpeg);
+    void submitScreenDelta(const QString& sender, const QByteArray& blob, const QSize& size);
+    // 发送端离开：丢弃待处理任务与背板
+    void removeSender(const QString& sender);
+
+    // 最近统计窗口内各发送端的解码耗时、到达至可显示时延与跳过帧数
+    QJsonObject stats() const { return lastStats_; }
+
+signals:
+    void cameraReady(const QString& sender, const QImage& img);
+    // dirty 为自上次通知以来背板改写的区域（源坐标），为空表示整幅
+    void screenReady(const QString& sender, const QImage& img, const QVector<QRect>& dirty);
+    void keyframeNeeded(const QString& sender);
+    void statsUpdated(QJsonObject stats);
+
+private slots:
+    void onStatsTimer();
+
+private:
+    struct Lane;
+    using LanePtr = QSharedPointer<Lane>;
+
+    LanePtr laneFor(const QString& sender);     // 调用方持锁
+    void schedule(const LanePtr& lane);         // 调用方持锁
+    void drain(LanePtr lane);                   // 工作线程
+    void deliver(const QString& sender);        // GUI 线程
+    qint64 nowUs() const { return clock_.nsecsElapsed() / 1000; }
+
+    QMutex mutex_;
+    QHash<QString, LanePtr> lanes_;
+    QThreadPool pool_;
+    QElapsedTimer clock_;
+
+    QTimer statsTimer_;
+    QJsonObject lastStats_;
+};
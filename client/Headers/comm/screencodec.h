@@ -0,0 +1,83 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+// 屏幕增量帧编解码（发送端 ScreenEncodeStage 与接收端 MainWindow 共用）
+//
+// DS02 blob（BigEndian）：
+//   u32 magic='DS02', u16 rectCount,
+//   [rectLoop] u16 x, u16 y, u16 w, u16 h, u8 codec, u32 compLen, [compData...]
+// codec 低 4 位为 RectCodec，高位为变换标志（见下）；rectCount 为 0 表示无变化
+// RECT_COPY 项排在最前，按顺序串行执行（数据为 u16 sx, u16 sy：把背板 (sx,sy,w,h) 复制到 (x,y)），
+// 之后的像素矩形互不重叠，收发两端均可并行处理，预测以执行完复制后的背板为参考；
+// 接收端发现像素矩形相交时不并行，按 blob 顺序串行解码
+// 仍可解码旧的 DS01（无 codec 字节，均为 qCompress 等级 6）
+namespace ScreenCodec {
+
+constexpr quint32 kMagicDS01 = 0x44533031; // 'DS01'
+constexpr quint32 kMagicDS02 = 0x44533032; // 'DS02'
+
+// 矩形编码（像素均为 RGB32 行拼接）
+enum RectCodec : quint8 {
+    RECT_ZLIB = 1,  // qCompress 等级 1
+    RECT_LZ   = 2,  // LZ4 风格块压缩：纯色/界面区域最快
+    RECT_JPEG = 3,  // 照片类区域，有损
+    RECT_COPY = 4   // 背板内区域复制（滚动）
+};
+
+// 无损矩形的变换标志，解码顺序：解压 -> 调色板展开 -> 加回预测
+enum RectFlag : quint8 {
+    FLAG_PALETTE = 0x20, // 数据为 u8 (n-1) + 压缩的 [n 个 u32 颜色][逐行按 1/2/4/8 位打包的索引]
+    FLAG_PRED    = 0x40, // 像素为相对背板同位置的逐字节差值（mod 256），未变像素为 0
+    CODEC_MASK   = 0x0F
+};
+
+// 区域复制：把参考图 src 起、dst 大小的区域复制到 dst
+struct CopyOp {
+    QRect  dst;
+    QPoint src;
+};
+
+// 接收端背板的镜像（发送端持有）：像素 + 按 kCell 方格记录的有损标记
+// JPEG 像素由接收端自己的解码器还原，与发送端的解码结果不保证逐位一致；
+// 接收端不知道哪些格有损，因此与有损格相交的矩形整体不做差值预测
+struct Mirror {
+    enum { kCell = 16 };
+    QImage img;
+    QVector<quint8> lossy;   // 每格 1 字节，行优先；非 0 表示该格含有损像素
+
+    // img 换成关键帧后调用：lossyKey 为 true（JPEG 关键帧）时全部标为有损
+    void markAll(bool lossyKey);
+};
+
+enum Policy {
+    AutoCodec,  // 按采样颜色多样性估计选择 LZ / ZLIB / JPEG
+    ForceZlib,
+    ForceLz,
+    ForceJpeg
+};
+
+// 编码：rects 由调用方保证互不重叠且位于 curr 内
+// ref 为接收端背板的镜像（含有损编码后的像素），用作预测并随本帧原地更新（像素与有损标记）；
+// 为空或尺寸不符时按接收端的处理方式重建为黑底；标记与图像尺寸不符时按全部有损处理
+QByteArray encodeDelta(const QImage& curr, const QVector<QRect>& rects,
+                       const QVector<CopyOp>& copies, Mirror& ref,
+                       Policy policy = AutoCodec, int jpegQuality = 60);
+
+// 解码到背板（RGB32，尺寸由调用方准备）；格式错误返回 false，已写入的矩形保留
+// dirty 非空时追加本帧改写的区域（复制目标与像素矩形），供显示端局部重绘
+bool decodeDelta(const QByteArray& blob, QImage& back, QVector<QRect>* dirty = nullptr);
+
+// 在 img 内执行区域复制（源与目标可重叠）；越界返回 false 且不修改
+bool applyCopy(QImage& img, const CopyOp& op);
+
+// LZ 块压缩（输出不含长度，解压时需给出原始长度）
+QByteArray lzCompress(const char* src, int size);
+bool lzDecompress(const char* src, int size, char* dst, int dstSize);
+
+// 各编码的累计耗时与字节，"[SCODEC] ..." 形式
+QString statsSummary();
+
+} // namespace ScreenCodec
+
+Q_DECLARE_METATYPE(ScreenCodec::CopyOp)
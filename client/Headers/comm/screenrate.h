@@ -0,0 +1,61 @@
+#pragma once
+#include <QtCore>
+
+// 屏幕共享码率控制（ScreenShare 所在线程使用，无锁）
+// 输入：每帧流水线耗时（采集到可发送）与字节数、采集/压缩丢帧、各接收端的丢帧率与回路时延
+// 输出：档位（缩放 × 帧率）、JPEG 质量、周期关键帧间隔
+// - 每秒评估一次：CPU 或网络任一拥塞即降一档（网络拥塞同时降质量），
+//   连续 kUpAfterSec 秒全部良好才升一档（先恢复档位再恢复质量）
+// - 有接收端回报时关键帧改由接收端请求触发，周期关键帧只作兜底
+class ScreenRateControl {
+public:
+    enum {
+        kLevels = 7,
+        kMinQuality = 30,
+        kMaxLoopMs = 400,      // 回路时延上限，超过视为排队
+        kGoodLoopMs = 200,
+        kMaxLossPermille = 50,
+        kGoodLossPermille = 10,
+        kUpAfterSec = 5,
+        kReportTtlMs = 5000,   // 超过该时长无回报的接收端不再参与
+        kKeyIntervalLegacyMs = 1000,
+        kKeyIntervalFeedbackMs = 10000
+    };
+
+    // 上限：用户预设的尺寸/帧率/质量
+    void setCeiling(int fps, int quality);
+
+    void onFrameSent(int bytes, qint64 pipelineMs);
+    void onReceiverReport(const QString& receiver, int lossPermille, qint64 loopMs, qint64 nowMs);
+
+    // 每秒调用；captured/dropped 为本窗口采集帧数与丢帧数。目标变化返回 true
+    bool update(qint64 nowMs, int captured, int dropped);
+
+    double scale() const;
+    int fps() const;
+    int quality() const { return quality_; }
+    int keyIntervalMs(qint64 nowMs) const;
+    int level() const { return level_; }
+
+    QJsonObject stateJson() const;
+
+private:
+    struct Report { int loss = 0; qint64 loopMs = -1; qint64 atMs = 0; };
+    QHash<QString, Report> reports_;
+
+    int ceilFps_ = 10;
+    int ceilQuality_ = 55;
+    int level_ = 0;
+    int quality_ = 55;
+    int goodStreak_ = 0;
+    qint64 lastDownMs_ = 0;
+
+    // 当前窗口
+    qint64 winBytes_ = 0, winPipeMs_ = 0;
+    int winFrames_ = 0;
+    // 上一窗口结果（用于日志）
+    double lastKbps_ = 0, lastPipeMs_ = 0;
+    int lastLoss_ = 0;
+    qint64 lastLoop_ = -1;
+    bool lastCpuBusy_ = false, lastNetBusy_ = false;
+};
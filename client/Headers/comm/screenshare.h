@@ -4,34 +4,71 @@
 #include <QtMultimedia>
 #include "clientconn.h"
 #include "protocol.h"
+#include "blockdiff.h"
+#include "screencodec.h"
+#include "motionsearch.h"
+#include "screenrate.h"
+#include "jpegcodec.h"
 
 class UdpMediaClient;
+class ScreenDiffStage;
+class ScreenEncodeStage;
+
+// 屏幕共享流水线：采集 -> 缩放/比对 -> 压缩 -> 分片发送
+// - 采集：GUI 线程（grabWindow/QPixmap 只能在 GUI 线程使用），只做抓屏与 toImage
+// - 缩放/比对：ScreenDiffStage 工作线程，维护参考帧，决定关键帧或增量矩形（含滚动/拖动区域复制）
+// - 压缩：ScreenEncodeStage 工作线程，DS02 增量（矩形并行压缩）或 JPEG 关键帧，
+//   并维护接收端背板的镜像作为差值预测的参考
+// - 分片发送：UdpMediaClient 所在线程（socket 归属线程）
+// 队列均有界：比对阶段忙则丢弃新采集帧；压缩队列满则比对阶段丢帧且不推进参考帧，
+// 已比对的帧一定会被发送，保证接收端背板与参考帧一致
+// 帧率/缩放/质量由 ScreenRateControl 按流水线耗时与接收端回报每秒调整，setParams 给出上限
+struct ScreenStageStats {
+    QAtomicInteger<qint64> captureUs{0}, prepUs{0}, diffUs{0}, encodeUs{0}, sendUs{0};
+    QAtomicInt captured{0}, diffed{0}, encoded{0}, sent{0}, keyframes{0};
+    QAtomicInt dropCapture{0}, dropEncode{0};
+};
 
 class ScreenShare : public QObject {
     Q_OBJECT
 public:
     explicit ScreenShare(ClientConn* conn, QObject* parent=nullptr);
+    ~ScreenShare() override;
 
     void setIdentity(const QString& roomId, const QString& sender);
-    void setUdpClient(UdpMediaClient* udp) { udp_ = udp; }
+    void setUdpClient(UdpMediaClient* udp);
 
     void setEnabled(bool on);
     bool isEnabled() const { return enabled_; }
 
+    // 发送尺寸/帧率/质量的上限（实际值由码率控制在其下调整）
     void setParams(const QSize& sendBaseSize, int baseFps, int jpegQuality);
+    // 变化检测方式：Compare 逐块比对参考帧；Hash 只读当前帧，与缓存的块哈希比较
+    void setDiffMode(BlockDiff::Mode m);
+    // 增量矩形编码策略（默认按内容自动选择）
+    void setRectCodec(ScreenCodec::Policy p);
+
+    // 最近统计窗口内各阶段平均耗时（毫秒）与丢帧数，rate 为码率控制状态
+    QJsonObject stageTimings() const { return lastTimings_; }
 
 signals:
     void localFrameReady(QImage img);
+    void stageTimingsUpdated(QJsonObject timings);
 
 private slots:
     void onTick();
-    void onEncodedKeyframe(QByteArray jpeg, QSize wh, qint64 encodeMs);
+    void onDeltaReady(QByteArray blob, QSize wh, qint64 captureMs);
+    void onKeyReady(QByteArray jpeg, QSize wh, qint64 captureMs);
+    void onStatsTimer();
+    void onRateTimer();
+    void onReceiverReport(const QString& receiver, int lossPermille, double fps, qint64 loopMs);
+    void onKeyframeRequested(const QString& receiver);
 
 private:
     void sendControl(const char* state);
     void scheduleNext();
-    QSize clampMin720p(const QSize& in) const;
-    QByteArray buildDeltaBlob(const QImage& prev, const QImage& curr, int block) const;
+    void applyRate();
+    QSize targetSize() const;
 
     ClientConn*     conn_{};
     UdpMediaClient* udp_{nullptr};
@@ -41,38 +78,87 @@ private:
     int     intervalMs_{33};
     QSize   baseSendSize_{1280, 720};
     int     baseQuality_{50};
-    QThread worker_;
-    class KeyEncoder* encoder_{nullptr};
-    QAtomicInt keyBusy_{0};
     bool    enabled_{false};
     qint64  lastKeyMs_{0};
-    int     keyIntervalMs_{1000};
-    QImage  prevFrame_;
+    bool    keyRequested_{false};
+    qint64  lastKeyReqMs_{0};
+    enum { kKeyReqMinMs = 300 }; // 多个接收端同时请求时合并
+
+    ScreenRateControl rate_;
+    QTimer  rateTimer_;
+    int     rateCounts_[2] = {};   // 上次评估时的 captured / dropCapture+dropEncode
+
+    QThread diffThread_;
+    QThread encodeThread_;
+    ScreenDiffStage*   diffStage_{nullptr};
+    ScreenEncodeStage* encodeStage_{nullptr};
+    QAtomicInt diffBusy_{0};     // 比对阶段是否有帧在途（容量 1）
+    QAtomicInt encodeDepth_{0};  // 压缩队列深度
+    ScreenStageStats stats_;
+
+    QTimer  statsTimer_;
+    QElapsedTimer statsClock_;
+    QJsonObject lastTimings_;
+    int lastCounts_[7] = {};
+    qint64 lastUs_[5] = {};
 };
 
-class KeyEncoder : public QObject {
+// 缩放/比对阶段（工作线程）
+class ScreenDiffStage : public QObject {
     Q_OBJECT
 public:
-    explicit KeyEncoder(int quality=50) : quality_(quality) {}
-    void setQuality(int q){ quality_ = q; }
+    ScreenDiffStage(ScreenStageStats* stats, QAtomicInt* busy, QAtomicInt* encodeDepth)
+        : stats_(stats), busy_(busy), encodeDepth_(encodeDepth) {}
+
+    enum { kBlock = 32, kMaxRects = 120, kMaxEncodeQueue = 2 };
+    // 变化块达到该数才做平移检测（滚动时几乎所有块都会变化）
+    enum { kMotionMinBlocks = 16 };
+
 public slots:
-    void encode(QImage img) {
-        if (img.isNull()) { emit encoded(QByteArray(), QSize(), 0); return; }
-        const qint64 t0 = QDateTime::currentMSecsSinceEpoch();
-        QByteArray jpeg;
-        jpeg.reserve(img.width()*img.height()/6);
-        QBuffer buf(&jpeg);
-        buf.open(QIODevice::WriteOnly);
-        QImageWriter w(&buf, "jpeg");
-        w.setQuality(quality_);
-        w.setOptimizedWrite(true);
-        w.write(img);
-        buf.close();
-        const qint64 cost = QDateTime::currentMSecsSinceEpoch() - t0;
-        emit encoded(jpeg, img.size(), cost);
-    }
+    void process(QImage raw, QSize target, bool forceKey, qint64 captureMs);
+    void reset() { prev_ = QImage(); diff_.reset(); }
+    void setDiffMode(int mode) { diff_.setMode(BlockDiff::Mode(mode)); }
+
 signals:
-    void encoded(QByteArray jpeg, QSize wh, qint64 encodeMs);
+    void preview(QImage img);
+    void encodeDelta(QImage img, QVector<QRect> rects, QVector<ScreenCodec::CopyOp> copies, qint64 captureMs);
+    void encodeKey(QImage img, qint64 captureMs);
+
+private:
+    bool collectRects(const QImage& curr, QVector<QRect>& out, QVector<ScreenCodec::CopyOp>& copies);
+
+    ScreenStageStats* stats_;
+    QAtomicInt* busy_;
+    QAtomicInt* encodeDepth_;
+    QImage prev_;
+    BlockDiff diff_;
+    QVector<quint8> dirty_;
+    MotionSearch motion_;
+};
+
+// 压缩阶段（工作线程）：增量与关键帧按提交顺序串行处理，单帧内各矩形在线程池中并行压缩
+class ScreenEncodeStage : public QObject {
+    Q_OBJECT
+public:
+    ScreenEncodeStage(ScreenStageStats* stats, QAtomicInt* encodeDepth, int quality)
+        : stats_(stats), encodeDepth_(encodeDepth), quality_(quality) {}
+
+public slots:
+    void setQuality(int q) { quality_ = q; }
+    void setPolicy(int p) { policy_ = ScreenCodec::Policy(p); }
+    void encodeDelta(QImage img, QVector<QRect> rects, QVector<ScreenCodec::CopyOp> copies, qint64 captureMs);
+    void encodeKey(QImage img, qint64 captureMs);
+
+signals:
+    void deltaReady(QByteArray blob, QSize wh, qint64 captureMs);
+    void keyReady(QByteArray jpeg, QSize wh, qint64 captureMs);
+
 private:
+    ScreenStageStats* stats_;
+    QAtomicInt* encodeDepth_;
     int quality_{50};
+    ScreenCodec::Policy policy_{ScreenCodec::AutoCodec};
+    ScreenCodec::Mirror mirror_;   // 接收端背板镜像（关键帧为 JPEG 解码结果，整帧标为有损）
+    JpegCodec jpeg_;
+    QByteArray keyBuf_;
 };
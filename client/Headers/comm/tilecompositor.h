@@ -0,0 +1,40 @@
+#pragma once
+#include <QtGui>
+
+// 窗口画面合成（大图 + 画中画小窗），画布跨帧保留并按层增量更新（GUI 线程）
+// - 布局（目标尺寸、主次、两路源尺寸）变化时整幅重画
+// - 否则只重画源发生变化的一层：屏幕层按增量解码给出的脏矩形局部重缩放，
+//   小窗的缩放结果单独缓存，大图局部更新压到小窗时只重贴小窗
+// - 源图变化（cacheKey 不同）但未给出脏矩形时按整层重画
+// - 画布双缓冲：返回的图像与刚画完的画布隐式共享，显示端可一直持有；下一帧画在另一块画布上，
+//   先从上一帧补齐上次改写的区域，因此显示端已换成新帧时不会发生整幅复制
+// 每个显示目标（窗口缩略图、主画面）各持一个实例
+class TileCompositor {
+public:
+    enum { kMaxDirtyRects = 64 };
+
+    // 屏幕源自上次合成以来改写的区域（源坐标），多次调用累积；rects 为空表示整幅
+    void markScreenDirty(const QVector<QRect>& rects);
+
+    // 两路都没有时返回空图。返回值持有像素（与内部画布共享），生命周期不受本实例约束；需要修改时会自动深拷贝
+    QImage compose(const QImage& cam, const QImage& screen, bool camPrimary, const QSize& target);
+
+private:
+    QImage  canvas_[2];
+    int     front_ = 0;         // 最近一次返回的画布
+    QVector<QRect> lastDrawn_;  // 最近一次 compose 改写的画布区域
+    bool    lastFull_ = true;   // 最近一次整幅重画（或还没有画过）
+    QImage  smallLayer_;        // 小窗源按 smallFit_ 缩放后的缓存
+
+    // 当前布局
+    QSize   target_;
+    bool    pip_ = false;
+    bool    bigIsScreen_ = false;
+    QSize   bigSize_, smallSize_;
+    QRect   bigRect_, smallRect_, smallFit_, panelRect_;
+
+    // 已绘制的源
+    qint64  bigKey_ = 0, smallKey_ = 0;
+    QVector<QRect> screenDirty_;
+    bool    screenFull_ = true;
+};
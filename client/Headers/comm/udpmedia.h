@@ -2,6 +2,7 @@
 #include <QtCore>
 #include <QtNetwork>
 #include <algorithm>
+#include "udm.h"
 
 class UdpMediaClient : public QObject {
     Q_OBJECT
@@ -17,34 +18,94 @@ public:
     void sendScreenJpeg(const QByteArray& jpeg, int w, int h, qint64 tsMs = 0);
     void sendScreenDelta(const QByteArray& blob, int w, int h, qint64 tsMs = 0);
 
+    // FEC：每 n 个数据分片附加 1 个异或校验分片（开销约 1/n），组内丢 1 片可直接恢复；0 关闭
+    // 仅在取得会话 id（UDM v3）后生效
+    void setFecGroup(int n) { fecGroup_ = qBound(0, n, 64); }
+    int fecGroup() const { return fecGroup_; }
+    quint64 fecRecovered() const { return fecRecovered_; }
+
+    // NACK：v3 帧缺片且短暂静默后，向中继请求补发缺失分片（中继侧有缓存与配额限制）
+    void setNackEnabled(bool on) { nackEnabled_ = on; }
+    quint64 nacksSent() const { return nacksSent_; }
+
+    // 接收报告：每秒向各 v3 发送方回报丢帧率、收帧率与最近帧时间戳；
+    // 丢帧后自动附带关键帧请求，上层解码失败时也可主动请求（同一发送方 kKeyReqMinMs 内只发一次）
+    void requestKeyframe(const QString& sender);
+
 signals:
     void udpScreenFrame(const QString& sender, QByteArray jpeg, int w, int h, qint64 ts);
     void udpScreenDeltaFrame(const QString& sender, QByteArray blob, int w, int h, qint64 ts);
+    // 作为发送方收到的接收报告；loopMs 为采集到对端收齐再回报的回路时延，未知为 -1
+    void receiverReport(const QString& receiver, int lossPermille, double fps, qint64 loopMs);
+    void keyframeRequested(const QString& receiver);
 
 private slots:
     void onReadyRead();
     void onHeartbeat();
     void onCleanup();
+    void onNackTimer();
 
 private:
-    struct Assembly {
+    // 帧重组槽：分片直接写入预分配帧缓冲的 idx * kChunkPayload 处，位图记录已收分片
+    // 交付后槽位与缓冲保留复用；消费者若仍持有上一帧（隐式共享），复用时才会分离
+    struct FrameSlot {
+        enum State : quint8 { Free, Active, Done };
+        State   state = Free;
+        quint32 frameId = 0;
         quint8  codec = 0;
         int     w=0, h=0;
         int     chunkCnt=0;
+        int     received=0;
+        int     lastLen=-1;            // 末片长度，决定帧总长；-1 表示未知
         qint64  ts=0;
         qint64  startMs=0;
-        QVector<QByteArray> parts;
-        int     received=0;
+        qint64  lastRecvMs=0;
+        int     nackRounds=0;
+        QByteArray frame;
+        QVector<quint64> got;
+        int     fecGroup=0;            // 由首个校验分片确定
+        QByteArray parity;             // 每组 [u16 长度异或][kChunkPayload 字节异或数据]
+        QVector<quint64> gotParity;
+    };
+    // 每个发送方一个槽位环，按 frameId % kRingSlots 取槽
+    enum { kRingSlots = 4, kMaxChunks = 4096 };
+    struct SenderRing {
+        quint32 session = 0;           // v3 发送方会话 id，0 表示不支持 NACK/接收报告
+        qint64  lastSeenMs = 0;
+        FrameSlot slots[kRingSlots];
+        // 接收报告统计（每次报告后清零）
+        quint32 highestFid = 0;
+        int     framesDone = 0;
+        int     framesLost = 0;
+        quint64 lastTs = 0;            // 最近完整帧的发送方时间戳
+        qint64  lastDoneMs = 0;
+        qint64  lastKeyReqMs = 0;
     };
 
     void sendRegister();
-    void parseDatagram(const QByteArray& dgram, const QHostAddress& from, quint16 port);
+    void parseDatagram(const char* dgram, int size);
+    FrameSlot* acquireSlot(SenderRing& ring, quint32 frameId, int chunkCnt);
+    void storeChunk(FrameSlot& fs, int idx, const char* payload, int len);
+    void storeParity(FrameSlot& fs, int group, int groupSize, const char* payload, int len);
+    void tryRecover(FrameSlot& fs, int group);
+    void deliver(const QString& sender, FrameSlot& fs);
+    void sendNack(quint32 senderSession, quint32 frameId, const QVector<quint16>& missing);
+    void noteLost(SenderRing& ring, int frames);
+    void sendFeedback(SenderRing& ring, quint8 flags, qint64 now);
+    void parseFeedback(const uchar* d, int size);
 
     static QByteArray buildRegister(const QString& roomId, const QString& user);
+    void sendChunks(const QByteArray& blob, quint8 codec, int w, int h, qint64 ts);
     static QByteArray buildVideoChunk(const QString& roomId, const QString& sender,
                                       quint32 frameId, quint16 idx, quint16 cnt,
                                       quint8 codec, int w, int h, qint64 ts,
                                       const char* payload, int len);
+    // UDM v3：只带会话 id 的紧凑分片
+    static QByteArray buildVideoChunkV3(quint32 session,
+                                        quint32 frameId, quint16 idx, quint16 cnt,
+                                        quint8 codec, int w, int h, qint64 ts,
+                                        const char* payload, int len,
+                                        quint8 type = UDM_CHUNK);
 
     QUdpSocket sock_;
     QHostAddress serverAddr_{QHostAddress::LocalHost};
@@ -54,7 +115,17 @@ private:
     QTimer heartbeat_;
     QTimer cleanup_;
     quint32 frameSeq_{0};
-    QHash<QString, Assembly> reassem_;
+    QHash<QString, SenderRing> rings_;  // 发送方 -> 重组环
+    QByteArray rxBuf_;                  // 接收缓冲，复用
+    // 中继在注册回执（UDM_ROSTER）中分配的会话 id；为 0 时按 v2 发送（兼容旧中继）
+    quint32 session_{0};
+    QHash<quint32, QString> roster_; // 会话 id -> 用户名
+    int fecGroup_{0};
+    quint64 fecRecovered_{0};
+    QTimer nackTimer_;
+    bool nackEnabled_{true};
+    quint64 nacksSent_{0};
+    enum { kNackDelayMs = 30, kNackWindowMs = 600, kMaxNackRounds = 2 };
+    enum { kKeyReqMinMs = 500 };
     enum { kChunkPayload = 1200 };
-    static constexpr quint32 kMagic = 0x55444D31;
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <QtWidgets>
+
+// 视频显示控件：替代 QLabel::setPixmap 的逐帧转换与缩放
+// - setFrame 只保存图像（隐式共享，不复制像素）并请求重绘，两次重绘之间到达的多帧自然合并为最后一帧
+// - paintEvent 才做缩放，结果按控件尺寸缓存；尺寸不变且无新帧时重绘直接贴缓存
+// - 无图像时退回 QLabel 显示提示文字（边框/背景样式不变）
+class VideoSurface : public QLabel {
+    Q_OBJECT
+public:
+    explicit VideoSurface(const QString& text, QWidget* parent = nullptr);
+
+    void setFrame(const QImage& img);
+    void showText(const QString& text);   // 清除图像并显示文字
+    bool hasFrame() const { return !frame_.isNull(); }
+    // 帧的目标尺寸（内容区），按此尺寸合成的图像绘制时无需再缩放
+    QSize frameTarget() const { return contentsRect().size(); }
+
+protected:
+    void paintEvent(QPaintEvent* e) override;
+
+private:
+    QImage  frame_;
+    QImage  scaled_;      // 当前帧按内容区等比缩放后的缓存（尺寸已匹配时与 frame_ 共享）
+    QSize   scaledFor_;   // 缓存对应的内容区尺寸
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <QtCore>
+#include <QtGui>
+
+class QVideoFrame;
+
+// 摄像头 YUV 帧转换（BT.601 有限范围）
+// - 任意支持格式先在 YUV 域缩小到目标尺寸并统一为 I420（缩小 2 倍及以上时做 2x2 盒式平均），
+//   再只对输出尺寸的像素做颜色转换，转换核心有 SSE2 实现
+// - I420 结果可直接交给 JpegCodec::encodeI420，免去 RGB 往返
+// 缓冲均由调用方持有并跨帧复用
+namespace YuvConvert {
+
+enum Format { Invalid, YUYV, UYVY, NV12, NV21, I420, YV12 };
+
+// 源帧描述：打包格式只用 planes[0]；NV12/NV21 用 planes[0..1]
+struct Frame {
+    Format fmt = Invalid;
+    int width = 0, height = 0;
+    const uchar* planes[3] = { nullptr, nullptr, nullptr };
+    int strides[3] = { 0, 0, 0 };
+};
+
+// I420 缓冲：Y | U | V 连续存放，尺寸为偶数
+struct Planar {
+    int width = 0, height = 0;
+    QByteArray data;
+
+    void resize(int w, int h);
+    uchar* plane(int i);
+    const uchar* plane(int i) const;
+    int stride(int i) const { return i == 0 ? width : width / 2; }
+};
+
+// 从已 map 的 QVideoFrame 取平面指针；格式不支持返回 false
+bool fromVideoFrame(const QVideoFrame& mapped, Frame& out);
+// I420 缓冲作为源帧（用于再次缩小）
+Frame frameOf(const Planar& p);
+
+// 等比放入 bound 且不放大，宽高取偶数
+QSize fitSize(const QSize& src, const QSize& bound);
+
+// 转换为 I420 并缩小到 dstSize（须为偶数且不大于源尺寸）
+bool scaleToI420(const Frame& src, const QSize& dstSize, Planar& out);
+
+// I420 -> RGB32，尺寸或格式不符或被共享时重建 dst
+bool i420ToRgb32(const Planar& src, QImage& dst);
+
+// scaleToI420 + i420ToRgb32
+bool toRgb32(const Frame& src, const QSize& dstSize, Planar& scratch, QImage& dst);
+
+// 单像素标量公式：SSE2 行核的尾部直接使用，整行结果与它的差异不超过 1（bench 的 yuv 项据此核对）
+inline QRgb yuvToRgb(int y, int u, int v)
+{
+    auto clip8 = [](int x) { return x < 0 ? 0 : (x > 255 ? 255 : x); };
+    const int c = 298 * (y - 16);
+    const int d = u - 128, e = v - 128;
+    return qRgb(clip8((c + 409 * e + 128) >> 8),
+                clip8((c - 100 * d - 208 * e + 128) >> 8),
+                clip8((c + 516 * d + 128) >> 8));
+}
+
+} // namespace YuvConvert
@@ -153,7 +153,20 @@ void AudioChat::onMicReadyRead() {
             ulaw[i] = static_cast<char>(linearToUlaw(s[i]));
         }
 
-        // 组包并发送
+        if (!conn_) continue;
+
+        // v2：紧凑二进制头，无 JSON
+        if (conn_->mediaV2() && conn_->localStreamId() != 0) {
+            MediaHeader h;
+            h.streamId = conn_->localStreamId();
+            h.codec    = CODEC_MULAW;
+            h.seq      = seq_++;
+            h.ts       = quint32(QDateTime::currentMSecsSinceEpoch());
+            conn_->sendMedia(MSG_AUDIO_FRAME_V2, h, ulaw);
+            continue;
+        }
+
+        // v1：组包并发送
         QJsonObject j{
             {"roomId", roomId_},
             {"sender", sender_},
@@ -163,7 +176,7 @@ void AudioChat::onMicReadyRead() {
             {"seq",    static_cast<int>(seq_++)},
             {"ts",     QDateTime::currentMSecsSinceEpoch()}
         };
-        if (conn_) conn_->send(MSG_AUDIO_FRAME, j, ulaw);
+        conn_->send(MSG_AUDIO_FRAME, j, ulaw);
     }
 }
 
@@ -176,6 +189,18 @@ void AudioChat::shrinkQueueIfNeeded(QByteArray& q) {
 
 // 接收并播放
 void AudioChat::onPacket(Packet p) {
+    if (p.type == MSG_AUDIO_FRAME_V2) {
+        // v2：发送者由 streamId 映射得到（服务器只在房间内转发，无需校验 roomId）
+        MediaHeader h; int off = 0;
+        if (!conn_ || !parseMediaHeader(p.type, p.bin, h, off)) return;
+        const QString sender = conn_->senderOfStream(h.streamId);
+        if (sender.isEmpty()) return;
+        if (!sender_.isEmpty() && sender == sender_) return;
+        const QByteArray payload = QByteArray::fromRawData(p.bin.constData() + off, p.bin.size() - off);
+        if (h.codec == CODEC_MULAW)      enqueuePeer(sender, payload, true);
+        else if (h.codec == CODEC_PCM16) enqueuePeer(sender, payload, false);
+        return;
+    }
     if (p.type != MSG_AUDIO_FRAME) return;
 
     const QString roomId = p.json.value("roomId").toString();
@@ -191,19 +216,22 @@ void AudioChat::onPacket(Packet p) {
         return;
     }
 
+    if (codec == "mulaw")      enqueuePeer(sender, p.bin, true);
+    else if (codec == "pcm16") enqueuePeer(sender, p.bin, false);
+}
+
+void AudioChat::enqueuePeer(const QString& sender, const QByteArray& payload, bool mulaw) {
+    const int n = payload.size();
+    if (n <= 0) return;
     QByteArray& q = rxQueues_[sender];
-    if (codec == "mulaw") {
-        const int n = p.bin.size();
-        if (n <= 0) return;
-        const uchar* u = reinterpret_cast<const uchar*>(p.bin.constData());
-        QByteArray pcm; pcm.resize(n * 2);
-        qint16* d = reinterpret_cast<qint16*>(pcm.data());
+    if (mulaw) {
+        const uchar* u = reinterpret_cast<const uchar*>(payload.constData());
+        const int old = q.size();
+        q.resize(old + n * 2);
+        qint16* d = reinterpret_cast<qint16*>(q.data() + old);
         for (int i = 0; i < n; ++i) d[i] = ulawToLinear(u[i]);
-        q.append(pcm);
-    } else if (codec == "pcm16") {
-        q.append(p.bin);
     } else {
-        return;
+        q.append(payload);
     }
     shrinkQueueIfNeeded(q);
 }
@@ -0,0 +1,230 @@
+#include "blockdiff.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BD_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+// AVX2 以函数级 target 属性编译，运行时探测后才会调用（仅 GCC/Clang）
+#if defined(BD_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define BD_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+using RowEqualFn = bool (*)(const uchar*, const uchar*, int);
+
+#ifndef BD_HAVE_SSE2
+bool rowEqualScalar(const uchar* a, const uchar* b, int n)
+{
+    return memcmp(a, b, size_t(n)) == 0;
+}
+#else
+bool rowEqualSse2(const uchar* a, const uchar* b, int n)
+{
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16));
+        const __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16));
+        const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(x0, y0), _mm_cmpeq_epi8(x1, y1));
+        if (_mm_movemask_epi8(eq) != 0xFFFF) return false;
+    }
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) return false;
+    }
+    return memcmp(a + i, b + i, size_t(n - i)) == 0;
+}
+#endif
+
+#ifdef BD_HAVE_AVX2
+__attribute__((target("avx2")))
+bool rowEqualAvx2(const uchar* a, const uchar* b, int n)
+{
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+        const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+        const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(x0, y0), _mm256_cmpeq_epi8(x1, y1));
+        if (_mm256_movemask_epi8(eq) != -1) return false;
+    }
+    for (; i + 32 <= n; i += 32) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1) return false;
+    }
+    return rowEqualSse2(a + i, b + i, n - i);
+}
+#endif
+
+struct Isa {
+    RowEqualFn  rowEqual;
+    const char* name;
+};
+
+Isa pickIsa()
+{
+#ifdef BD_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return { rowEqualAvx2, "avx2" };
+#endif
+#ifdef BD_HAVE_SSE2
+    return { rowEqualSse2, "sse2" };
+#else
+    return { rowEqualScalar, "scalar" };
+#endif
+}
+
+const Isa& isa()
+{
+    static const Isa s = pickIsa();
+    return s;
+}
+
+// 64 位片段哈希：8 字节一组乘法混合，尾部逐字节
+inline quint64 mixSegment(quint64 h, const uchar* p, int n)
+{
+    const quint64 k = 0x9E3779B97F4A7C15ull;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 v;
+        memcpy(&v, p + i, 8);
+        h = (h ^ v) * k;
+        h ^= h >> 29;
+    }
+    for (; i < n; ++i) h = (h ^ p[i]) * k;
+    return h;
+}
+} // namespace
+
+const char* BlockDiff::isaName()
+{
+    return isa().name;
+}
+
+int BlockDiff::detect(const QImage& prev, const QImage& curr, int block, QVector<quint8>& dirty)
+{
+    return mode_ == Hash ? detectHash(curr, block, dirty)
+                         : detectCompare(prev, curr, block, dirty);
+}
+
+int BlockDiff::detectCompare(const QImage& prev, const QImage& curr, int block, QVector<quint8>& dirty)
+{
+    const int W = curr.width(), H = curr.height();
+    const int bs = qMax(8, block);
+    const int bx = (W + bs - 1) / bs;
+    const int by = (H + bs - 1) / bs;
+
+    if (prev.size() != curr.size() || prev.depth() != 32 || curr.depth() != 32) {
+        dirty.fill(1, bx * by);
+        return bx * by;
+    }
+    dirty.fill(0, bx * by);
+
+    const RowEqualFn eq = isa().rowEqual;
+    int count = 0;
+    for (int y = 0; y < H; ++y) {
+        const uchar* p0 = prev.constScanLine(y);
+        const uchar* p1 = curr.constScanLine(y);
+        // 整行未变（静态画面的常见情况）一次比较即可跳过
+        if (eq(p0, p1, W * 4)) continue;
+
+        quint8* row = dirty.data() + (y / bs) * bx;
+        for (int gx = 0; gx < bx; ++gx) {
+            if (row[gx]) continue;
+            const int x = gx * bs;
+            const int w = qMin(bs, W - x);
+            if (!eq(p0 + x * 4, p1 + x * 4, w * 4)) {
+                row[gx] = 1;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+int BlockDiff::detectAgainst(const QImage& ref, const QImage& curr, int block, QVector<quint8>& dirty)
+{
+    const int count = detectCompare(ref, curr, block, dirty);
+    if (mode_ == Hash) {
+        // 哈希缓存仍以本帧为新参考，下一帧照常只读当前帧
+        hashBlocks(curr, qMax(8, block), hashes_);
+        hashSize_ = curr.size();
+        hashBlock_ = qMax(8, block);
+    }
+    return count;
+}
+
+void BlockDiff::stripHashes(const QImage& img, int bs, QVector<quint64>& out)
+{
+    const int W = img.width(), H = img.height();
+    const int bx = (W + bs - 1) / bs;
+    out.resize(bx * H);
+    for (int y = 0; y < H; ++y) {
+        const uchar* p = img.constScanLine(y);
+        for (int gx = 0; gx < bx; ++gx) {
+            const int x = gx * bs;
+            out[gx * H + y] = mixSegment(0xCBF29CE484222325ull, p + x * 4, qMin(bs, W - x) * 4);
+        }
+    }
+}
+
+void BlockDiff::bandHashes(const QImage& img, int bs, QVector<quint64>& out)
+{
+    const int W = img.width(), H = img.height();
+    const int by = (H + bs - 1) / bs;
+    const quint64 k = 0x9E3779B97F4A7C15ull;
+    out.fill(0xCBF29CE484222325ull, by * W);
+    for (int y = 0; y < H; ++y) {
+        const quint32* p = reinterpret_cast<const quint32*>(img.constScanLine(y));
+        quint64* h = out.data() + (y / bs) * W;
+        for (int x = 0; x < W; ++x) {
+            quint64 v = (h[x] ^ p[x]) * k;
+            h[x] = v ^ (v >> 29);
+        }
+    }
+}
+
+void BlockDiff::hashBlocks(const QImage& curr, int bs, QVector<quint64>& out)
+{
+    const int W = curr.width(), H = curr.height();
+    const int bx = (W + bs - 1) / bs;
+    const int by = (H + bs - 1) / bs;
+    out.fill(0, bx * by);
+    for (int y = 0; y < H; ++y) {
+        const uchar* p = curr.constScanLine(y);
+        quint64* hrow = out.data() + (y / bs) * bx;
+        for (int gx = 0; gx < bx; ++gx) {
+            const int x = gx * bs;
+            hrow[gx] = mixSegment(hrow[gx], p + x * 4, qMin(bs, W - x) * 4);
+        }
+    }
+}
+
+int BlockDiff::detectHash(const QImage& curr, int block, QVector<quint8>& dirty)
+{
+    const int bs = qMax(8, block);
+    const int n = ((curr.width() + bs - 1) / bs) * ((curr.height() + bs - 1) / bs);
+
+    const bool valid = hashes_.size() == n && hashSize_ == curr.size() &&
+                       hashBlock_ == bs && curr.depth() == 32;
+
+    hashBlocks(curr, bs, scratch_);
+
+    dirty.resize(n);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        const bool d = !valid || scratch_[i] != hashes_[i];
+        dirty[i] = d ? 1 : 0;
+        count += d;
+    }
+    // 当前帧成为新参考
+    hashes_.swap(scratch_);
+    hashSize_ = curr.size();
+    hashBlock_ = bs;
+    return count;
+}
@@ -0,0 +1,208 @@
+#include "camerapipeline.h"
+#include "protocol.h"
+
+CameraPipeline::CameraPipeline()
+    : statsTimer_(this)   // 随本对象移入管线线程
+{
+    clock_.start();
+    statsTimer_.setInterval(5000);
+    connect(&statsTimer_, &QTimer::timeout, this, &CameraPipeline::onStatsTimer);
+}
+
+void CameraPipeline::submit(const QVideoFrame& frame)
+{
+    if (!pending_.testAndSetAcquire(0, 1)) {
+        dropBusy_.fetchAndAddRelaxed(1);
+        return;
+    }
+    QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection,
+                              Q_ARG(QVideoFrame, frame), Q_ARG(qint64, nowUs()));
+}
+
+void CameraPipeline::setIdentity(QString roomId, QString sender, bool mediaV2, quint16 streamId)
+{
+    roomId_ = roomId;
+    sender_ = sender;
+    mediaV2_ = mediaV2;
+    streamId_ = streamId;
+}
+
+void CameraPipeline::setParams(QSize sendSize, int fps, int quality)
+{
+    sendSize_ = sendSize;
+    targetFps_ = fps;
+    quality_ = quality;
+}
+
+void CameraPipeline::setPreviewBound(QSize bound)
+{
+    previewBound_ = bound;
+}
+
+void CameraPipeline::process(QVideoFrame frame, qint64 submitUs)
+{
+    if (!statsTimer_.isActive()) {
+        statsClock_.start();
+        statsTimer_.start();
+    }
+    const qint64 t0 = nowUs();
+    wait_.add(t0 - submitUs);
+    ++frames_;
+
+    // 限流在 map 之前：被丢弃的帧不产生任何拷贝或转换
+    const qint64 intervalMs = 1000 / qMax(1, targetFps_);
+    if (lastSend_.isValid() && lastSend_.elapsed() < intervalMs) {
+        ++dropRate_;
+        pending_.storeRelease(0);
+        return;
+    }
+    if (!frame.map(QAbstractVideoBuffer::ReadOnly)) {
+        pending_.storeRelease(0);
+        return;
+    }
+    lastSend_.restart();
+    if (frame.pixelFormat() != lastFormat_) {
+        lastFormat_ = frame.pixelFormat();
+        emit formatChanged(int(lastFormat_));
+    }
+
+    // 1) 转换：缩小到发送尺寸（YUV 得 I420，RGB 得 RGB 图像）
+    qint64 t = t0;
+    YuvConvert::Frame yuv;
+    const bool isYuv = YuvConvert::fromVideoFrame(frame, yuv);
+    QSize srcSz, sendSz;
+    QImage view, rgb;
+    bool ok = false;
+    if (isYuv) {
+        srcSz = QSize(yuv.width, yuv.height);
+        sendSz = YuvConvert::fitSize(srcSz, sendSize_);
+        ok = YuvConvert::scaleToI420(yuv, sendSz, planar_);
+    } else {
+        const QImage::Format imf = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+        if (imf != QImage::Format_Invalid) {
+            // scaled 生成新图像，不需要先整帧复制
+            view = QImage(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine(), imf);
+            srcSz = view.size();
+            rgb = view.scaled(sendSize_, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            sendSz = rgb.size();
+            ok = !rgb.isNull();
+        }
+    }
+    const qint64 convertUs = nowUs() - t;
+
+    // 2) 预览：只按显示尺寸生成 RGB；显示区域大于发送尺寸时在 unmap 前直接由源帧缩放，
+    //    不把发送帧放大（预览尺寸不超过源帧）
+    t = nowUs();
+    QImage preview;
+    const QSize previewSz = previewBound_.isEmpty() ? sendSz : YuvConvert::fitSize(srcSz, previewBound_);
+    const bool fromSource = ok && previewSz.width() > sendSz.width();
+    if (fromSource) {
+        if (isYuv) YuvConvert::toRgb32(yuv, previewSz, previewPlanar_, preview);
+        else preview = view.scaled(previewSz, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    const qint64 sourcePreviewUs = nowUs() - t;
+    view = QImage();   // 引用映射内存，unmap 前释放
+    frame.unmap();
+    if (!ok) {
+        pending_.storeRelease(0);
+        return;
+    }
+    convert_.add(convertUs);
+
+    t = nowUs();
+    if (!fromSource) {
+        if (isYuv) {
+            if (previewSz == sendSz) YuvConvert::i420ToRgb32(planar_, preview);
+            else YuvConvert::toRgb32(YuvConvert::frameOf(planar_), previewSz, previewPlanar_, preview);
+        } else {
+            preview = previewSz == sendSz ? rgb : rgb.scaled(previewSz, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+    preview_.add(sourcePreviewUs + nowUs() - t);
+    emit previewReady(preview);
+
+    // 3) 压缩
+    t = nowUs();
+    if (isYuv) {
+        const uchar* planes[3] = { planar_.plane(0), planar_.plane(1), planar_.plane(2) };
+        const int strides[3] = { planar_.stride(0), planar_.stride(1), planar_.stride(2) };
+        ok = jpeg_.encodeI420(planes, strides, planar_.width, planar_.height, quality_, jpegBuf_);
+    } else {
+        ok = jpeg_.encode(rgb, quality_, jpegBuf_);
+    }
+    encode_.add(nowUs() - t);
+    if (!ok) {
+        ++failed_;
+        pending_.storeRelease(0);
+        return;
+    }
+
+    // 4) 打包为整帧
+    t = nowUs();
+    const QByteArray pkt = pack(sendSz);
+    pack_.add(nowUs() - t);
+    bytes_ += pkt.size();
+    total_.add(nowUs() - t0);
+
+    pending_.storeRelease(0);
+    emit packetReady(pkt);
+}
+
+QByteArray CameraPipeline::pack(const QSize& size)
+{
+    if (mediaV2_ && streamId_ != 0) {
+        MediaHeader h;
+        h.streamId = streamId_;
+        h.codec    = CODEC_JPEG;
+        h.flags    = kMediaFlagKey; // 每帧 JPEG 都可独立解码
+        h.seq      = seq_++;
+        h.ts       = quint32(QDateTime::currentMSecsSinceEpoch());
+        h.w        = quint16(size.width());
+        h.h        = quint16(size.height());
+        return buildMediaPacket(MSG_VIDEO_FRAME_V2, h, jpegBuf_);
+    }
+    QJsonObject j{{"roomId", roomId_},
+                  {"sender", sender_},
+                  {"media",  "camera"},
+                  {"w", size.width()},
+                  {"h", size.height()},
+                  {"ts", QDateTime::currentMSecsSinceEpoch()}};
+    return buildPacket(MSG_VIDEO_FRAME, j, jpegBuf_);
+}
+
+void CameraPipeline::onStatsTimer()
+{
+    const qint64 windowMs = qMax<qint64>(1, statsClock_.restart());
+    const int dropBusy = dropBusy_.fetchAndStoreRelaxed(0);
+    if (frames_ == 0 && dropBusy == 0) return;   // 摄像头已关闭
+    // 各阶段按实际经过该阶段的帧数平均；wait 为 submit 到管线线程开始处理的排队时间
+    const QJsonObject j{
+        {"frames",     frames_},
+        {"sent",       total_.n},
+        {"dropRate",   dropRate_},
+        {"dropBusy",   dropBusy},
+        {"failed",     failed_},
+        {"waitMs",     wait_.avgMs()},
+        {"convertMs",  convert_.avgMs()},
+        {"previewMs",  preview_.avgMs()},
+        {"encodeMs",   encode_.avgMs()},
+        {"packMs",     pack_.avgMs()},
+        {"totalMs",    total_.avgMs()},
+        {"maxTotalMs", total_.maxUs / 1000.0},
+        {"fps",        total_.n * 1000.0 / windowMs},
+        {"kbps",       bytes_ * 8.0 / windowMs}
+    };
+    wait_ = convert_ = preview_ = encode_ = pack_ = total_ = Stage();
+    frames_ = dropRate_ = failed_ = 0;
+    bytes_ = 0;
+
+    qInfo().noquote() << QString("[CAMERA] wait=%1ms conv=%2ms preview=%3ms enc=%4ms pack=%5ms "
+                                 "total=%6ms(max %7) fps=%8 kbps=%9 drop=%10/%11 fail=%12")
+                         .arg(j["waitMs"].toDouble(), 0, 'f', 1).arg(j["convertMs"].toDouble(), 0, 'f', 1)
+                         .arg(j["previewMs"].toDouble(), 0, 'f', 1).arg(j["encodeMs"].toDouble(), 0, 'f', 1)
+                         .arg(j["packMs"].toDouble(), 0, 'f', 2).arg(j["totalMs"].toDouble(), 0, 'f', 1)
+                         .arg(j["maxTotalMs"].toDouble(), 0, 'f', 1).arg(j["fps"].toDouble(), 0, 'f', 1)
+                         .arg(j["kbps"].toDouble(), 0, 'f', 0).arg(j["dropRate"].toInt())
+                         .arg(dropBusy).arg(j["failed"].toInt());
+    emit statsUpdated(j);
+}
@@ -22,14 +22,52 @@ void ClientConn::send(quint16 type, const QJsonObject& json, const QByteArray& b
     }
 }
 
+void ClientConn::sendMedia(quint16 type, const MediaHeader& h, const QByteArray& payload) {
+    if (sock_.state() == QAbstractSocket::ConnectedState) {
+        sock_.write(buildMediaPacket(type, h, payload));
+    }
+}
+
+void ClientConn::sendRaw(const QByteArray& frame) {
+    if (sock_.state() == QAbstractSocket::ConnectedState) {
+        sock_.write(frame);
+    }
+}
+
 void ClientConn::onConnected()    { emit connected(); }
-void ClientConn::onDisconnected() { emit disconnected(); }
+void ClientConn::onDisconnected() {
+    mediaV2_ = false;
+    localStreamId_ = 0;
+    streamSenders_.clear();
+    emit disconnected();
+}
+
+// 从加入确认/房间事件中记录 v2 协商结果与 streamId -> user 映射
+void ClientConn::trackStreams(const Packet& p) {
+    if (p.type != MSG_SERVER_EVENT || p.json.value("code").toInt(-1) != 0) return;
+    if (p.json.contains("streamId") && p.json.value("message").toString() == QLatin1String("joined")) {
+        mediaV2_ = p.json.value("proto").toInt(1) >= 2;
+        localStreamId_ = quint16(p.json.value("streamId").toInt());
+    }
+    if (p.json.value("kind").toString() == QLatin1String("room") && p.json.contains("streams")) {
+        streamSenders_.clear();
+        const QJsonObject streams = p.json.value("streams").toObject();
+        for (auto it = streams.begin(); it != streams.end(); ++it) {
+            streamSenders_.insert(quint16(it.value().toInt()), it.key());
+        }
+    }
+}
 
 void ClientConn::onReadyRead() {
     buf_.append(sock_.readAll());
-    QVector<Packet> pkts;
-    if (drainPackets(buf_, pkts)) {
-        for (auto& p : pkts) emit packetArrived(p);
+    QVector<PacketView> pkts;
+    if (drainPacketViews(buf_, pkts)) {
+        // 对外信号需长期持有数据，这里只做一次 bin 拷贝
+        for (const auto& v : pkts) {
+            Packet p = v.toPacket();
+            trackStreams(p);
+            emit packetArrived(p);
+        }
     }
 }
 
@@ -0,0 +1,192 @@
+#include "jpegcodec.h"
+
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+// 输出缓冲复用：reserve 标记保留容量，resize(0) 后不释放
+inline void prepareOut(QByteArray& out, int hint)
+{
+    if (out.capacity() < hint) out.reserve(hint);
+    out.resize(0);
+}
+
+// 目标被别处共享（如仍在显示）时直接换新缓冲，避免写入前把旧内容整帧复制一遍
+inline bool ensureImage(QImage& dst, const QSize& size)
+{
+    if (dst.size() != size || dst.format() != QImage::Format_RGB32 || !dst.isDetached())
+        dst = QImage(size, QImage::Format_RGB32);
+    return !dst.isNull();
+}
+
+// 仅回退路径使用：BT.601 有限范围 I420 -> RGB32
+void i420ToRgb32(const uchar* const planes[3], const int strides[3], int w, int h, QImage& dst)
+{
+    for (int y = 0; y < h; ++y) {
+        const uchar* py = planes[0] + y * strides[0];
+        const uchar* pu = planes[1] + (y / 2) * strides[1];
+        const uchar* pv = planes[2] + (y / 2) * strides[2];
+        QRgb* out = reinterpret_cast<QRgb*>(dst.scanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const int c = 298 * (py[x] - 16);
+            const int d = pu[x / 2] - 128;
+            const int e = pv[x / 2] - 128;
+            out[x] = qRgb(qBound(0, (c + 409 * e + 128) >> 8, 255),
+                          qBound(0, (c - 100 * d - 208 * e + 128) >> 8, 255),
+                          qBound(0, (c + 516 * d + 128) >> 8, 255));
+        }
+    }
+}
+} // namespace
+
+JpegCodec::JpegCodec()
+{
+#ifdef HAVE_TURBOJPEG
+    enc_ = tjInitCompress();
+    dec_ = tjInitDecompress();
+#endif
+}
+
+JpegCodec::~JpegCodec()
+{
+#ifdef HAVE_TURBOJPEG
+    if (enc_) tjDestroy(enc_);
+    if (dec_) tjDestroy(dec_);
+#endif
+}
+
+JpegCodec& JpegCodec::forThread()
+{
+    static QThreadStorage<JpegCodec*> storage;
+    if (!storage.hasLocalData()) storage.setLocalData(new JpegCodec);
+    return *storage.localData();
+}
+
+const char* JpegCodec::backend()
+{
+#ifdef HAVE_TURBOJPEG
+    return "turbojpeg";
+#else
+    return "qt";
+#endif
+}
+
+QSize JpegCodec::scaledSize(const QSize& full, const QSize& fitWithin)
+{
+    if (!fitWithin.isValid() || fitWithin.isEmpty()) return full;
+    // 1/d 不小于等比缩放比例 min(fw/w, fh/h)，即 d*fw <= w 或 d*fh <= h
+    for (int d = 8; d >= 2; d /= 2) {
+        if (d * fitWithin.width() <= full.width() || d * fitWithin.height() <= full.height())
+            return QSize((full.width() + d - 1) / d, (full.height() + d - 1) / d);
+    }
+    return full;
+}
+
+bool JpegCodec::encode(const QImage& img, int quality, QByteArray& out)
+{
+    if (img.isNull()) return false;
+    const QImage* src = &img;
+    if (img.format() != QImage::Format_RGB32 && img.format() != QImage::Format_ARGB32) {
+        convBuf_ = img.convertToFormat(QImage::Format_RGB32);
+        src = &convBuf_;
+    }
+#ifdef HAVE_TURBOJPEG
+    if (enc_) {
+        const int cap = int(tjBufSize(src->width(), src->height(), TJSAMP_420));
+        prepareOut(out, cap);
+        out.resize(cap);
+        unsigned char* buf = reinterpret_cast<unsigned char*>(out.data());
+        unsigned long size = 0;
+        // RGB32 内存序为 B,G,R,X（小端），按 BGRX 直接压缩
+        if (tjCompress2(enc_, const_cast<unsigned char*>(src->constBits()), src->width(), src->bytesPerLine(),
+                        src->height(), TJPF_BGRX, &buf, &size, TJSAMP_420, quality, TJFLAG_NOREALLOC) != 0) {
+            out.resize(0);
+            return false;
+        }
+        out.resize(int(size));
+        return true;
+    }
+#endif
+    prepareOut(out, src->width() * src->height() / 4);
+    QBuffer buf(&out);
+    buf.open(QIODevice::WriteOnly);
+    QImageWriter w(&buf, "jpeg");
+    w.setQuality(quality);
+    w.setOptimizedWrite(true);
+    return w.write(*src);
+}
+
+bool JpegCodec::encodeI420(const uchar* const planes[3], const int strides[3], int w, int h,
+                           int quality, QByteArray& out)
+{
+    if (w <= 0 || h <= 0) return false;
+#ifdef HAVE_TURBOJPEG
+    if (enc_) {
+        const int cap = int(tjBufSize(w, h, TJSAMP_420));
+        prepareOut(out, cap);
+        out.resize(cap);
+        unsigned char* buf = reinterpret_cast<unsigned char*>(out.data());
+        unsigned long size = 0;
+        const unsigned char* src[3] = { planes[0], planes[1], planes[2] };
+        if (tjCompressFromYUVPlanes(enc_, src, w, strides, h, TJSAMP_420, &buf, &size,
+                                    quality, TJFLAG_NOREALLOC) != 0) {
+            out.resize(0);
+            return false;
+        }
+        out.resize(int(size));
+        return true;
+    }
+#endif
+    if (!ensureImage(convBuf_, QSize(w, h))) return false;
+    i420ToRgb32(planes, strides, w, h, convBuf_);
+    return encode(convBuf_, quality, out);
+}
+
+QSize JpegCodec::imageSize(const char* data, int len)
+{
+    if (!data || len <= 0) return QSize();
+#ifdef HAVE_TURBOJPEG
+    if (dec_) {
+        int w = 0, h = 0, subsamp = 0, cs = 0;
+        unsigned char* src = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data));
+        if (tjDecompressHeader3(dec_, src, (unsigned long)len,
+                                &w, &h, &subsamp, &cs) != 0)
+            return QSize();
+        return QSize(w, h);
+    }
+#endif
+    QByteArray view = QByteArray::fromRawData(data, len);
+    QBuffer buf(&view);
+    buf.open(QIODevice::ReadOnly);
+    return QImageReader(&buf, "jpeg").size();
+}
+
+bool JpegCodec::decode(const char* data, int len, QImage& dst, const QSize& fitWithin)
+{
+    if (!data || len <= 0) return false;
+#ifdef HAVE_TURBOJPEG
+    if (dec_) {
+        // 旧版头文件的参数不带 const
+        unsigned char* src = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data));
+        int w = 0, h = 0, subsamp = 0, cs = 0;
+        if (tjDecompressHeader3(dec_, src, (unsigned long)len, &w, &h, &subsamp, &cs) != 0) return false;
+        const QSize sz = scaledSize(QSize(w, h), fitWithin);
+        if (!ensureImage(dst, sz)) return false;
+        return tjDecompress2(dec_, src, (unsigned long)len, dst.bits(),
+                             sz.width(), dst.bytesPerLine(), sz.height(), TJPF_BGRX, 0) == 0;
+    }
+#endif
+    QByteArray view = QByteArray::fromRawData(data, len);
+    QBuffer buf(&view);
+    buf.open(QIODevice::ReadOnly);
+    QImageReader reader(&buf, "jpeg");
+    const QSize full = reader.size();
+    if (!full.isValid()) return false;
+    const QSize sz = scaledSize(full, fitWithin);
+    if (sz != full) reader.setScaledSize(sz); // Qt 的 JPEG 插件同样走 DCT 缩放
+    // 尺寸与格式一致时 JPEG 插件直接写入 dst 的现有缓冲
+    if (!ensureImage(dst, sz) || !reader.read(&dst)) return false;
+    if (dst.format() != QImage::Format_RGB32) dst = dst.convertToFormat(QImage::Format_RGB32);
+    return true;
+}
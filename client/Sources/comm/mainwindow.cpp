@@ -10,8 +10,6 @@
 #include <QEvent>
 #include <QGridLayout>
 #include <QHBoxLayout>
-#include <QImageReader>
-#include <QImageWriter>
 #include <QInputDialog>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -41,17 +39,8 @@
 #include "volume_popup.h"
 #include "audiochat.h"
 #include "screenshare.h"
-
-// 将图像按控件尺寸等比例缩放后设置
-static void fitLabelImage(QLabel* lbl, const QImage& img) {
-    if (!lbl) return;
-    if (img.isNull()) { lbl->clear(); return; }
-    const QSize s = lbl->size();
-    if (s.width() < 2 || s.height() < 2) return;
-    QPixmap pm = QPixmap::fromImage(img).scaled(s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    lbl->setPixmap(pm);
-    lbl->setText(QString());
-}
+#include "jpegcodec.h"
+#include "videosurface.h"
 
 static VideoTile* makeTile(QWidget* parent, const QString& nameText) {
     auto* box = new QWidget(parent);
@@ -63,7 +52,7 @@ static VideoTile* makeTile(QWidget* parent, const QString& nameText) {
     name->setAlignment(Qt::AlignCenter);
     name->setStyleSheet("font-weight:bold;");
 
-    auto* video = new QLabel(QStringLiteral("等待视频/屏幕..."), box);
+    auto* video = new VideoSurface(QStringLiteral("等待视频/屏幕..."), box);
     video->setMinimumSize(200,150);
     video->setStyleSheet("border:1px solid #888;");
     video->setAlignment(Qt::AlignCenter);
@@ -92,67 +81,14 @@ static VideoTile* makeTile(QWidget* parent, const QString& nameText) {
     return t;
 }
 
-// 合成图（含 PiP）
-QImage MainWindow::composeTileImage(const VideoTile* t, const QSize& target)
+// 远端摄像头解码目标尺寸：只有聚焦的主画面解全尺寸，其余按窗口（或画中画小窗）尺寸做 DCT 缩放解码
+QSize MainWindow::remoteCamDecodeSize(const VideoTile* t) const
 {
-    if (!t || !target.isValid() || target.width()<2 || target.height()<2) return QImage();
-
-    const bool hasCam    = !t->lastCam.isNull();
-    const bool hasScreen = !t->lastScreen.isNull();
-
-    QImage bg(target, QImage::Format_RGB32);
-    bg.fill(Qt::black);
-
-    QPainter p(&bg);
-    p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform, true);
-
-    auto drawFit = [&](const QImage& img, const QRect& rect){
-        if (img.isNull() || rect.isEmpty()) return;
-        QSize fitted = img.size();
-        fitted.scale(rect.size(), Qt::KeepAspectRatio);
-        QPoint topLeft(rect.x() + (rect.width()-fitted.width())/2,
-                       rect.y() + (rect.height()-fitted.height())/2);
-        p.drawImage(QRect(topLeft, fitted), img);
-    };
-
-    if (!hasCam && !hasScreen) {
-        p.end();
-        return QImage();
-    }
-    if (hasCam && !hasScreen) {
-        drawFit(t->lastCam, QRect(QPoint(0,0), target));
-        p.end();
-        return bg;
-    }
-    if (!hasCam && hasScreen) {
-        drawFit(t->lastScreen, QRect(QPoint(0,0), target));
-        p.end();
-        return bg;
-    }
-
-    // 两路都有：PiP
-    const QImage& bigImg   = t->camPrimary ? t->lastCam : t->lastScreen;
-    const QImage& smallImg = t->camPrimary ? t->lastScreen : t->lastCam;
-
-    drawFit(bigImg, QRect(QPoint(0,0), target));
-
-    const int margin = 8;
-    int smallW = qMax(80, target.width() * 28 / 100);
-    int smallH = smallW * smallImg.height() / qMax(1, smallImg.width());
-    if (smallH > target.height() * 40 / 100) {
-        smallH = target.height() * 40 / 100;
-        smallW = smallH * smallImg.width() / qMax(1, smallImg.height());
-    }
-    QRect smallRect(target.width() - margin - smallW, margin, smallW, smallH);
-
-    QColor panel(0,0,0,160);
-    p.fillRect(smallRect.adjusted(-2,-2,2,2), panel);
-    p.setPen(QPen(Qt::white, 2));
-    p.drawRect(smallRect);
-    drawFit(smallImg, smallRect);
-
-    p.end();
-    return bg;
+    if (mainKey_ == t->key && currentMode() == ViewMode::Focus) return QSize();
+    const QSize s = t->video->frameTarget();
+    if (!t->lastScreen.isNull() && !t->camPrimary)
+        return QSize(qMax(80, s.width() * 28 / 100), s.height() * 40 / 100); // 同 TileCompositor 小窗
+    return s;
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -214,7 +150,7 @@ MainWindow::MainWindow(QWidget *parent)
     mainLay->setContentsMargins(2,2,2,2);
     mainLay->setSpacing(4);
 
-    mainVideo_ = new QLabel(QStringLiteral("点击右侧任意画面设为主画面"), mainArea_);
+    mainVideo_ = new VideoSurface(QStringLiteral("点击右侧任意画面设为主画面"), mainArea_);
     mainVideo_->setAlignment(Qt::AlignCenter);
     mainVideo_->setStyleSheet("border:1px solid #444; background:#111; color:#ccc;");
     mainVideo_->setMinimumSize(400, 300);
@@ -348,71 +284,61 @@ MainWindow::MainWindow(QWidget *parent)
 
     bindVolumeButton(&localTile_, true);
 
-    // UDP 收帧（整帧 JPEG 屏幕）
+    // 远端视频：UDP 屏幕帧与 TCP 摄像头帧交给解码池，结果回到 GUI 线程显示
+    decoder_ = new RemoteDecoder(this);
     connect(udp_, &UdpMediaClient::udpScreenFrame, this,
         [this](const QString& sender, const QByteArray& jpeg, int /*w*/, int /*h*/, qint64){
             if (sender.isEmpty() || sender == edUser->text()) return;
-            VideoTile* t = ensureRemoteTile(sender);
-            QBuffer buf(const_cast<QByteArray*>(&jpeg));
-            buf.open(QIODevice::ReadOnly);
-            QImageReader reader(&buf, "jpeg");
-            reader.setAutoTransform(true);
-            QImage img = reader.read().convertToFormat(QImage::Format_RGB32);
-            if (!img.isNull()) {
-                screenBack_[sender] = img; // 同步背板
-                t->lastScreen = img;
-                kickRemoteAlive(t);
-                refreshTilePixmap(t);
-                if (mainKey_ == sender) updateMainFromTile(t);
-            }
+            ensureRemoteTile(sender);
+            decoder_->submitScreenKey(sender, jpeg);
         });
-
-    // UDP 收帧（增量 DELTA 屏幕）
     connect(udp_, &UdpMediaClient::udpScreenDeltaFrame, this,
         [this](const QString& sender, const QByteArray& blob, int w, int h, qint64){
             if (sender.isEmpty() || sender == edUser->text()) return;
-            VideoTile* t = ensureRemoteTile(sender);
-
-            // 准备/校正背板尺寸
-            QImage& back = screenBack_[sender];
-            if (back.isNull() || back.size() != QSize(w, h)) {
-                back = QImage(w, h, QImage::Format_RGB32);
-                back.fill(Qt::black);
-            }
-
-            // 解析 DS01
-            QDataStream ds(blob);
-            ds.setByteOrder(QDataStream::BigEndian);
-            quint32 magic=0; quint16 rectCount=0;
-            ds >> magic >> rectCount;
-            if (magic != 0x44533031) return; // 'DS01'
-
-            for (int i = 0; i < rectCount; ++i) {
-                quint16 x=0,y=0,rw=0,rh=0; quint32 clen=0;
-                ds >> x >> y >> rw >> rh >> clen;
-                if (ds.status()!=QDataStream::Ok) return;
-                if (int(ds.device()->bytesAvailable()) < int(clen)) return;
-                QByteArray comp; comp.resize(int(clen));
-                ds.readRawData(comp.data(), clen);
-                QByteArray raw = qUncompress(comp);
-                if (raw.size() != int(rw) * int(rh) * 4) continue;
-
-                // 写回到背板
-                const char* src = raw.constData();
-                for (int row = 0; row < rh; ++row) {
-                    uchar* dst = back.scanLine(y + row) + x * 4;
-                    memcpy(dst, src + row * rw * 4, rw * 4);
-                }
-            }
-
-            // 显示更新（把背板作为当前屏幕图像）
-            t->lastScreen = back;
-            kickRemoteAlive(t);
-            refreshTilePixmap(t);
-            if (mainKey_ == sender) updateMainFromTile(t);
+            ensureRemoteTile(sender);
+            decoder_->submitScreenDelta(sender, blob, QSize(w, h));
         });
+    connect(decoder_, &RemoteDecoder::screenReady, this,
+        [this](const QString& sender, const QImage& img, const QVector<QRect>& dirty){
+        VideoTile* t = remoteTiles_.value(sender, nullptr);
+        if (!t) return;
+        t->lastScreen = img;
+        t->thumbComp.markScreenDirty(dirty);   // 两个合成目标只重缩放改写区域
+        t->mainComp.markScreenDirty(dirty);
+        kickRemoteAlive(t);
+        refreshTilePixmap(t);
+        if (mainKey_ == sender) updateMainFromTile(t);
+    });
+    connect(decoder_, &RemoteDecoder::cameraReady, this, [this](const QString& sender, const QImage& img){
+        VideoTile* t = remoteTiles_.value(sender, nullptr);
+        if (!t) return;
+        t->lastCam = img;
+        kickRemoteAlive(t);
+        refreshTilePixmap(t);
+        if (mainKey_ == sender) updateMainFromTile(t);
+    });
+    // 背板缺失/增量解析失败/积压丢弃时请求关键帧（限频在 UdpMediaClient 内）
+    connect(decoder_, &RemoteDecoder::keyframeNeeded, this, [this](const QString& sender){
+        udp_->requestKeyframe(sender);
+    });
 
-    lastSend_.start();
+    qRegisterMetaType<QVideoFrame>("QVideoFrame");
+    camPipeline_ = new CameraPipeline;
+    camPipeline_->moveToThread(&camThread_);
+    connect(&camThread_, &QThread::finished, camPipeline_, &QObject::deleteLater);
+    // 关闭摄像头后管线里可能还剩一帧，到达时丢弃
+    connect(camPipeline_, &CameraPipeline::packetReady, this, [this](const QByteArray& frame){
+        if (camera_) conn_.sendRaw(frame);
+    });
+    connect(camPipeline_, &CameraPipeline::previewReady, this, [this](const QImage& img){
+        if (camera_) updateLocalPreview(img);
+    });
+    connect(camPipeline_, &CameraPipeline::formatChanged, this, [this](int fmt){
+        txtLog->append(QString("检测到视频帧像素格式: %1").arg(fmt));
+    });
+    connect(&conn_, &ClientConn::disconnected, this, &MainWindow::syncCameraIdentity);
+    camThread_.start();
+    syncCameraParams();
 
     // 初始设置一次共享画质参数（生效到 ScreenShare）
     applyShareQualityPreset();
@@ -563,6 +489,14 @@ bool MainWindow::eventFilter(QObject* watched, QEvent* event)
     return QMainWindow::eventFilter(watched, event);
 }
 
+MainWindow::~MainWindow()
+{
+    camThread_.quit();
+    camThread_.wait();
+    qDeleteAll(remoteTiles_);   // box 等控件随窗口释放
+    remoteTiles_.clear();
+}
+
 void MainWindow::resizeEvent(QResizeEvent* ev)
 {
     QMainWindow::resizeEvent(ev);
@@ -585,13 +519,14 @@ void MainWindow::onConnect()
 }
 void MainWindow::onJoin()
 {
-    QJsonObject j{{"roomId", edRoom->text()}, {"user", edUser->text()}};
+    QJsonObject j{{"roomId", edRoom->text()}, {"user", edUser->text()}, {"proto", kProtoVersion}};
     conn_.send(MSG_JOIN_WORKORDER, j);
     localTile_.name->setText(QString("我（%1）").arg(edUser->text()));
 
     audio_->setIdentity(edRoom->text(), edUser->text());
     share_->setIdentity(edRoom->text(), edUser->text());
     udp_->setIdentity(edRoom->text(), edUser->text());
+    syncCameraIdentity();
 
     // 再套一次画质（防止 join 前改过下拉框）
     applyShareQualityPreset();
@@ -656,6 +591,7 @@ void MainWindow::applyAdaptiveByMembers(int members)
                    .arg(members).arg(sendSize_.width()).arg(sendSize_.height())
                    .arg(targetFps_).arg(jpegQuality_));
 
+    syncCameraParams();
     if (camera_) configureCamera(camera_);
 
     // 共享屏幕改为使用用户预设，不再强行用摄像头自适应覆盖
@@ -674,6 +610,7 @@ void MainWindow::onPkt(Packet p)
                 if (audio_) audio_->setIdentity(roomId, me);
                 if (share_) share_->setIdentity(roomId, me);
                 if (udp_)   udp_->setIdentity(roomId, me);
+                syncCameraIdentity();   // 此时 v2 协商结果与 streamId 已就绪
 
                 // 不再直接调用 udp_->sendRegister()（其为私有）。
                 // setIdentity/ configureServer 会在就绪时自动注册。
@@ -729,8 +666,15 @@ void MainWindow::onPkt(Packet p)
     }
 
     // 3) 兜底：媒体/控制/标注到达即“按需创建”远端窗口（避免没有房间事件时看不到人）
-    if (p.type == MSG_VIDEO_FRAME || p.type == MSG_AUDIO_FRAME || p.type == MSG_CONTROL || p.type == MSG_ANNOT) {
-        const QString sender = p.json.value("sender").toString();
+    if (p.type == MSG_VIDEO_FRAME || p.type == MSG_AUDIO_FRAME || p.type == MSG_CONTROL || p.type == MSG_ANNOT
+        || isMediaV2(p.type)) {
+        QString sender;
+        if (isMediaV2(p.type)) {
+            MediaHeader h; int off = 0;
+            if (parseMediaHeader(p.type, p.bin, h, off)) sender = conn_.senderOfStream(h.streamId);
+        } else {
+            sender = p.json.value("sender").toString();
+        }
         if (!sender.isEmpty() && sender != me && !remoteTiles_.contains(sender)) {
             VideoTile* t = ensureRemoteTile(sender);
             setTileWaiting(t, QStringLiteral("等待对方视频/屏幕…"));
@@ -742,6 +686,26 @@ void MainWindow::onPkt(Packet p)
         // 注意：此处不要 return; 让后续原有处理能执行
     }
 
+    // 远端摄像头帧（v1 JSON + JPEG / v2 MediaHeader + JPEG）：按显示尺寸解码，免去全尺寸解码后再缩小
+    if (p.type == MSG_VIDEO_FRAME || p.type == MSG_VIDEO_FRAME_V2) {
+        QString sender;
+        QByteArray jpeg;
+        if (p.type == MSG_VIDEO_FRAME_V2) {
+            MediaHeader h; int off = 0;
+            if (!parseMediaHeader(p.type, p.bin, h, off) || h.codec != CODEC_JPEG) return;
+            sender = conn_.senderOfStream(h.streamId);
+            jpeg = p.bin.mid(off);
+        } else {
+            if (p.json.value("media").toString(QStringLiteral("camera")) != QLatin1String("camera")) return;
+            sender = p.json.value("sender").toString();
+            jpeg = p.bin;
+        }
+        if (sender.isEmpty() || sender == me) return;
+        VideoTile* t = ensureRemoteTile(sender);
+        decoder_->submitCamera(sender, jpeg, remoteCamDecodeSize(t));
+        return;
+    }
+
     // 4) 兼容老服务器文本广播（chat_broadcast），从文本判断加入/离开
     if (p.type == MSG_TEXT) {
         const QString action = p.json.value("action").toString();
@@ -877,14 +841,20 @@ void MainWindow::configureCamera(QCamera* cam)
     QList<QVideoFrame::PixelFormat> fmts =
         cam->supportedViewfinderPixelFormats(QCameraViewfinderSettings());
 
+    // 摄像头原生多为 YUV，优先直接取用（转换与缩小在本地完成），避免驱动模拟 RGB
     auto prefer = QList<QVideoFrame::PixelFormat>{
+        QVideoFrame::Format_NV12,
+        QVideoFrame::Format_YUV420P,
+        QVideoFrame::Format_YUYV,
+        QVideoFrame::Format_UYVY,
+        QVideoFrame::Format_NV21,
+        QVideoFrame::Format_YV12,
         QVideoFrame::Format_ARGB32,
         QVideoFrame::Format_ARGB32_Premultiplied,
         QVideoFrame::Format_RGB32,
         QVideoFrame::Format_RGB24,
         QVideoFrame::Format_BGR32,
-        QVideoFrame::Format_BGR24,
-        QVideoFrame::Format_YUYV
+        QVideoFrame::Format_BGR24
     };
 
     QVideoFrame::PixelFormat chosenFmt = QVideoFrame::Format_Invalid;
@@ -927,70 +897,6 @@ void MainWindow::hookCameraLogs(QCamera* cam)
 }
 
 /* ---------- 帧处理 ---------- */
-QImage MainWindow::makeImageFromFrame(const QVideoFrame &frame)
-{
-    if (!frame.isValid()) return QImage();
-
-    QVideoFrame clone(frame);
-    if (!clone.map(QAbstractVideoBuffer::ReadOnly)) {
-        return QImage();
-    }
-
-    const auto fmt = clone.pixelFormat();
-
-    if (fmt != lastLoggedFormat_) {
-        lastLoggedFormat_ = fmt;
-        txtLog->append(QString("检测到视频帧像素格式: %1").arg(fmt));
-    }
-
-    const QImage::Format imf = QVideoFrame::imageFormatFromPixelFormat(fmt);
-    if (imf != QImage::Format_Invalid) {
-        QImage img(clone.bits(), clone.width(), clone.height(), clone.bytesPerLine(), imf);
-        QImage copy = img.copy();
-        clone.unmap();
-        return copy;
-    }
-
-    if (fmt == QVideoFrame::Format_YUYV) {
-        const uchar *base = clone.bits();
-        const int width = clone.width();
-        const int height = clone.height();
-        const int stride = clone.bytesPerLine();
-
-        QImage out(width, height, QImage::Format_RGB32);
-        auto clip = [](int v){ return v < 0 ? 0 : (v > 255 ? 255 : v); };
-
-        for (int y = 0; y < height; ++y) {
-            const uchar* line = base + y * stride;
-            QRgb* dst = reinterpret_cast<QRgb*>(out.scanLine(y));
-            for (int x = 0; x < width; x += 2) {
-                const int i = x << 1;
-                int y0 = line[i + 0] - 16;
-                int u  = line[i + 1] - 128;
-                int y1 = line[i + 2] - 16;
-                int v  = line[i + 3] - 128;
-
-                int r0 = clip((298 * y0 + 409 * v + 128) >> 8);
-                int g0 = clip((298 * y0 - 100 * u - 208 * v + 128) >> 8);
-                int b0 = clip((298 * y0 + 516 * u + 128) >> 8);
-
-                int r1 = clip((298 * y1 + 409 * v + 128) >> 8);
-                int g1 = clip((298 * y1 - 100 * u - 208 * v + 128) >> 8);
-                int b1 = clip((298 * y1 + 516 * u + 128) >> 8);
-
-                dst[x]     = qRgb(r0, g0, b0);
-                if (x + 1 < width)
-                    dst[x + 1] = qRgb(r1, g1, b1);
-            }
-        }
-        clone.unmap();
-        return out;
-    }
-
-    clone.unmap();
-    return QImage();
-}
-
 void MainWindow::updateLocalPreview(const QImage& img)
 {
     if (img.isNull()) return;
@@ -1007,47 +913,37 @@ void MainWindow::onLocalScreenFrame(QImage img)
     if (mainKey_ == kLocalKey_) updateMainFromTile(&localTile_);
 }
 
-void MainWindow::sendImage(const QImage& img)
+// 本地预览只需显示尺寸（聚焦主画面时取主画面）
+QSize MainWindow::localPreviewBound() const
 {
-    if (img.isNull()) return;
+    if (mainKey_ == kLocalKey_ && currentMode() == ViewMode::Focus) return mainVideo_->frameTarget();
+    return localTile_.video->frameTarget();
+}
 
-    const qint64 intervalMs = 1000 / qMax(1, targetFps_);
-    if (lastSend_.isValid() && lastSend_.elapsed() < intervalMs)
-        return;
-    lastSend_.restart();
-
-    const QImage scaled = img.scaled(sendSize_, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    QByteArray jpeg;
-    QBuffer buffer(&jpeg);
-    buffer.open(QIODevice::WriteOnly);
-    QImageWriter writer(&buffer, "jpeg");
-    writer.setQuality(jpegQuality_);
-    writer.setOptimizedWrite(true);
-    if (!writer.write(scaled)) {
-        txtLog->append(QString("JPEG 写入失败: %1").arg(writer.errorString()));
-        return;
-    }
-    buffer.close();
+void MainWindow::syncCameraIdentity()
+{
+    QMetaObject::invokeMethod(camPipeline_, "setIdentity", Qt::QueuedConnection,
+                              Q_ARG(QString, edRoom->text()), Q_ARG(QString, edUser->text()),
+                              Q_ARG(bool, conn_.mediaV2()), Q_ARG(quint16, conn_.localStreamId()));
+}
 
-    QJsonObject j{{"roomId", edRoom->text()},
-                  {"sender", edUser->text()},
-                  {"media",  "camera"},
-                  {"w", scaled.width()},
-                  {"h", scaled.height()},
-                  {"ts", QDateTime::currentMSecsSinceEpoch()}};
-    conn_.send(MSG_VIDEO_FRAME, j, jpeg);
+void MainWindow::syncCameraParams()
+{
+    QMetaObject::invokeMethod(camPipeline_, "setParams", Qt::QueuedConnection,
+                              Q_ARG(QSize, sendSize_), Q_ARG(int, targetFps_), Q_ARG(int, jpegQuality_));
 }
 
+// GUI 线程只做入队：限流、转换、压缩、打包都在管线线程
 void MainWindow::onVideoFrame(const QVideoFrame &frame)
 {
     if (!camera_ || !frame.isValid()) return;
 
-    QImage img = makeImageFromFrame(frame);
-    if (img.isNull()) return;
-
-    updateLocalPreview(img);
-    sendImage(img);
+    const QSize bound = localPreviewBound();
+    if (bound != camPreviewBound_) {
+        camPreviewBound_ = bound;
+        QMetaObject::invokeMethod(camPipeline_, "setPreviewBound", Qt::QueuedConnection, Q_ARG(QSize, bound));
+    }
+    camPipeline_->submit(frame);
 }
 
 /* ---------- 视图/缩略图 ---------- */
@@ -1069,8 +965,7 @@ VideoTile* MainWindow::ensureRemoteTile(const QString& sender)
     connect(t->timer, &QTimer::timeout, this, [this, t](){
         setTileWaiting(t);
         if (mainKey_ == t->key) {
-            mainVideo_->clear();
-            mainVideo_->setText(QStringLiteral("等待视频/屏幕..."));
+            mainVideo_->showText(QStringLiteral("等待视频/屏幕..."));
         }
     });
 
@@ -1092,10 +987,14 @@ void MainWindow::removeRemoteTile(const QString& sender)
         if (currentMode() == ViewMode::Grid) gridLayout_->removeWidget(t->box);
         else focusThumbLayout_->removeWidget(t->box);
     }
+    t->timer->stop();
+    // box 延迟删除，期间仍可能有排队的事件访问 t；VideoTile 随 box 一起释放
+    connect(t->box, &QObject::destroyed, [t]() { delete t; });
     t->box->deleteLater();
     remoteTiles_.erase(it);
 
     if (audio_) audio_->dropPeer(sender);
+    decoder_->removeSender(sender);
 
     if (currentMode() == ViewMode::Grid) refreshGridOnly();
     else refreshFocusThumbs();
@@ -1179,8 +1078,7 @@ void MainWindow::setTileWaiting(VideoTile* t, const QString& text)
     t->timer->stop();
     t->lastCam = QImage();
     t->lastScreen = QImage();
-    t->video->clear();
-    t->video->setText(text);
+    t->video->showText(text);
 }
 
 void MainWindow::kickRemoteAlive(VideoTile* t)
@@ -1193,8 +1091,7 @@ void MainWindow::setMainKey(const QString& key)
     mainKey_ = key;
 
     if (mainKey_.isEmpty()) {
-        mainVideo_->clear();
-        mainVideo_->setText(QStringLiteral("点击右侧任意画面设为主画面"));
+        mainVideo_->showText(QStringLiteral("点击右侧任意画面设为主画面"));
         mainName_->setText(QString());
         annotCanvas_->setTargetKey(mainKey_);
         annotCanvas_->setActiveModel(nullptr);
@@ -1237,13 +1134,12 @@ void MainWindow::setMainKey(const QString& key)
 void MainWindow::updateMainFromTile(VideoTile* t)
 {
     if (!t) return;
-    QImage composed = composeTileImage(t, mainVideo_->size());
+    QImage composed = t->mainComp.compose(t->lastCam, t->lastScreen, t->camPrimary, mainVideo_->frameTarget());
     if (composed.isNull()) {
-        mainVideo_->clear();
-        mainVideo_->setText(QStringLiteral("等待视频/屏幕..."));
+        mainVideo_->showText(QStringLiteral("等待视频/屏幕..."));
         return;
     }
-    fitLabelImage(mainVideo_, composed);
+    mainVideo_->setFrame(composed);
     // 主画面上的标注由 annotCanvas_ 叠加绘制
 }
 
@@ -1269,14 +1165,13 @@ void MainWindow::updateMainFitted()
 void MainWindow::refreshTilePixmap(VideoTile* t)
 {
     if (!t || !t->video) return;
-    QImage composed = composeTileImage(t, t->video->size());
+    QImage composed = t->thumbComp.compose(t->lastCam, t->lastScreen, t->camPrimary, t->video->frameTarget());
     if (composed.isNull()) {
-        t->video->clear();
-        t->video->setText(QStringLiteral("等待视频/屏幕..."));
+        t->video->showText(QStringLiteral("等待视频/屏幕..."));
         return;
     }
 
-    // 缩略图上叠加标注（主画面由 AnnotCanvas 绘制叠加）
+    // 缩略图上叠加标注（主画面由 AnnotCanvas 绘制叠加）；composed 与合成画布共享，绘制时自动深拷贝，不污染合成缓存
     const bool isMain = (centerStack_->currentWidget() == focusPage_ && mainKey_ == t->key);
     if (!isMain) {
         if (auto* m = annotModels_.value(t->key, nullptr)) {
@@ -1286,7 +1181,7 @@ void MainWindow::refreshTilePixmap(VideoTile* t)
         }
     }
 
-    fitLabelImage(t->video, composed);
+    t->video->setFrame(composed);
 }
 
 void MainWindow::togglePiP(VideoTile* t)
@@ -1337,7 +1232,8 @@ void MainWindow::bindVolumeButton(VideoTile* t, bool isLocal)
         popup->setValue(initial);
         popup->openFor(t->volBtn);
 
-        connect(popup, &VolumePopup::valueChanged, this, [this, t, isLocal](int percent){
+        // 以按钮为上下文：窗口移除后不再回调已释放的 VideoTile
+        connect(popup, &VolumePopup::valueChanged, t->volBtn, [this, t, isLocal](int percent){
             percent = qBound(0, percent, 200);
             t->volPercent = percent;
             if (!audio_) return;
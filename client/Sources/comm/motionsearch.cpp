@@ -0,0 +1,117 @@
+#include "motionsearch.h"
+#include "blockdiff.h"
+
+bool MotionSearch::find(const QImage& prev, const QImage& curr, const QVector<quint8>& dirty, int bs,
+                        QVector<ScreenCodec::CopyOp>& ops)
+{
+    ops.clear();
+    if (prev.size() != curr.size() || prev.depth() != 32 || curr.depth() != 32) return false;
+    const int W = curr.width(), H = curr.height();
+    const int bx = (W + bs - 1) / bs;
+    const int by = (H + bs - 1) / bs;
+    if (dirty.size() != bx * by) return false;
+
+    // 竖条：每条的变化行范围
+    QVector<QPair<int,int>> span(bx, qMakePair(INT_MAX, 0));
+    for (int i = 0; i < dirty.size(); ++i) {
+        if (!dirty[i]) continue;
+        QPair<int,int>& s = span[i % bx];
+        s.first  = qMin(s.first, (i / bx) * bs);
+        s.second = qMax(s.second, qMin(H, (i / bx + 1) * bs));
+    }
+    BlockDiff::stripHashes(prev, bs, prevH_);
+    BlockDiff::stripHashes(curr, bs, currH_);
+    searchAxis(bx, H, span, ops, true, bs, W);
+    if (!ops.isEmpty()) return true;
+
+    // 横带：每带的变化列范围
+    span.fill(qMakePair(INT_MAX, 0), by);
+    for (int i = 0; i < dirty.size(); ++i) {
+        if (!dirty[i]) continue;
+        QPair<int,int>& s = span[i / bx];
+        s.first  = qMin(s.first, (i % bx) * bs);
+        s.second = qMax(s.second, qMin(W, (i % bx + 1) * bs));
+    }
+    BlockDiff::bandHashes(prev, bs, prevH_);
+    BlockDiff::bandHashes(curr, bs, currH_);
+    searchAxis(by, W, span, ops, false, bs, H);
+    return !ops.isEmpty();
+}
+
+void MotionSearch::searchAxis(int lanes, int len, const QVector<QPair<int,int>>& span,
+                              QVector<ScreenCodec::CopyOp>& ops, bool vertical, int bs, int laneLimit)
+{
+    // 1) 各条带独立投票：旧帧中唯一出现的片段为新帧变化位置给出偏移（空白等重复片段不参与）
+    laneOffset_.fill(0, lanes);
+    QHash<quint64, int> where;
+    QHash<int, int> votes;
+    for (int l = 0; l < lanes; ++l) {
+        const int a = span[l].first, b = span[l].second;
+        if (b - a < kMinRun) continue;
+        const quint64* ph = prevH_.constData() + l * len;
+        const quint64* ch = currH_.constData() + l * len;
+
+        where.clear();
+        for (int p = a; p < b; ++p) {
+            auto it = where.find(ph[p]);
+            if (it == where.end()) where.insert(ph[p], p);
+            else it.value() = -1;
+        }
+        votes.clear();
+        int best = 0, bestVotes = 0;
+        for (int p = a; p < b; ++p) {
+            if (ch[p] == ph[p]) continue;
+            const auto it = where.constFind(ch[p]);
+            if (it == where.constEnd() || it.value() < 0) continue;
+            const int d = it.value() - p;
+            const int v = ++votes[d];
+            if (v > bestVotes) { bestVotes = v; best = d; }
+        }
+        if (bestVotes >= kMinVotes) laneOffset_[l] = best;
+    }
+
+    // 2) 偏移相同的相邻条带合并，取全部条带同时匹配的最长连续段
+    for (int la = 0; la < lanes; ) {
+        const int d = laneOffset_[la];
+        if (d == 0) { ++la; continue; }
+        int lb = la;
+        int a = span[la].first, b = span[la].second;
+        while (lb + 1 < lanes && laneOffset_[lb + 1] == d) {
+            ++lb;
+            a = qMin(a, span[lb].first);
+            b = qMax(b, span[lb].second);
+        }
+
+        int runStart = 0, runLen = 0, cur = 0;
+        for (int p = a; p < b; ++p) {
+            const int src = p + d;
+            bool match = src >= a && src < b;
+            for (int l = la; match && l <= lb; ++l)
+                match = currH_[l * len + p] == prevH_[l * len + src];
+            cur = match ? cur + 1 : 0;
+            if (cur > runLen) { runLen = cur; runStart = p - cur + 1; }
+        }
+        if (runLen >= kMinRun) {
+            const int l0 = la * bs;
+            const int extent = qMin(laneLimit, (lb + 1) * bs) - l0;
+            ScreenCodec::CopyOp op;
+            if (vertical) {
+                op.dst = QRect(l0, runStart, extent, runLen);
+                op.src = QPoint(l0, runStart + d);
+            } else {
+                op.dst = QRect(runStart, l0, runLen, extent);
+                op.src = QPoint(runStart + d, l0);
+            }
+            ops.push_back(op);
+        }
+        la = lb + 1;
+    }
+
+    // 3) 超出上限时保留面积最大的几个
+    if (ops.size() > kMaxOps) {
+        std::sort(ops.begin(), ops.end(), [](const ScreenCodec::CopyOp& x, const ScreenCodec::CopyOp& y) {
+            return qint64(x.dst.width()) * x.dst.height() > qint64(y.dst.width()) * y.dst.height();
+        });
+        ops.resize(kMaxOps);
+    }
+}
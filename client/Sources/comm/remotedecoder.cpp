@@ -0,0 +1,268 @@
+#include "remotedecoder.h"
+#include "jpegcodec.h"
+#include "screencodec.h"
+#include <QtConcurrent>
+
+struct RemoteDecoder::Lane {
+    QString sender;
+    bool running = false;   // 已有工作线程在处理本通道
+    bool posted  = false;   // 已向 GUI 线程投递通知且尚未取走
+    bool removed = false;
+
+    // 待处理（持锁访问）
+    struct Job { QByteArray data; QSize size; qint64 arrUs = 0; };
+    bool camPending = false;
+    Job  cam;
+    bool keyPending = false;
+    Job  key;
+    QVector<Job> deltas;
+
+    // 工作线程独占（running 期间）
+    QImage camImg;
+    QImage back;            // 屏幕增量还原背板
+
+    // 待 GUI 取走的结果（持锁访问）
+    QImage readyCam, readyScreen;
+    qint64 readyCamArrUs = -1, readyScreenArrUs = -1;
+    QVector<QRect> readyDirty;   // 未通知的背板改写区域，跨批次累积
+    bool readyFull = false;
+
+    // 统计窗口（持锁访问）
+    int decoded = 0, skipped = 0, shown = 0;
+    qint64 decodeUs = 0, maxDecodeUs = 0, latencyUs = 0, maxLatencyUs = 0;
+};
+
+RemoteDecoder::RemoteDecoder(QObject* parent)
+    : QObject(parent)
+{
+    // 各通道串行，线程数只需覆盖同时活跃的发送端；单帧内的矩形另由全局线程池并行
+    pool_.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    clock_.start();
+    statsTimer_.setInterval(5000);
+    connect(&statsTimer_, &QTimer::timeout, this, &RemoteDecoder::onStatsTimer);
+    statsTimer_.start();
+}
+
+RemoteDecoder::~RemoteDecoder()
+{
+    {
+        QMutexLocker lock(&mutex_);
+        for (const LanePtr& l : qAsConst(lanes_)) l->removed = true;
+        lanes_.clear();
+    }
+    pool_.waitForDone();
+}
+
+RemoteDecoder::LanePtr RemoteDecoder::laneFor(const QString& sender)
+{
+    LanePtr& l = lanes_[sender];
+    if (!l) {
+        l = LanePtr::create();
+        l->sender = sender;
+    }
+    return l;
+}
+
+void RemoteDecoder::schedule(const LanePtr& lane)
+{
+    if (lane->running) return;
+    lane->running = true;
+    QtConcurrent::run(&pool_, [this, lane]() { drain(lane); });
+}
+
+void RemoteDecoder::submitCamera(const QString& sender, const QByteArray& jpeg, const QSize& fitWithin)
+{
+    QMutexLocker lock(&mutex_);
+    const LanePtr l = laneFor(sender);
+    if (l->camPending) ++l->skipped;   // 尚未解码的旧帧直接被替换
+    l->camPending = true;
+    l->cam = { jpeg, fitWithin, nowUs() };
+    schedule(l);
+}
+
+void RemoteDecoder::submitScreenKey(const QString& sender, const QByteArray& jpeg)
+{
+    QMutexLocker lock(&mutex_);
+    const LanePtr l = laneFor(sender);
+    // 关键帧可独立解码，其前的待处理帧都不再需要
+    l->skipped += l->deltas.size() + (l->keyPending ? 1 : 0);
+    l->deltas.clear();
+    l->keyPending = true;
+    l->key = { jpeg, QSize(), nowUs() };
+    schedule(l);
+}
+
+void RemoteDecoder::submitScreenDelta(const QString& sender, const QByteArray& blob, const QSize& size)
+{
+    bool overflow = false;
+    {
+        QMutexLocker lock(&mutex_);
+        const LanePtr l = laneFor(sender);
+        // 增量不能跳过；积压过多时背板注定过期，整体丢弃改等关键帧
+        if (l->deltas.size() >= kMaxPendingDeltas) {
+            l->skipped += l->deltas.size();
+            l->deltas.clear();
+            overflow = true;
+        }
+        l->deltas.push_back({ blob, size, nowUs() });
+        schedule(l);
+    }
+    if (overflow) emit keyframeNeeded(sender);
+}
+
+void RemoteDecoder::removeSender(const QString& sender)
+{
+    QMutexLocker lock(&mutex_);
+    const LanePtr l = lanes_.take(sender);
+    if (l) l->removed = true;
+}
+
+void RemoteDecoder::drain(LanePtr lane)
+{
+    JpegCodec& jpeg = JpegCodec::forThread();
+    QMutexLocker lock(&mutex_);
+    while (!lane->removed) {
+        const bool doCam = lane->camPending;
+        const bool doKey = lane->keyPending;
+        if (!doCam && !doKey && lane->deltas.isEmpty()) break;
+        Lane::Job cam, key;
+        QVector<Lane::Job> deltas;
+        if (doCam) { cam = std::move(lane->cam); lane->camPending = false; }
+        if (doKey) { key = std::move(lane->key); lane->keyPending = false; }
+        deltas.swap(lane->deltas);
+        lock.unlock();
+
+        QElapsedTimer t;
+        qint64 camUs = 0, screenUs = 0, screenArrUs = -1;
+        bool camOk = false, screenOk = false, needKey = false;
+        bool full = doKey;
+        QVector<QRect> dirty;
+        int frames = 0;
+        if (doCam) {
+            t.start();
+            camOk = jpeg.decode(cam.data, lane->camImg, cam.size);
+            camUs = t.nsecsElapsed() / 1000;
+            ++frames;
+        }
+        if (doKey || !deltas.isEmpty()) {
+            t.start();
+            if (doKey) {
+                screenOk = jpeg.decode(key.data, lane->back);
+                needKey = !screenOk;
+                screenArrUs = key.arrUs;
+                ++frames;
+            }
+            for (const Lane::Job& d : qAsConst(deltas)) {
+                QImage& back = lane->back;
+                if (back.isNull() || back.size() != d.size) {
+                    back = QImage(d.size, QImage::Format_RGB32);
+                    back.fill(Qt::black);
+                    needKey = true;   // 尚无基准帧（中途加入/分辨率变化）
+                    full = true;
+                }
+                // 失败说明背板已不可信；仍继续应用后续增量，等关键帧纠正
+                screenOk = ScreenCodec::decodeDelta(d.data, back, full ? nullptr : &dirty);
+                if (!screenOk) needKey = true;
+                screenArrUs = d.arrUs;
+                ++frames;
+            }
+            screenUs = t.nsecsElapsed() / 1000;
+        }
+
+        lock.relock();
+        lane->decoded += frames;
+        lane->decodeUs += camUs + screenUs;
+        lane->maxDecodeUs = qMax(lane->maxDecodeUs, qMax(camUs, screenUs));
+        // 一次处理多个增量时只有最后一个会被显示
+        const int screenFrames = deltas.size() + (doKey ? 1 : 0);
+        if (screenFrames > 1) lane->skipped += screenFrames - 1;
+        if (camOk) {
+            if (lane->readyCamArrUs >= 0) ++lane->skipped;
+            lane->readyCam = lane->camImg;   // 共享；下帧解码时换新缓冲，不影响显示中的图像
+            lane->readyCamArrUs = cam.arrUs;
+        }
+        if (full) {
+            lane->readyFull = true;
+            lane->readyDirty.clear();
+        } else if (!lane->readyFull) {
+            lane->readyDirty += dirty;
+            if (lane->readyDirty.size() > kMaxDirtyRects) {
+                lane->readyFull = true;
+                lane->readyDirty.clear();
+            }
+        }
+        if (screenOk) {
+            if (lane->readyScreenArrUs >= 0) ++lane->skipped;
+            lane->readyScreen = lane->back;  // 下个增量写入时在本线程分离
+            lane->readyScreenArrUs = screenArrUs;
+        }
+        if ((camOk || screenOk) && !lane->posted && !lane->removed) {
+            lane->posted = true;
+            const QString sender = lane->sender;
+            QMetaObject::invokeMethod(this, [this, sender]() { deliver(sender); }, Qt::QueuedConnection);
+        }
+        if (needKey) emit keyframeNeeded(lane->sender);
+    }
+    lane->running = false;
+}
+
+void RemoteDecoder::deliver(const QString& sender)
+{
+    QImage cam, screen;
+    QVector<QRect> dirty;
+    {
+        QMutexLocker lock(&mutex_);
+        const LanePtr l = lanes_.value(sender);
+        if (!l) return;
+        l->posted = false;
+        const qint64 now = nowUs();
+        for (qint64* arr : { &l->readyCamArrUs, &l->readyScreenArrUs }) {
+            if (*arr < 0) continue;
+            l->latencyUs += now - *arr;
+            l->maxLatencyUs = qMax(l->maxLatencyUs, now - *arr);
+            ++l->shown;
+            *arr = -1;
+        }
+        cam.swap(l->readyCam);
+        screen.swap(l->readyScreen);
+        if (!screen.isNull()) {
+            if (!l->readyFull) dirty.swap(l->readyDirty);
+            l->readyDirty.clear();
+            l->readyFull = false;
+        }
+    }
+    if (!cam.isNull()) emit cameraReady(sender, cam);
+    if (!screen.isNull()) emit screenReady(sender, screen, dirty);
+}
+
+void RemoteDecoder::onStatsTimer()
+{
+    QJsonObject j;
+    QStringList parts;
+    {
+        QMutexLocker lock(&mutex_);
+        for (const LanePtr& l : qAsConst(lanes_)) {
+            if (l->decoded == 0 && l->skipped == 0) continue;
+            const QJsonObject s{
+                {"decoded",      l->decoded},
+                {"shown",        l->shown},
+                {"skipped",      l->skipped},
+                {"decodeMs",     l->decoded ? l->decodeUs / 1000.0 / l->decoded : 0.0},
+                {"maxDecodeMs",  l->maxDecodeUs / 1000.0},
+                {"latencyMs",    l->shown ? l->latencyUs / 1000.0 / l->shown : 0.0},
+                {"maxLatencyMs", l->maxLatencyUs / 1000.0}
+            };
+            j.insert(l->sender, s);
+            parts << QString("%1: dec=%2ms(max %3) lat=%4ms(max %5) n=%6 skip=%7")
+                     .arg(l->sender).arg(s["decodeMs"].toDouble(), 0, 'f', 1)
+                     .arg(s["maxDecodeMs"].toDouble(), 0, 'f', 1).arg(s["latencyMs"].toDouble(), 0, 'f', 1)
+                     .arg(s["maxLatencyMs"].toDouble(), 0, 'f', 1).arg(l->decoded).arg(l->skipped);
+            l->decoded = l->skipped = l->shown = 0;
+            l->decodeUs = l->maxDecodeUs = l->latencyUs = l->maxLatencyUs = 0;
+        }
+    }
+    lastStats_ = j;
+    if (parts.isEmpty()) return;
+    qInfo().noquote() << "[RECV]" << parts.join(QStringLiteral("; "));
+    emit statsUpdated(j);
+}
@@ -0,0 +1,694 @@
+#include "screencodec.h"
+#include "jpegcodec.h"
+#include <QtConcurrent>
+
+namespace ScreenCodec {
+namespace {
+
+// 各编码的累计计数（编码/解码可能在不同线程）
+struct CodecStats {
+    QAtomicInteger<qint64> encRects{0}, encRaw{0}, encBytes{0}, encUs{0};
+    QAtomicInteger<qint64> decRects{0}, decUs{0};
+};
+CodecStats g_codec[4];
+QAtomicInteger<qint64> g_encFrames{0}, g_encFrameUs{0}, g_encFrameBytes{0};
+QAtomicInteger<qint64> g_decFrames{0}, g_decFrameUs{0};
+QAtomicInteger<qint64> g_predRects{0}, g_paletteRects{0}, g_copyPixels{0};
+
+inline qint64 elapsedUs(const QElapsedTimer& t) { return t.nsecsElapsed() / 1000; }
+
+// 收发两侧各自每 10 秒最多输出一次汇总
+void maybeLogStats()
+{
+    static QAtomicInteger<qint64> lastLogMs{0};
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 last = lastLogMs.loadAcquire();
+    if (now - last >= 10000 && lastLogMs.testAndSetOrdered(last, now))
+        qInfo().noquote() << statsSummary();
+}
+
+inline quint32 load32(const uchar* p) { quint32 v; memcpy(&v, p, 4); return v; }
+
+struct RectJob {
+    QRect      r;
+    bool       pred = true;   // 参考区域两端一致，可做差值预测
+    quint8     codec = 0;
+    QByteArray data;
+};
+
+// 有损标记：格坐标与 r 相交的格范围（r 已裁剪到图像内）
+void cellRange(const QRect& r, int& x0, int& y0, int& x1, int& y1)
+{
+    x0 = r.left() / Mirror::kCell;  x1 = r.right() / Mirror::kCell;
+    y0 = r.top() / Mirror::kCell;   y1 = r.bottom() / Mirror::kCell;
+}
+
+int cellsPerRow(const QImage& img) { return (img.width() + Mirror::kCell - 1) / Mirror::kCell; }
+
+// mask 中与 r 相交的格是否有有损格
+bool touchesLossy(const QImage& img, const QVector<quint8>& mask, const QRect& r)
+{
+    const QRect c = r & img.rect();
+    if (c.isEmpty()) return false;
+    const int bx = cellsPerRow(img);
+    int x0, y0, x1, y1;
+    cellRange(c, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy)
+        for (int cx = x0; cx <= x1; ++cx)
+            if (mask[cy * bx + cx]) return true;
+    return false;
+}
+
+// 写入矩形后的标记：有损时相交格全部置位；无损时只清零完全覆盖的格（部分覆盖的格保持原状）
+void markRect(Mirror& m, const QRect& r, bool lossy)
+{
+    const QRect c = r & m.img.rect();
+    if (c.isEmpty()) return;
+    const int bx = cellsPerRow(m.img);
+    int x0, y0, x1, y1;
+    cellRange(c, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const QRect cell = QRect(cx * Mirror::kCell, cy * Mirror::kCell, Mirror::kCell, Mirror::kCell) & m.img.rect();
+            if (lossy) m.lossy[cy * bx + cx] = 1;
+            else if (c.contains(cell)) m.lossy[cy * bx + cx] = 0;
+        }
+    }
+}
+
+// 区域复制后的标记：目标格的像素来自源区域，源区域含有损格则目标格有损；
+// 完全覆盖的格取源区域的状态，部分覆盖的格只可能变为有损
+void copyMask(Mirror& m, const CopyOp& op)
+{
+    const QVector<quint8> before = m.lossy;   // 源与目标可重叠，按复制前的状态判断
+    const int bx = cellsPerRow(m.img);
+    const QPoint delta = op.src - op.dst.topLeft();
+    int x0, y0, x1, y1;
+    cellRange(op.dst, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const QRect cell = QRect(cx * Mirror::kCell, cy * Mirror::kCell, Mirror::kCell, Mirror::kCell) & m.img.rect();
+            const QRect part = cell & op.dst;
+            const bool srcLossy = touchesLossy(m.img, before, part.translated(delta));
+            quint8& v = m.lossy[cy * bx + cx];
+            v = part == cell ? quint8(srcLossy) : quint8(v | quint8(srcLossy));
+        }
+    }
+}
+
+// 矩形像素逐行拼接
+QByteArray extractRaw(const QImage& img, const QRect& r)
+{
+    QByteArray raw(r.width() * r.height() * 4, Qt::Uninitialized);
+    char* dst = raw.data();
+    for (int row = 0; row < r.height(); ++row) {
+        memcpy(dst, img.constScanLine(r.y() + row) + r.x() * 4, size_t(r.width()) * 4);
+        dst += r.width() * 4;
+    }
+    return raw;
+}
+
+// 逐字节减/加（mod 256），8 字节一组 SWAR，尾部逐字节
+constexpr quint64 kHigh = 0x8080808080808080ull;
+
+void subBytes(uchar* a, const uchar* b, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        x = ((x | kHigh) - (y & ~kHigh)) ^ ((x ^ ~y) & kHigh);
+        memcpy(a + i, &x, 8);
+    }
+    for (; i < n; ++i) a[i] = uchar(a[i] - b[i]);
+}
+
+void addBytes(uchar* a, const uchar* b, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        x = ((x & ~kHigh) + (y & ~kHigh)) ^ ((x ^ y) & kHigh);
+        memcpy(a + i, &x, 8);
+    }
+    for (; i < n; ++i) a[i] = uchar(a[i] + b[i]);
+}
+
+// 照片类区域判定：稀疏采样（最多约 256 点）统计不同颜色数（上限 128）
+bool wantJpeg(const QImage& img, const QRect& r, Policy policy)
+{
+    if (policy == ForceJpeg) return true;
+    if (policy != AutoCodec) return false;
+    const int area = r.width() * r.height();
+    if (area < 64 * 64) return false;
+    int step = 4;
+    while (area / (step * step) > 256) step *= 2;
+
+    quint32 table[256];
+    quint8  used[256] = {};
+    int distinct = 0;
+    for (int y = r.top(); y <= r.bottom() && distinct < 96; y += step) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        for (int x = r.left(); x <= r.right() && distinct < 96; x += step) {
+            const quint32 c = line[x] & 0xFFFFFFu;
+            quint32 h = (c * 2654435761u) >> 24;
+            while (used[h] && table[h] != c) h = (h + 1) & 255;
+            if (!used[h]) { used[h] = 1; table[h] = c; ++distinct; }
+        }
+    }
+    return distinct >= 96;
+}
+
+// 精确统计颜色并生成索引；超过 256 色返回 0
+int buildPalette(const quint32* px, int n, quint32* pal, uchar* idx)
+{
+    enum { kSlots = 512 };
+    quint32 keys[kSlots];
+    qint16  vals[kSlots];
+    std::fill(vals, vals + kSlots, qint16(-1));
+    int count = 0;
+    quint32 lastColor = 0;
+    int lastIndex = -1;
+    for (int i = 0; i < n; ++i) {
+        const quint32 c = px[i];
+        if (c == lastColor && lastIndex >= 0) { idx[i] = uchar(lastIndex); continue; }
+        quint32 h = (c * 2654435761u) >> 23;
+        while (vals[h] >= 0 && keys[h] != c) h = (h + 1) & (kSlots - 1);
+        if (vals[h] < 0) {
+            if (count == 256) return 0;
+            keys[h] = c;
+            vals[h] = qint16(count);
+            pal[count++] = c;
+        }
+        lastColor = c;
+        lastIndex = vals[h];
+        idx[i] = uchar(lastIndex);
+    }
+    return count;
+}
+
+inline int paletteBits(int n) { return n <= 2 ? 1 : n <= 4 ? 2 : n <= 16 ? 4 : 8; }
+inline int packedStride(int w, int bits) { return (w * bits + 7) / 8; }
+
+// [n 个 u32 颜色][逐行打包的索引（高位在前，行末补齐到字节）]
+QByteArray packPalette(const quint32* pal, int n, const uchar* idx, int w, int h)
+{
+    const int bits = paletteBits(n);
+    const int stride = packedStride(w, bits);
+    QByteArray out(n * 4 + stride * h, 0);
+    memcpy(out.data(), pal, size_t(n) * 4);
+    uchar* dst = reinterpret_cast<uchar*>(out.data()) + n * 4;
+    const int perByte = 8 / bits;
+    for (int y = 0; y < h; ++y, dst += stride) {
+        const uchar* row = idx + y * w;
+        for (int x = 0; x < w; ++x)
+            dst[x / perByte] |= uchar(row[x] << (8 - bits - (x % perByte) * bits));
+    }
+    return out;
+}
+
+bool unpackPalette(const uchar* src, int n, int w, int h, quint32* px)
+{
+    const int bits = paletteBits(n);
+    const int stride = packedStride(w, bits);
+    quint32 pal[256];
+    memcpy(pal, src, size_t(n) * 4);
+    src += n * 4;
+    const int perByte = 8 / bits;
+    const int mask = (1 << bits) - 1;
+    for (int y = 0; y < h; ++y, src += stride) {
+        for (int x = 0; x < w; ++x) {
+            const int k = (src[x / perByte] >> (8 - bits - (x % perByte) * bits)) & mask;
+            if (k >= n) return false;
+            *px++ = pal[k];
+        }
+    }
+    return true;
+}
+
+QByteArray compressBase(quint8 codec, const QByteArray& in)
+{
+    return codec == RECT_LZ ? lzCompress(in.constData(), in.size()) : qCompress(in, 1);
+}
+
+bool decompressBase(quint8 codec, const char* src, int len, QByteArray& out, int expected)
+{
+    if (codec == RECT_LZ) {
+        out.resize(expected);
+        return lzDecompress(src, len, out.data(), expected);
+    }
+    if (codec == RECT_ZLIB) {
+        out = qUncompress(reinterpret_cast<const uchar*>(src), len);
+        return out.size() == expected;
+    }
+    return false;
+}
+
+void writeRows(uchar* base, int bpl, const QRect& r, const char* src)
+{
+    const int rowBytes = r.width() * 4;
+    for (int row = 0; row < r.height(); ++row)
+        memcpy(base + (r.y() + row) * bpl + r.x() * 4, src + row * rowBytes, size_t(rowBytes));
+}
+
+// 单个像素矩形编码，并把接收端将得到的像素写回参考镜像（各矩形互不重叠，可并行）
+// j.pred 为 false 时（参考区域含有损像素，两端可能不一致）不做差值预测
+void encodeRect(const QImage& curr, uchar* refBase, int refBpl, RectJob& j, Policy policy, int quality)
+{
+    const QRect& r = j.r;
+    if (wantJpeg(curr, r, policy)) {
+        JpegCodec& codec = JpegCodec::forThread();
+        QByteArray jpeg;
+        QImage dec;
+        if (codec.encode(curr.copy(r), quality, jpeg) && codec.decode(jpeg, dec)) {
+            // 有损：镜像写入解码结果，保证后续预测与接收端一致
+            if (dec.size() == r.size()) {
+                for (int row = 0; row < r.height(); ++row)
+                    memcpy(refBase + (r.y() + row) * refBpl + r.x() * 4, dec.constScanLine(row), size_t(r.width()) * 4);
+                j.codec = RECT_JPEG;
+                j.data = jpeg;
+                return;
+            }
+        }
+        // JPEG 失败时回退无损
+    }
+
+    const int npx = r.width() * r.height();
+    QByteArray raw = extractRaw(curr, r);
+    QByteArray stream = raw;
+    quint8 flags = 0;
+
+    // 相对背板的差值：未变像素为 0，至少四分之一未变才采用
+    if (j.pred) {
+        QByteArray res = raw;
+        res.detach();
+        uchar* p = reinterpret_cast<uchar*>(res.data());
+        int zeros = 0;
+        for (int row = 0; row < r.height(); ++row) {
+            uchar* d = p + row * r.width() * 4;
+            const uchar* pred = refBase + (r.y() + row) * refBpl + r.x() * 4;
+            subBytes(d, pred, r.width() * 4);
+            for (int x = 0; x < r.width(); ++x) zeros += load32(d + x * 4) == 0;
+        }
+        if (zeros * 4 >= npx) { stream = res; flags |= FLAG_PRED; }
+    }
+
+    quint32 pal[256];
+    QByteArray idx(npx, Qt::Uninitialized);
+    const int colors = buildPalette(reinterpret_cast<const quint32*>(stream.constData()), npx, pal,
+                                    reinterpret_cast<uchar*>(idx.data()));
+
+    quint8 codec = policy == ForceLz ? RECT_LZ : policy == ForceZlib ? RECT_ZLIB
+                 : (colors > 0 && colors <= 16) ? RECT_LZ : RECT_ZLIB;
+    if (colors > 0) {
+        const QByteArray packed = packPalette(pal, colors, reinterpret_cast<const uchar*>(idx.constData()),
+                                              r.width(), r.height());
+        j.data = QByteArray(1, char(colors - 1)) + compressBase(codec, packed);
+        flags |= FLAG_PALETTE;
+    } else {
+        j.data = compressBase(codec, stream);
+    }
+    j.codec = quint8(codec | flags);
+    writeRows(refBase, refBpl, r, raw.constData());
+}
+
+struct DecodeItem {
+    int x = 0, y = 0, w = 0, h = 0;
+    quint8 codec = 0;
+    const char* data = nullptr;
+    int len = 0;
+};
+
+// 超过此数的像素矩形不做两两相交检查，直接串行解码（编码端每帧不超过 120 个）
+constexpr int kMaxParallelItems = 512;
+
+// 像素矩形两两不相交时才能并行写背板：相交时 FLAG_PRED 读到的参考取决于执行先后，且写入互相覆盖
+bool disjoint(const QVector<DecodeItem>& items)
+{
+    if (items.size() > kMaxParallelItems) return false;
+    for (int i = 0; i < items.size(); ++i) {
+        const QRect a(items[i].x, items[i].y, items[i].w, items[i].h);
+        for (int j = i + 1; j < items.size(); ++j) {
+            if (a.intersects(QRect(items[j].x, items[j].y, items[j].w, items[j].h))) return false;
+        }
+    }
+    return true;
+}
+
+// 解码单个像素矩形并写入背板（并行时由调用方保证互不重叠）
+bool decodeRect(const DecodeItem& it, uchar* base, int bpl)
+{
+    const int rowBytes = it.w * 4;
+    const quint8 codec = it.codec & CODEC_MASK;
+    const QRect r(it.x, it.y, it.w, it.h);
+    if (codec == RECT_JPEG) {
+        QImage img;
+        if (!JpegCodec::forThread().decode(it.data, it.len, img) || img.size() != r.size()) return false;
+        for (int row = 0; row < it.h; ++row)
+            memcpy(base + (it.y + row) * bpl + it.x * 4, img.constScanLine(row), size_t(rowBytes));
+        return true;
+    }
+
+    QByteArray px;
+    if (it.codec & FLAG_PALETTE) {
+        if (it.len < 1) return false;
+        const int n = uchar(it.data[0]) + 1;
+        const int expected = n * 4 + packedStride(it.w, paletteBits(n)) * it.h;
+        QByteArray packed;
+        if (!decompressBase(codec, it.data + 1, it.len - 1, packed, expected)) return false;
+        px.resize(rowBytes * it.h);
+        if (!unpackPalette(reinterpret_cast<const uchar*>(packed.constData()), n, it.w, it.h,
+                           reinterpret_cast<quint32*>(px.data())))
+            return false;
+    } else if (!decompressBase(codec, it.data, it.len, px, rowBytes * it.h)) {
+        return false;
+    }
+
+    if (it.codec & FLAG_PRED) {
+        const uchar* src = reinterpret_cast<const uchar*>(px.constData());
+        for (int row = 0; row < it.h; ++row)
+            addBytes(base + (it.y + row) * bpl + it.x * 4, src + row * rowBytes, rowBytes);
+    } else {
+        writeRows(base, bpl, r, px.constData());
+    }
+    return true;
+}
+
+inline void putLength(uchar*& op, int n)
+{
+    while (n >= 255) { *op++ = 255; n -= 255; }
+    *op++ = uchar(n);
+}
+
+inline bool getLength(const uchar*& ip, const uchar* iend, int& n)
+{
+    uchar b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        n += b;
+        if (n > (1 << 26)) return false; // 超过单矩形上限，视为损坏
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+// LZ 块格式（与 LZ4 block 相同思路）：
+//   序列 = [token: 高 4 位字面量长度, 低 4 位匹配长度-4][扩展长度][字面量][u16 LE 偏移][扩展长度]
+//   最后一个序列只有字面量；RGB32 纯色区域表现为偏移 4 的长匹配
+QByteArray lzCompress(const char* srcChars, int n)
+{
+    const uchar* src = reinterpret_cast<const uchar*>(srcChars);
+    QByteArray out(n + n / 255 + 16, Qt::Uninitialized);
+    uchar* op = reinterpret_cast<uchar*>(out.data());
+    uchar* const obase = op;
+
+    enum { kHashBits = 12 };
+    int table[1 << kHashBits];
+    std::fill(table, table + (1 << kHashBits), -1);
+
+    int anchor = 0, i = 0, misses = 0;
+    while (i + 4 <= n) {
+        const quint32 seq = load32(src + i);
+        const quint32 h = (seq * 2654435761u) >> (32 - kHashBits);
+        const int ref = table[h];
+        table[h] = i;
+        if (ref < 0 || i - ref > 0xFFFF || load32(src + ref) != seq) {
+            i += 1 + (misses++ >> 5); // 不可压缩数据逐步加大步长
+            continue;
+        }
+        misses = 0;
+        int len = 4;
+        while (i + len < n && src[ref + len] == src[i + len]) ++len;
+
+        const int lit = i - anchor;
+        uchar* token = op++;
+        *token = uchar(qMin(lit, 15) << 4);
+        if (lit >= 15) putLength(op, lit - 15);
+        memcpy(op, src + anchor, size_t(lit));
+        op += lit;
+        const int off = i - ref;
+        *op++ = uchar(off & 0xFF);
+        *op++ = uchar(off >> 8);
+        const int ml = len - 4;
+        *token |= uchar(qMin(ml, 15));
+        if (ml >= 15) putLength(op, ml - 15);
+
+        i += len;
+        anchor = i;
+    }
+
+    // 末尾字面量序列
+    const int lit = n - anchor;
+    *op++ = uchar(qMin(lit, 15) << 4);
+    if (lit >= 15) putLength(op, lit - 15);
+    memcpy(op, src + anchor, size_t(lit));
+    op += lit;
+
+    out.resize(int(op - obase));
+    return out;
+}
+
+bool lzDecompress(const char* srcChars, int size, char* dstChars, int dstSize)
+{
+    const uchar* ip = reinterpret_cast<const uchar*>(srcChars);
+    const uchar* const iend = ip + size;
+    uchar* const dst = reinterpret_cast<uchar*>(dstChars);
+    uchar* op = dst;
+    uchar* const oend = dst + dstSize;
+
+    while (ip < iend) {
+        const uchar token = *ip++;
+        int lit = token >> 4;
+        if (lit == 15 && !getLength(ip, iend, lit)) return false;
+        if (lit > iend - ip || lit > oend - op) return false;
+        memcpy(op, ip, size_t(lit));
+        ip += lit;
+        op += lit;
+        if (ip == iend) break; // 末尾序列
+
+        if (iend - ip < 2) return false;
+        const int off = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (off == 0 || off > op - dst) return false;
+        int len = token & 15;
+        if (len == 15 && !getLength(ip, iend, len)) return false;
+        len += 4;
+        if (len > oend - op) return false;
+
+        const uchar* m = op - off;
+        if (off >= len) {
+            memcpy(op, m, size_t(len));
+            op += len;
+        } else {
+            while (len--) *op++ = *m++; // 重叠复制（游程）
+        }
+    }
+    return op == oend;
+}
+
+bool applyCopy(QImage& img, const CopyOp& op)
+{
+    const QRect bounds = img.rect();
+    const QRect src(op.src, op.dst.size());
+    if (op.dst.isEmpty() || !bounds.contains(op.dst) || !bounds.contains(src)) return false;
+    uchar* base = img.bits();
+    const int bpl = img.bytesPerLine();
+    const size_t rowBytes = size_t(op.dst.width()) * 4;
+    // 源在上方时自下而上复制，避免重叠区域被提前覆盖
+    const bool up = src.y() < op.dst.y();
+    for (int k = 0; k < op.dst.height(); ++k) {
+        const int row = up ? op.dst.height() - 1 - k : k;
+        memmove(base + (op.dst.y() + row) * bpl + op.dst.x() * 4,
+                base + (src.y() + row) * bpl + src.x() * 4, rowBytes);
+    }
+    return true;
+}
+
+void Mirror::markAll(bool lossyKey)
+{
+    const int k = kCell;
+    lossy.fill(lossyKey ? 1 : 0, ((img.width() + k - 1) / k) * ((img.height() + k - 1) / k));
+}
+
+QByteArray encodeDelta(const QImage& curr, const QVector<QRect>& rects,
+                       const QVector<CopyOp>& copies, Mirror& ref, Policy policy, int jpegQuality)
+{
+    QElapsedTimer t; t.start();
+
+    QImage& img = ref.img;
+    if (img.size() != curr.size() || img.format() != QImage::Format_RGB32) {
+        img = QImage(curr.size(), QImage::Format_RGB32);
+        img.fill(Qt::black);
+        ref.markAll(false);
+    }
+    const int k = Mirror::kCell;
+    if (ref.lossy.size() != ((img.width() + k - 1) / k) * ((img.height() + k - 1) / k))
+        ref.markAll(true);
+    // 复制先于像素矩形执行，预测以复制后的镜像为准
+    QVector<CopyOp> applied;
+    for (const CopyOp& op : copies) {
+        if (!applyCopy(img, op)) continue;
+        copyMask(ref, op);
+        applied.push_back(op);
+        g_copyPixels.fetchAndAddRelaxed(qint64(op.dst.width()) * op.dst.height());
+    }
+
+    QVector<RectJob> jobs(rects.size());
+    for (int i = 0; i < rects.size(); ++i) {
+        jobs[i].r = rects[i];
+        jobs[i].pred = !touchesLossy(img, ref.lossy, rects[i]);
+    }
+
+    // 各矩形独立压缩，分摊到全局线程池；镜像先完成分离，工作线程只写各自区域
+    uchar* refBase = img.bits();
+    const int refBpl = img.bytesPerLine();
+    QtConcurrent::blockingMap(jobs, [&curr, refBase, refBpl, policy, jpegQuality](RectJob& j) {
+        QElapsedTimer tt; tt.start();
+        encodeRect(curr, refBase, refBpl, j, policy, jpegQuality);
+        CodecStats& s = g_codec[j.codec & CODEC_MASK];
+        s.encRects.fetchAndAddRelaxed(1);
+        s.encRaw.fetchAndAddRelaxed(qint64(j.r.width()) * j.r.height() * 4);
+        s.encBytes.fetchAndAddRelaxed(j.data.size());
+        s.encUs.fetchAndAddRelaxed(elapsedUs(tt));
+        if (j.codec & FLAG_PRED) g_predRects.fetchAndAddRelaxed(1);
+        if (j.codec & FLAG_PALETTE) g_paletteRects.fetchAndAddRelaxed(1);
+    });
+    // 有损标记在并行阶段之后串行更新（相邻矩形可能共用部分覆盖的格）
+    for (const RectJob& j : jobs) markRect(ref, j.r, (j.codec & CODEC_MASK) == RECT_JPEG);
+
+    int total = 6 + applied.size() * 17;
+    for (const RectJob& j : jobs) total += 13 + j.data.size();
+    QByteArray blob(total, Qt::Uninitialized);
+    uchar* p = reinterpret_cast<uchar*>(blob.data());
+    qToBigEndian<quint32>(kMagicDS02, p);                          p += 4;
+    qToBigEndian<quint16>(quint16(applied.size() + jobs.size()), p); p += 2;
+    auto putRect = [&p](const QRect& r, quint8 codec, int len) {
+        qToBigEndian<quint16>(quint16(r.x()), p);      p += 2;
+        qToBigEndian<quint16>(quint16(r.y()), p);      p += 2;
+        qToBigEndian<quint16>(quint16(r.width()), p);  p += 2;
+        qToBigEndian<quint16>(quint16(r.height()), p); p += 2;
+        *p++ = codec;
+        qToBigEndian<quint32>(quint32(len), p);        p += 4;
+    };
+    for (const CopyOp& op : applied) {
+        putRect(op.dst, RECT_COPY, 4);
+        qToBigEndian<quint16>(quint16(op.src.x()), p); p += 2;
+        qToBigEndian<quint16>(quint16(op.src.y()), p); p += 2;
+    }
+    for (const RectJob& j : jobs) {
+        putRect(j.r, j.codec, j.data.size());
+        memcpy(p, j.data.constData(), size_t(j.data.size()));
+        p += j.data.size();
+    }
+
+    g_encFrames.fetchAndAddRelaxed(1);
+    g_encFrameBytes.fetchAndAddRelaxed(blob.size());
+    g_encFrameUs.fetchAndAddRelaxed(elapsedUs(t));
+    maybeLogStats();
+    return blob;
+}
+
+bool decodeDelta(const QByteArray& blob, QImage& back, QVector<QRect>* dirty)
+{
+    QElapsedTimer t; t.start();
+    if (back.format() != QImage::Format_RGB32 || blob.size() < 6) return false;
+
+    const uchar* p = reinterpret_cast<const uchar*>(blob.constData());
+    const uchar* const end = p + blob.size();
+    const quint32 magic = qFromBigEndian<quint32>(p);  p += 4;
+    if (magic != kMagicDS01 && magic != kMagicDS02) return false;
+    const bool hasCodec = (magic == kMagicDS02);
+    const int count = qFromBigEndian<quint16>(p);      p += 2;
+    if (count == 0) return true;
+
+    // 先顺序解析并校验全部矩形头（复制项当场执行），再并行解码像素矩形
+    const int hdr = hasCodec ? 13 : 12;
+    QVector<DecodeItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        DecodeItem it;
+        if (end - p < hdr) return false;
+        it.x = qFromBigEndian<quint16>(p);             p += 2;
+        it.y = qFromBigEndian<quint16>(p);             p += 2;
+        it.w = qFromBigEndian<quint16>(p);             p += 2;
+        it.h = qFromBigEndian<quint16>(p);             p += 2;
+        it.codec = hasCodec ? *p++ : quint8(RECT_ZLIB);
+        const quint32 len = qFromBigEndian<quint32>(p); p += 4;
+        if (len > quint32(end - p)) return false;
+        if (it.x + it.w > back.width() || it.y + it.h > back.height()) return false;
+        it.data = reinterpret_cast<const char*>(p);
+        it.len = int(len);
+        p += len;
+
+        if ((it.codec & CODEC_MASK) == RECT_COPY) {
+            // 复制只能出现在像素矩形之前
+            if (!items.isEmpty() || it.len != 4) return false;
+            const uchar* d = reinterpret_cast<const uchar*>(it.data);
+            const CopyOp op{ QRect(it.x, it.y, it.w, it.h),
+                             QPoint(qFromBigEndian<quint16>(d), qFromBigEndian<quint16>(d + 2)) };
+            if (!applyCopy(back, op)) return false;
+            if (dirty) dirty->push_back(op.dst);
+            continue;
+        }
+        items.push_back(it);
+        if (dirty) dirty->push_back(QRect(it.x, it.y, it.w, it.h));
+    }
+
+    // 并行写入前先完成分离，工作线程只通过裸指针写各自区域
+    // 矩形相交（不合规的 blob）时按 blob 顺序串行解码，结果确定且不存在并发写同一像素
+    uchar* base = back.bits();
+    const int bpl = back.bytesPerLine();
+    QAtomicInt failed{0};
+    auto decodeOne = [base, bpl, &failed](DecodeItem& it) {
+        QElapsedTimer tt; tt.start();
+        if (!decodeRect(it, base, bpl)) { failed.store(1); return; }
+        const quint8 c = it.codec & CODEC_MASK;
+        if (c < 4) {
+            g_codec[c].decRects.fetchAndAddRelaxed(1);
+            g_codec[c].decUs.fetchAndAddRelaxed(elapsedUs(tt));
+        }
+    };
+    if (items.size() > 1 && disjoint(items)) {
+        QtConcurrent::blockingMap(items, decodeOne);
+    } else {
+        for (DecodeItem& it : items) decodeOne(it);
+    }
+
+    g_decFrames.fetchAndAddRelaxed(1);
+    g_decFrameUs.fetchAndAddRelaxed(elapsedUs(t));
+    maybeLogStats();
+    return failed.loadAcquire() == 0;
+}
+
+QString statsSummary()
+{
+    auto avg = [](qint64 sum, qint64 n) { return n > 0 ? double(sum) / n : 0.0; };
+    QString s = QString("[SCODEC] enc frames=%1 avg=%2ms %3B | dec frames=%4 avg=%5ms")
+                    .arg(g_encFrames.loadAcquire())
+                    .arg(avg(g_encFrameUs.loadAcquire(), g_encFrames.loadAcquire()) / 1000.0, 0, 'f', 2)
+                    .arg(avg(g_encFrameBytes.loadAcquire(), g_encFrames.loadAcquire()), 0, 'f', 0)
+                    .arg(g_decFrames.loadAcquire())
+                    .arg(avg(g_decFrameUs.loadAcquire(), g_decFrames.loadAcquire()) / 1000.0, 0, 'f', 2);
+    s += QString(" | pred=%1 palette=%2 copyPx=%3")
+             .arg(g_predRects.loadAcquire()).arg(g_paletteRects.loadAcquire()).arg(g_copyPixels.loadAcquire());
+    static const char* names[4] = { "-", "zlib", "lz", "jpeg" };
+    for (int c = RECT_ZLIB; c <= RECT_JPEG; ++c) {
+        const CodecStats& cs = g_codec[c];
+        const qint64 n = cs.encRects.loadAcquire(), dn = cs.decRects.loadAcquire();
+        if (n == 0 && dn == 0) continue;
+        s += QString(" | %1 rects=%2 %3B/rect ratio=%4 enc=%5us dec=%6us")
+                 .arg(names[c]).arg(n)
+                 .arg(avg(cs.encBytes.loadAcquire(), n), 0, 'f', 0)
+                 .arg(cs.encBytes.loadAcquire() > 0 ? double(cs.encRaw.loadAcquire()) / cs.encBytes.loadAcquire() : 0.0, 0, 'f', 1)
+                 .arg(avg(cs.encUs.loadAcquire(), n), 0, 'f', 0)
+                 .arg(avg(cs.decUs.loadAcquire(), dn), 0, 'f', 0);
+    }
+    return s;
+}
+
+} // namespace ScreenCodec
@@ -0,0 +1,122 @@
+#include "screenrate.h"
+
+namespace {
+// 档位：缩放比例 × 帧率系数，自上而下代价递减
+struct Level { double scale; double fpsFactor; };
+const Level kLadder[ScreenRateControl::kLevels] = {
+    { 1.0,  1.0  },
+    { 1.0,  0.67 },
+    { 1.0,  0.5  },
+    { 0.75, 0.5  },
+    { 0.75, 0.34 },
+    { 0.5,  0.34 },
+    { 0.5,  0.2  }
+};
+} // namespace
+
+void ScreenRateControl::setCeiling(int fps, int quality)
+{
+    ceilFps_ = qBound(1, fps, 60);
+    ceilQuality_ = qMax(int(kMinQuality), quality);
+    // 用户改预设视为重新开始
+    level_ = 0;
+    quality_ = ceilQuality_;
+    goodStreak_ = 0;
+}
+
+void ScreenRateControl::onFrameSent(int bytes, qint64 pipelineMs)
+{
+    winBytes_ += bytes;
+    winPipeMs_ += qMax<qint64>(0, pipelineMs);
+    ++winFrames_;
+}
+
+void ScreenRateControl::onReceiverReport(const QString& receiver, int lossPermille, qint64 loopMs, qint64 nowMs)
+{
+    Report& r = reports_[receiver];
+    r.loss = lossPermille;
+    r.loopMs = loopMs;
+    r.atMs = nowMs;
+}
+
+bool ScreenRateControl::update(qint64 nowMs, int captured, int dropped)
+{
+    // CPU：流水线耗时逼近帧间隔，或采集/压缩阶段大量丢帧
+    const int intervalMs = 1000 / qMax(1, fps());
+    lastPipeMs_ = winFrames_ ? double(winPipeMs_) / winFrames_ : 0.0;
+    lastKbps_ = winBytes_ * 8.0 / 1000.0;
+    const bool dropping = captured > 0 && dropped * 5 > captured;
+    const bool cpuBusy = lastPipeMs_ > intervalMs * 0.8 || dropping;
+    const bool cpuGood = lastPipeMs_ < intervalMs * 0.5 && dropped == 0;
+    winBytes_ = winPipeMs_ = 0;
+    winFrames_ = 0;
+
+    // 网络：取仍在回报的接收端中最差者
+    int loss = 0;
+    qint64 loop = -1;
+    for (auto it = reports_.begin(); it != reports_.end(); ) {
+        if (nowMs - it->atMs > kReportTtlMs) { it = reports_.erase(it); continue; }
+        loss = qMax(loss, it->loss);
+        loop = qMax(loop, it->loopMs);
+        ++it;
+    }
+    const bool netBusy = loss > kMaxLossPermille || loop > kMaxLoopMs;
+    const bool netGood = loss <= kGoodLossPermille && loop <= kGoodLoopMs;
+    lastLoss_ = loss;
+    lastLoop_ = loop;
+    lastCpuBusy_ = cpuBusy;
+    lastNetBusy_ = netBusy;
+
+    const int oldLevel = level_, oldQuality = quality_;
+    if (cpuBusy || netBusy) {
+        goodStreak_ = 0;
+        if (nowMs - lastDownMs_ >= 1000) {
+            lastDownMs_ = nowMs;
+            level_ = qMin(level_ + 1, int(kLevels) - 1);
+            if (netBusy) quality_ = qMax(int(kMinQuality), quality_ - 5);
+        }
+    } else if (cpuGood && netGood) {
+        if (++goodStreak_ >= kUpAfterSec && nowMs - lastDownMs_ >= kUpAfterSec * 1000) {
+            goodStreak_ = 0;
+            if (level_ > 0) --level_;
+            else quality_ = qMin(ceilQuality_, quality_ + 5);
+        }
+    } else {
+        goodStreak_ = 0;
+    }
+    return level_ != oldLevel || quality_ != oldQuality;
+}
+
+double ScreenRateControl::scale() const
+{
+    return kLadder[level_].scale;
+}
+
+int ScreenRateControl::fps() const
+{
+    return qMax(1, qRound(ceilFps_ * kLadder[level_].fpsFactor));
+}
+
+int ScreenRateControl::keyIntervalMs(qint64 nowMs) const
+{
+    // 有接收端回报即说明对端会在失步时请求关键帧
+    for (const Report& r : reports_)
+        if (nowMs - r.atMs <= kReportTtlMs) return kKeyIntervalFeedbackMs;
+    return kKeyIntervalLegacyMs;
+}
+
+QJsonObject ScreenRateControl::stateJson() const
+{
+    return QJsonObject{
+        {"level",    level_},
+        {"scale",    scale()},
+        {"fpsTarget", fps()},
+        {"quality",  quality_},
+        {"kbps",     lastKbps_},
+        {"pipeMs",   lastPipeMs_},
+        {"loss",     lastLoss_},
+        {"loopMs",   double(lastLoop_)},
+        {"cpuBusy",  lastCpuBusy_},
+        {"netBusy",  lastNetBusy_}
+    };
+}
@@ -1,43 +1,104 @@
 #include "screenshare.h"
 #include "udpmedia.h"
 
+static inline qint64 elapsedUs(const QElapsedTimer& t) { return t.nsecsElapsed() / 1000; }
+
 ScreenShare::ScreenShare(ClientConn* conn, QObject* parent)
     : QObject(parent), conn_(conn)
 {
-    encoder_ = new KeyEncoder(baseQuality_);
-    encoder_->moveToThread(&worker_);
-    connect(&worker_, &QThread::finished, encoder_, &QObject::deleteLater);
-    connect(this, &ScreenShare::destroyed, &worker_, &QThread::quit);
-    connect(encoder_, &KeyEncoder::encoded, this, &ScreenShare::onEncodedKeyframe, Qt::QueuedConnection);
-    worker_.start(QThread::HighPriority);
+    qRegisterMetaType<QVector<QRect>>("QVector<QRect>");
+    qRegisterMetaType<QVector<ScreenCodec::CopyOp>>("QVector<ScreenCodec::CopyOp>");
+
+    diffStage_ = new ScreenDiffStage(&stats_, &diffBusy_, &encodeDepth_);
+    diffStage_->moveToThread(&diffThread_);
+    connect(&diffThread_, &QThread::finished, diffStage_, &QObject::deleteLater);
+
+    encodeStage_ = new ScreenEncodeStage(&stats_, &encodeDepth_, baseQuality_);
+    encodeStage_->moveToThread(&encodeThread_);
+    connect(&encodeThread_, &QThread::finished, encodeStage_, &QObject::deleteLater);
+
+    // 比对 -> 压缩：工作线程之间直接排队；压缩 -> 发送：回到本对象线程
+    connect(diffStage_, &ScreenDiffStage::encodeDelta, encodeStage_, &ScreenEncodeStage::encodeDelta, Qt::QueuedConnection);
+    connect(diffStage_, &ScreenDiffStage::encodeKey,   encodeStage_, &ScreenEncodeStage::encodeKey,   Qt::QueuedConnection);
+    connect(diffStage_, &ScreenDiffStage::preview,     this, &ScreenShare::localFrameReady, Qt::QueuedConnection);
+    connect(encodeStage_, &ScreenEncodeStage::deltaReady, this, &ScreenShare::onDeltaReady, Qt::QueuedConnection);
+    connect(encodeStage_, &ScreenEncodeStage::keyReady,   this, &ScreenShare::onKeyReady,   Qt::QueuedConnection);
+
+    diffThread_.start(QThread::HighPriority);
+    encodeThread_.start(QThread::HighPriority);
 
     timer_.setSingleShot(true);
     connect(&timer_, &QTimer::timeout, this, &ScreenShare::onTick);
+    statsTimer_.setInterval(5000);
+    connect(&statsTimer_, &QTimer::timeout, this, &ScreenShare::onStatsTimer);
+    rateTimer_.setInterval(1000);
+    connect(&rateTimer_, &QTimer::timeout, this, &ScreenShare::onRateTimer);
+}
+
+ScreenShare::~ScreenShare()
+{
+    // 阶段对象持有本对象内计数器的指针，必须先停线程
+    diffThread_.quit();
+    encodeThread_.quit();
+    diffThread_.wait();
+    encodeThread_.wait();
 }
 
 void ScreenShare::setIdentity(const QString& roomId, const QString& sender) {
     roomId_ = roomId; sender_ = sender;
 }
 
+void ScreenShare::setUdpClient(UdpMediaClient* udp) {
+    if (udp_) disconnect(udp_, nullptr, this, nullptr);
+    udp_ = udp;
+    if (!udp_) return;
+    connect(udp_, &UdpMediaClient::receiverReport, this, &ScreenShare::onReceiverReport);
+    connect(udp_, &UdpMediaClient::keyframeRequested, this, &ScreenShare::onKeyframeRequested);
+}
+
 void ScreenShare::setParams(const QSize& sendBaseSize, int baseFps, int jpegQuality) {
-    QSize s = sendBaseSize.isValid() ? sendBaseSize : baseSendSize_;
-    baseSendSize_ = clampMin720p(s);              // 强制不低于 1280x720
-    intervalMs_   = qMax(5, 1000 / qMax(30, baseFps)); // 强制不低于 30fps
-    baseQuality_  = qBound(35, jpegQuality, 75);  // 关键帧质量下限 35，避免糊成一片
-    QMetaObject::invokeMethod(encoder_, [this]{ static_cast<KeyEncoder*>(encoder_)->setQuality(baseQuality_); }, Qt::QueuedConnection);
+    baseSendSize_ = sendBaseSize.isValid() ? sendBaseSize : baseSendSize_;
+    baseQuality_  = qBound(35, jpegQuality, 75);  // 上限质量；码率控制可降到 kMinQuality
+    rate_.setCeiling(baseFps, baseQuality_);
+    applyRate();
+}
+
+void ScreenShare::applyRate() {
+    intervalMs_ = qMax(5, 1000 / rate_.fps());
+    QMetaObject::invokeMethod(encodeStage_, "setQuality", Qt::QueuedConnection, Q_ARG(int, rate_.quality()));
+}
+
+QSize ScreenShare::targetSize() const {
+    const double k = rate_.scale();
+    // 偶数尺寸，缩放后保持纵横比由比对阶段处理
+    return QSize(qMax(2, int(baseSendSize_.width() * k) & ~1), qMax(2, int(baseSendSize_.height() * k) & ~1));
+}
+
+void ScreenShare::setDiffMode(BlockDiff::Mode m) {
+    QMetaObject::invokeMethod(diffStage_, "setDiffMode", Qt::QueuedConnection, Q_ARG(int, int(m)));
+}
+
+void ScreenShare::setRectCodec(ScreenCodec::Policy p) {
+    QMetaObject::invokeMethod(encodeStage_, "setPolicy", Qt::QueuedConnection, Q_ARG(int, int(p)));
 }
 
 void ScreenShare::setEnabled(bool on) {
     if (enabled_ == on) return;
     enabled_ = on;
+    QMetaObject::invokeMethod(diffStage_, "reset", Qt::QueuedConnection);
     if (enabled_) {
         sendControl("on");
         lastKeyMs_ = 0;
-        prevFrame_ = QImage();
+        statsClock_.start();
+        statsTimer_.start();
+        rateCounts_[0] = stats_.captured.loadAcquire();
+        rateCounts_[1] = stats_.dropCapture.loadAcquire() + stats_.dropEncode.loadAcquire();
+        rateTimer_.start();
         scheduleNext();
     } else {
         timer_.stop();
-        prevFrame_ = QImage();
+        statsTimer_.stop();
+        rateTimer_.stop();
         sendControl("off");
     }
 }
@@ -54,18 +115,6 @@ void ScreenShare::sendControl(const char* state) {
     conn_->send(MSG_CONTROL, j);
 }
 
-QSize ScreenShare::clampMin720p(const QSize& in) const {
-    QSize s = in.isValid() ? in : QSize(1280, 720);
-    int w = s.width(), h = s.height();
-    if (w < 1280 || h < 720) {
-        // 维持原纵横比，放大到最小 1280x720
-        double ar = w > 0 && h > 0 ? (double)w / h : (16.0/9.0);
-        if (ar >= 16.0/9.0) { w = 1280; h = int(w / ar); if (h < 720) { h = 720; w = int(h * ar); } }
-        else                { h = 720;  w = int(h * ar); if (w < 1280){ w = 1280; h = int(w / ar); } }
-    }
-    return QSize(w, h);
-}
-
 void ScreenShare::scheduleNext() {
     timer_.start(intervalMs_);
 }
@@ -73,138 +122,228 @@ void ScreenShare::scheduleNext() {
 void ScreenShare::onTick() {
     if (!enabled_) return;
 
-    // 抓取主屏并缩放到不低于 720p 的目标
+    // 比对阶段仍在处理上一帧：本次不采集（丢帧而不是排队，延迟不累积）
+    if (diffBusy_.loadAcquire() != 0) {
+        stats_.dropCapture.fetchAndAddRelaxed(1);
+        scheduleNext();
+        return;
+    }
+
     QScreen* scr = QGuiApplication::primaryScreen();
     if (!scr) { scheduleNext(); return; }
 
+    QElapsedTimer t; t.start();
     QPixmap pix = scr->grabWindow(0);
     if (pix.isNull()) { scheduleNext(); return; }
-
-    QSize target = clampMin720p(baseSendSize_);
-    QPixmap scaledPix = pix.scaled(target, Qt::KeepAspectRatio, Qt::FastTransformation);
-    QImage img = scaledPix.toImage().convertToFormat(QImage::Format_RGB32);
-    if (img.isNull()) { scheduleNext(); return; }
-
-    // 本地预览（720p 或更高）
-    emit localFrameReady(img);
+    QImage raw = pix.toImage();
+    stats_.captureUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_.captured.fetchAndAddRelaxed(1);
 
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
-    bool needKey = (now - lastKeyMs_ >= keyIntervalMs_) || prevFrame_.isNull();
-
-    if (!needKey && !prevFrame_.isNull()) {
-        // 尝试增量帧：按块比较，生成 DS01 blob
-        QByteArray blob = buildDeltaBlob(prevFrame_, img, /*block*/32);
-        if (!blob.isEmpty() && udp_) {
-            udp_->sendScreenDelta(blob, img.width(), img.height(), now);
-            prevFrame_ = img;
-            scheduleNext();
-            return;
-        }
-        // 变化过大或生成失败 -> 回退关键帧
-        needKey = true;
-    }
+    // 接收端请求优先；周期关键帧只作兜底（有回报时间隔放长）
+    const bool forceKey = keyRequested_ || (now - lastKeyMs_ >= rate_.keyIntervalMs(now));
+    if (forceKey) { lastKeyMs_ = now; keyRequested_ = false; }
 
-    // 发关键帧（JPEG），编码异步
-    if (udp_ && keyBusy_.loadAcquire() == 0) {
-        keyBusy_.storeRelease(1);
-        QMetaObject::invokeMethod(encoder_, "encode", Qt::QueuedConnection, Q_ARG(QImage, img));
-        prevFrame_ = img; // 同步更新参考帧
-    }
+    diffBusy_.storeRelease(1);
+    QMetaObject::invokeMethod(diffStage_, "process", Qt::QueuedConnection,
+                              Q_ARG(QImage, raw), Q_ARG(QSize, targetSize()),
+                              Q_ARG(bool, forceKey), Q_ARG(qint64, now));
     scheduleNext();
 }
 
-void ScreenShare::onEncodedKeyframe(QByteArray jpeg, QSize wh, qint64 /*encodeMs*/) {
-    keyBusy_.storeRelease(0);
+void ScreenShare::onDeltaReady(QByteArray blob, QSize wh, qint64 captureMs) {
+    if (!enabled_ || !udp_ || blob.isEmpty()) return;
+    QElapsedTimer t; t.start();
+    udp_->sendScreenDelta(blob, wh.width(), wh.height(), captureMs);
+    stats_.sendUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_.sent.fetchAndAddRelaxed(1);
+    rate_.onFrameSent(blob.size(), QDateTime::currentMSecsSinceEpoch() - captureMs);
+}
+
+void ScreenShare::onKeyReady(QByteArray jpeg, QSize wh, qint64 captureMs) {
+    if (!enabled_ || !udp_ || jpeg.isEmpty()) return;
+    QElapsedTimer t; t.start();
+    udp_->sendScreenJpeg(jpeg, wh.width(), wh.height(), captureMs);
+    stats_.sendUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_.sent.fetchAndAddRelaxed(1);
+    lastKeyMs_ = QDateTime::currentMSecsSinceEpoch();
+    rate_.onFrameSent(jpeg.size(), lastKeyMs_ - captureMs);
+}
+
+void ScreenShare::onReceiverReport(const QString& receiver, int lossPermille, double, qint64 loopMs) {
+    if (!enabled_) return;
+    rate_.onReceiverReport(receiver, lossPermille, loopMs, QDateTime::currentMSecsSinceEpoch());
+}
+
+void ScreenShare::onKeyframeRequested(const QString&) {
     if (!enabled_) return;
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
-    if (udp_ && !jpeg.isEmpty()) {
-        udp_->sendScreenJpeg(jpeg, wh.width(), wh.height(), now);
-        lastKeyMs_ = now;
-    }
+    if (now - lastKeyReqMs_ < kKeyReqMinMs) return;
+    lastKeyReqMs_ = now;
+    keyRequested_ = true;
 }
 
-// DS01 blob：BigEndian
-// u32 magic='DS01', u16 rectCount,
-// [rectLoop] u16 x, u16 y, u16 w, u16 h, u32 compLen, [compData...]
-// compData 是 QImage::Format_RGB32 的原始像素区域逐行拼接后 qCompress 得到
-QByteArray ScreenShare::buildDeltaBlob(const QImage& prev, const QImage& curr, int block) const
-{
-    if (prev.size() != curr.size()) return QByteArray();
+void ScreenShare::onRateTimer() {
+    const int captured = stats_.captured.loadAcquire();
+    const int dropped = stats_.dropCapture.loadAcquire() + stats_.dropEncode.loadAcquire();
+    const bool changed = rate_.update(QDateTime::currentMSecsSinceEpoch(),
+                                      captured - rateCounts_[0], dropped - rateCounts_[1]);
+    rateCounts_[0] = captured;
+    rateCounts_[1] = dropped;
+    if (!changed) return;
+    applyRate();
+    const QSize sz = targetSize();
+    const QJsonObject st = rate_.stateJson();
+    qInfo().noquote() << QString("[SCREEN] rate level=%1 %2x%3@%4fps q=%5 (pipe=%6ms loss=%7‰ loop=%8ms)")
+                         .arg(rate_.level()).arg(sz.width()).arg(sz.height()).arg(rate_.fps())
+                         .arg(rate_.quality()).arg(st["pipeMs"].toDouble(), 0, 'f', 1)
+                         .arg(st["loss"].toInt()).arg(st["loopMs"].toDouble());
+}
 
-    const int W = curr.width(), H = curr.height();
-    const int bw = qMax(8, block), bh = qMax(8, block);
-    const int bx = (W + bw - 1) / bw;
-    const int by = (H + bh - 1) / bh;
+void ScreenShare::onStatsTimer() {
+    const int counts[7] = {
+        stats_.captured.loadAcquire(), stats_.diffed.loadAcquire(), stats_.encoded.loadAcquire(),
+        stats_.sent.loadAcquire(), stats_.keyframes.loadAcquire(),
+        stats_.dropCapture.loadAcquire(), stats_.dropEncode.loadAcquire()
+    };
+    const qint64 us[5] = {
+        stats_.captureUs.loadAcquire(), stats_.prepUs.loadAcquire(), stats_.diffUs.loadAcquire(),
+        stats_.encodeUs.loadAcquire(), stats_.sendUs.loadAcquire()
+    };
+    const qint64 windowMs = qMax<qint64>(1, statsClock_.restart());
+    auto avgMs = [&](int stage, int countIdx) {
+        const int n = counts[countIdx] - lastCounts_[countIdx];
+        return n > 0 ? double(us[stage] - lastUs_[stage]) / n / 1000.0 : 0.0;
+    };
+    // 比对阶段一次处理含缩放与比对两部分，均按已比对帧数平均
+    QJsonObject j{
+        {"captureMs", avgMs(0, 0)},
+        {"prepMs",    avgMs(1, 1)},
+        {"diffMs",    avgMs(2, 1)},
+        {"encodeMs",  avgMs(3, 2)},
+        {"sendMs",    avgMs(4, 3)},
+        {"fps",       (counts[3] - lastCounts_[3]) * 1000.0 / windowMs},
+        {"keyframes", counts[4] - lastCounts_[4]},
+        {"dropCapture", counts[5] - lastCounts_[5]},
+        {"dropEncode",  counts[6] - lastCounts_[6]},
+        {"rate",        rate_.stateJson()}
+    };
+    std::copy(counts, counts + 7, lastCounts_);
+    std::copy(us, us + 5, lastUs_);
+    lastTimings_ = j;
 
-    QVector<QRect> rects;
-    rects.reserve(bx * by / 4);
-
-    // 粗粒度：逐块比较是否有变化（memcmp 快速判定）
-    for (int gy = 0; gy < by; ++gy) {
-        for (int gx = 0; gx < bx; ++gx) {
-            int x = gx * bw;
-            int y = gy * bh;
-            int w = qMin(bw, W - x);
-            int h = qMin(bh, H - y);
-            bool diff = false;
-            for (int row = 0; row < h; ++row) {
-                const uchar* p0 = prev.constScanLine(y + row) + x * 4;
-                const uchar* p1 = curr.constScanLine(y + row) + x * 4;
-                if (memcmp(p0, p1, w * 4) != 0) { diff = true; break; }
-            }
-            if (diff) rects.push_back(QRect(x, y, w, h));
-        }
+    qInfo().noquote() << QString("[SCREEN] cap=%1ms prep=%2ms diff=%3ms enc=%4ms send=%5ms fps=%6 key=%7 drop=%8/%9")
+                         .arg(j["captureMs"].toDouble(), 0, 'f', 1).arg(j["prepMs"].toDouble(), 0, 'f', 1)
+                         .arg(j["diffMs"].toDouble(), 0, 'f', 1).arg(j["encodeMs"].toDouble(), 0, 'f', 1)
+                         .arg(j["sendMs"].toDouble(), 0, 'f', 1).arg(j["fps"].toDouble(), 0, 'f', 1)
+                         .arg(j["keyframes"].toInt()).arg(j["dropCapture"].toInt()).arg(j["dropEncode"].toInt());
+    emit stageTimingsUpdated(j);
+}
+
+// ---------------- 缩放/比对阶段 ----------------
+
+void ScreenDiffStage::process(QImage raw, QSize target, bool forceKey, qint64 captureMs) {
+    QElapsedTimer t; t.start();
+    // 缩放到码率控制给出的目标尺寸
+    QImage img = raw.scaled(target, Qt::KeepAspectRatio, Qt::FastTransformation)
+                    .convertToFormat(QImage::Format_RGB32);
+    stats_->prepUs.fetchAndAddRelaxed(elapsedUs(t));
+    if (img.isNull()) { busy_->storeRelease(0); return; }
+
+    // 本地预览
+    emit preview(img);
+
+    // 压缩队列已满：丢弃本帧且不推进参考帧
+    if (encodeDepth_->loadAcquire() >= kMaxEncodeQueue) {
+        stats_->dropEncode.fetchAndAddRelaxed(1);
+        busy_->storeRelease(0);
+        return;
     }
 
-    if (rects.isEmpty()) {
-        // 无变化：发一个极小的“空增量”，由接收端略过
-        QByteArray blob;
-        QDataStream ds(&blob, QIODevice::WriteOnly);
-        ds.setByteOrder(QDataStream::BigEndian);
-        ds << (quint32)0x44533031 /*'DS01'*/ << (quint16)0;
-        return blob;
+    t.restart();
+    QVector<QRect> rects;
+    QVector<ScreenCodec::CopyOp> copies;
+    bool key = forceKey || prev_.isNull() || prev_.size() != img.size();
+    if (!key)
+        key = !collectRects(img, rects, copies);          // 变化过大 -> 回退关键帧
+    else if (diff_.mode() == BlockDiff::Hash)
+        diff_.detect(QImage(), img, kBlock, dirty_);      // 关键帧同样要以本帧刷新块哈希
+    stats_->diffUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_->diffed.fetchAndAddRelaxed(1);
+
+    // 交给压缩阶段的帧一定会发出，参考帧随之前移
+    prev_ = img;
+    encodeDepth_->fetchAndAddOrdered(1);
+    if (key) emit encodeKey(img, captureMs);
+    else     emit encodeDelta(img, rects, copies, captureMs);
+    busy_->storeRelease(0);
+}
+
+// 按块比较得到变化矩形（同一行相邻块合并），超过 kMaxRects 返回 false
+// 大面积变化时先做平移检测：参考帧经区域复制后重新比对，仅剩余变化块编码，
+// 滚动不再因超过 kMaxRects 退化为关键帧
+bool ScreenDiffStage::collectRects(const QImage& curr, QVector<QRect>& out, QVector<ScreenCodec::CopyOp>& copies) {
+    const int W = curr.width(), H = curr.height();
+    const int bs = kBlock;
+    const int bx = (W + bs - 1) / bs;
+
+    // 整帧变化位图（SIMD 行比较 / 块哈希）
+    int changed = diff_.detect(prev_, curr, bs, dirty_);
+
+    copies.clear();
+    QVector<ScreenCodec::CopyOp> ops;
+    if (changed >= kMotionMinBlocks && motion_.find(prev_, curr, dirty_, bs, ops)) {
+        QImage pred = prev_;
+        for (const ScreenCodec::CopyOp& op : ops) ScreenCodec::applyCopy(pred, op);
+        const QVector<quint8> before = dirty_;
+        const int after = diff_.detectAgainst(pred, curr, bs, dirty_);
+        if (after < changed) { copies = ops; changed = after; }
+        else dirty_ = before;
     }
 
-    // 简单合并：把同一行相邻块合并成长条（降低 rect 数）
-    std::sort(rects.begin(), rects.end(), [](const QRect& a, const QRect& b){
-        if (a.y() == b.y()) return a.x() < b.x();
-        return a.y() < b.y();
-    });
-    QVector<QRect> merged;
-    for (const QRect& r : rects) {
-        if (!merged.isEmpty()) {
-            QRect& last = merged.last();
+    // 位图为行主序，直接按行合并相邻块成长条（降低 rect 数）
+    out.clear();
+    out.reserve(qMin(changed, int(kMaxRects) + 1));
+    for (int i = 0; i < dirty_.size(); ++i) {
+        if (!dirty_[i]) continue;
+        const int x = (i % bx) * bs;
+        const int y = (i / bx) * bs;
+        const QRect r(x, y, qMin(bs, W - x), qMin(bs, H - y));
+        if (!out.isEmpty()) {
+            QRect& last = out.last();
             if (last.y() == r.y() && last.height() == r.height() && last.right()+1 >= r.x()-1) {
                 last.setRight(qMax(last.right(), r.right()));
                 continue;
             }
         }
-        merged.push_back(r);
+        if (out.size() >= kMaxRects) return false;
+        out.push_back(r);
     }
+    return true;
+}
 
-    // 限制最大 rect 数量，超出则返回空（触发关键帧）
-    const int maxRects = 120;
-    if (merged.size() > maxRects) return QByteArray();
-
-    // 打包 DS01
-    QByteArray blob;
-    blob.reserve(merged.size() * 128);
-    QDataStream ds(&blob, QIODevice::WriteOnly);
-    ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint32)0x44533031 /*'DS01'*/ << (quint16)merged.size();
-
-    for (const QRect& r : merged) {
-        // 提取原始像素（逐行拼接）
-        QByteArray raw;
-        raw.reserve(r.width() * r.height() * 4);
-        for (int row = 0; row < r.height(); ++row) {
-            const uchar* src = curr.constScanLine(r.y() + row) + r.x() * 4;
-            raw.append(reinterpret_cast<const char*>(src), r.width() * 4);
-        }
-        QByteArray comp = qCompress(raw, 6); // 压缩等级 1..9，6 性能/比率折中
-        ds << (quint16)r.x() << (quint16)r.y() << (quint16)r.width() << (quint16)r.height();
-        ds << (quint32)comp.size();
-        ds.writeRawData(comp.constData(), comp.size());
-    }
-    return blob;
+// ---------------- 压缩阶段 ----------------
+
+void ScreenEncodeStage::encodeDelta(QImage img, QVector<QRect> rects, QVector<ScreenCodec::CopyOp> copies, qint64 captureMs) {
+    QElapsedTimer t; t.start();
+    const QByteArray blob = ScreenCodec::encodeDelta(img, rects, copies, mirror_, policy_, quality_);
+    stats_->encodeUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_->encoded.fetchAndAddRelaxed(1);
+    encodeDepth_->fetchAndSubOrdered(1);
+    emit deltaReady(blob, img.size(), captureMs);
+}
+
+void ScreenEncodeStage::encodeKey(QImage img, qint64 captureMs) {
+    QElapsedTimer t; t.start();
+    // 输出缓冲跨帧复用；上一帧若仍在发送路径上被引用，写入时才分离
+    jpeg_.encode(img, quality_, keyBuf_);
+    // 接收端背板即关键帧的解码结果；两端解码器可能不同，整帧标为有损，
+    // 之后只有被无损矩形覆盖过的区域才用作差值预测
+    jpeg_.decode(keyBuf_, mirror_.img);
+    mirror_.markAll(true);
+    stats_->encodeUs.fetchAndAddRelaxed(elapsedUs(t));
+    stats_->encoded.fetchAndAddRelaxed(1);
+    stats_->keyframes.fetchAndAddRelaxed(1);
+    encodeDepth_->fetchAndSubOrdered(1);
+    emit keyReady(keyBuf_, img.size(), captureMs);
 }
@@ -0,0 +1,167 @@
+#include "tilecompositor.h"
+
+namespace {
+QRect fitRect(const QSize& img, const QRect& rect)
+{
+    QSize fitted = img;
+    fitted.scale(rect.size(), Qt::KeepAspectRatio);
+    return QRect(QPoint(rect.x() + (rect.width() - fitted.width()) / 2,
+                        rect.y() + (rect.height() - fitted.height()) / 2), fitted);
+}
+
+// 源图在 dst 中对应的子区域（按缩放比例反算，可为小数）
+QRectF sourceOf(const QRect& d, const QImage& src, const QRect& dst)
+{
+    const double sx = double(src.width()) / dst.width(), sy = double(src.height()) / dst.height();
+    return QRectF((d.x() - dst.x()) * sx, (d.y() - dst.y()) * sy, d.width() * sx, d.height() * sy);
+}
+
+// 把 src 缩放画到 dst；dirty 非空时只重画这些源矩形映射到的区域（各向外扩 1 像素覆盖插值邻域）。
+// 局部与整幅使用同一变换，重画结果与整幅一致。返回重画的目标矩形
+QVector<QRect> drawScaled(QPainter& p, const QImage& src, const QRect& dst, const QVector<QRect>* dirty)
+{
+    if (!dirty) {
+        p.drawImage(dst, src);
+        return { dst };
+    }
+    const double sx = double(dst.width()) / src.width(), sy = double(dst.height()) / src.height();
+    QVector<QRect> out;
+    out.reserve(dirty->size());
+    for (const QRect& r : *dirty) {
+        const int x0 = qFloor(r.x() * sx) - 1, y0 = qFloor(r.y() * sy) - 1;
+        const int x1 = qCeil((r.x() + r.width()) * sx) + 1, y1 = qCeil((r.y() + r.height()) * sy) + 1;
+        const QRect d = QRect(dst.x() + x0, dst.y() + y0, x1 - x0, y1 - y0) & dst;
+        if (d.isEmpty()) continue;
+        p.drawImage(QRectF(d), src, sourceOf(d, src, dst));
+        out.push_back(d);
+    }
+    return out;
+}
+
+// 把 src 中 rects 覆盖的区域复制到 dst（两者同尺寸）
+void copyRects(QImage& dst, const QImage& src, const QVector<QRect>& rects)
+{
+    for (const QRect& r0 : rects) {
+        const QRect r = r0 & dst.rect();
+        if (r.isEmpty()) continue;
+        for (int y = r.top(); y <= r.bottom(); ++y)
+            memcpy(dst.scanLine(y) + r.x() * 4, src.constScanLine(y) + r.x() * 4, size_t(r.width()) * 4);
+    }
+}
+} // namespace
+
+void TileCompositor::markScreenDirty(const QVector<QRect>& rects)
+{
+    if (screenFull_) return;
+    if (rects.isEmpty() || screenDirty_.size() + rects.size() > kMaxDirtyRects) {
+        screenFull_ = true;
+        screenDirty_.clear();
+        return;
+    }
+    screenDirty_ += rects;
+}
+
+QImage TileCompositor::compose(const QImage& cam, const QImage& screen, bool camPrimary, const QSize& target)
+{
+    const bool hasCam = !cam.isNull(), hasScreen = !screen.isNull();
+    if ((!hasCam && !hasScreen) || target.width() < 2 || target.height() < 2) {
+        target_ = QSize();   // 下次有图时整幅重画
+        screenFull_ = true;
+        screenDirty_.clear();
+        return QImage();
+    }
+
+    const bool pip = hasCam && hasScreen;
+    const bool bigIsScreen = pip ? !camPrimary : hasScreen;
+    const QImage& big = bigIsScreen ? screen : cam;
+    const QImage* small = pip ? (bigIsScreen ? &cam : &screen) : nullptr;
+    const QSize smallSize = small ? small->size() : QSize();
+
+    const bool relayout = target != target_ || pip != pip_ || bigIsScreen != bigIsScreen_
+                       || big.size() != bigSize_ || smallSize != smallSize_;
+    if (relayout) {
+        target_ = target;
+        pip_ = pip;
+        bigIsScreen_ = bigIsScreen;
+        bigSize_ = big.size();
+        smallSize_ = smallSize;
+        bigRect_ = fitRect(big.size(), QRect(QPoint(0, 0), target));
+        if (pip) {
+            const int margin = 8;
+            int smallW = qMax(80, target.width() * 28 / 100);
+            int smallH = smallW * smallSize.height() / qMax(1, smallSize.width());
+            if (smallH > target.height() * 40 / 100) {
+                smallH = target.height() * 40 / 100;
+                smallW = smallH * smallSize.width() / qMax(1, smallSize.height());
+            }
+            smallRect_ = QRect(target.width() - margin - smallW, margin, smallW, smallH);
+            smallFit_ = fitRect(smallSize, smallRect_);
+            panelRect_ = smallRect_.adjusted(-2, -2, 2, 2);
+        }
+    }
+
+    // 画在另一块画布上：非整幅重画时先用上一帧补齐其上次改写的区域
+    const int cur = 1 - front_;
+    QImage& canvas = canvas_[cur];
+    const QImage& prev = canvas_[front_];
+    if (canvas.size() != target) canvas = QImage(target, QImage::Format_RGB32);
+    if (canvas.isNull()) return QImage();
+    if (!relayout) {
+        if (lastFull_ || prev.size() != target) copyRects(canvas, prev, { canvas.rect() });
+        else copyRects(canvas, prev, lastDrawn_);
+    }
+    QVector<QRect> drawnNow;
+    QPainter p(&canvas);
+    p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform, true);
+
+    // 屏幕层可用脏矩形时局部重画
+    const bool screenPartial = !relayout && !screenFull_ && !screenDirty_.isEmpty();
+    bool panelDirty = relayout;
+
+    // 大图层：直接画在画布上
+    if (relayout) {
+        p.fillRect(canvas.rect(), Qt::black);
+        drawScaled(p, big, bigRect_, nullptr);
+    } else if (big.cacheKey() != bigKey_) {
+        drawnNow = drawScaled(p, big, bigRect_, bigIsScreen && screenPartial ? &screenDirty_ : nullptr);
+        for (const QRect& d : drawnNow)
+            if (pip && d.intersects(panelRect_)) { panelDirty = true; break; }
+    }
+    bigKey_ = big.cacheKey();
+
+    if (pip && !smallFit_.isEmpty()) {
+        // 小窗层：缩放结果单独缓存，大图局部更新压到小窗时直接重贴
+        if (relayout || small->cacheKey() != smallKey_) {
+            const bool partial = !relayout && !bigIsScreen && screenPartial
+                              && smallLayer_.size() == smallFit_.size();
+            if (smallLayer_.size() != smallFit_.size()) smallLayer_ = QImage(smallFit_.size(), QImage::Format_RGB32);
+            QPainter sp(&smallLayer_);
+            sp.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform, true);
+            drawScaled(sp, *small, smallLayer_.rect(), partial ? &screenDirty_ : nullptr);
+            sp.end();
+            smallKey_ = small->cacheKey();
+            panelDirty = true;
+        }
+        if (panelDirty) {
+            if (!relayout) {
+                // 半透明底板需要先恢复其下方的大图
+                p.fillRect(panelRect_, Qt::black);
+                const QRect under = panelRect_ & bigRect_;
+                if (!under.isEmpty()) p.drawImage(QRectF(under), big, sourceOf(under, big, bigRect_));
+            }
+            p.fillRect(panelRect_, QColor(0, 0, 0, 160));
+            p.setPen(QPen(Qt::white, 2));
+            p.drawRect(smallRect_);
+            p.drawImage(smallFit_.topLeft(), smallLayer_);
+            drawnNow.push_back(panelRect_);
+        }
+    }
+    p.end();
+
+    screenDirty_.clear();
+    screenFull_ = false;
+    lastFull_ = relayout;
+    lastDrawn_ = drawnNow;
+    front_ = cur;
+    return canvas;
+}
@@ -1,6 +1,21 @@
 #include "udpmedia.h"
 #include <QtGlobal>   // 为 qMin 提供声明
 
+namespace {
+// dst ^= src（按 8 字节块处理，尾部逐字节）
+void xorInto(char* dst, const char* src, int len) {
+    int i = 0;
+    for (; i + 8 <= len; i += 8) {
+        quint64 a, b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < len; ++i) dst[i] ^= src[i];
+}
+} // namespace
+
 UdpMediaClient::UdpMediaClient(QObject* parent) : QObject(parent)
 {
     connect(&sock_, &QUdpSocket::readyRead, this, &UdpMediaClient::onReadyRead);
@@ -8,6 +23,8 @@ UdpMediaClient::UdpMediaClient(QObject* parent) : QObject(parent)
     connect(&heartbeat_, &QTimer::timeout, this, &UdpMediaClient::onHeartbeat);
     cleanup_.setInterval(1000);
     connect(&cleanup_, &QTimer::timeout, this, &UdpMediaClient::onCleanup);
+    nackTimer_.setInterval(20);
+    connect(&nackTimer_, &QTimer::timeout, this, &UdpMediaClient::onNackTimer);
 }
 
 void UdpMediaClient::configureServer(const QString& host, quint16 port) {
@@ -20,6 +37,10 @@ void UdpMediaClient::configureServer(const QString& host, quint16 port) {
 }
 
 void UdpMediaClient::setIdentity(const QString& roomId, const QString& user) {
+    if (roomId != roomId_ || user != user_) {
+        session_ = 0; // 身份变化：等待新的注册回执
+        roster_.clear();
+    }
     roomId_ = roomId;
     user_   = user;
 
@@ -37,7 +58,10 @@ void UdpMediaClient::setIdentity(const QString& roomId, const QString& user) {
 void UdpMediaClient::stop() {
     heartbeat_.stop();
     cleanup_.stop();
-    reassem_.clear();
+    nackTimer_.stop();
+    rings_.clear();
+    session_ = 0;
+    roster_.clear();
 }
 
 void UdpMediaClient::sendRegister() {
@@ -49,7 +73,8 @@ QByteArray UdpMediaClient::buildRegister(const QString& roomId, const QString& u
     QByteArray d;
     QDataStream ds(&d, QIODevice::WriteOnly);
     ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint32)kMagic << (quint8)2 /*ver*/ << (quint8)1 /*type*/ << (quint16)0;
+    // 注册仍用 v2 头：旧中继可识别；新中继以 UDM_ROSTER 回执分配会话 id
+    ds << (quint32)kUdmMagic << (quint8)UDM_V2 << (quint8)UDM_REGISTER << (quint16)0;
     ds << roomId << user;
     return d;
 }
@@ -62,7 +87,7 @@ QByteArray UdpMediaClient::buildVideoChunk(const QString& roomId, const QString&
     d.reserve(64 + len);
     QDataStream ds(&d, QIODevice::WriteOnly);
     ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint32)kMagic << (quint8)2 /*ver*/ << (quint8)2 /*type*/ << (quint16)0;
+    ds << (quint32)kUdmMagic << (quint8)UDM_V2 << (quint8)UDM_CHUNK << (quint16)0;
     ds << roomId << sender;
     ds << (quint32)frameId << (quint16)idx << (quint16)cnt;
     ds << (quint8)codec;
@@ -73,34 +98,73 @@ QByteArray UdpMediaClient::buildVideoChunk(const QString& roomId, const QString&
     return d;
 }
 
-void UdpMediaClient::sendScreenJpeg(const QByteArray& jpeg, int w, int h, qint64 tsMs) {
-    if (serverPort_ == 0 || roomId_.isEmpty() || user_.isEmpty() || jpeg.isEmpty()) return;
+QByteArray UdpMediaClient::buildVideoChunkV3(quint32 session,
+                                             quint32 frameId, quint16 idx, quint16 cnt,
+                                             quint8 codec, int w, int h, qint64 ts,
+                                             const char* payload, int len,
+                                             quint8 type) {
+    QByteArray d(kUdmChunkV3Size + len, Qt::Uninitialized);
+    UdmChunkV3 c;
+    c.session = session;
+    c.frameId = frameId;
+    c.idx = idx; c.cnt = cnt;
+    c.codec = codec;
+    c.w = quint16(w); c.h = quint16(h);
+    c.ts = quint64(ts);
+    c.len = quint32(len);
+    writeUdmChunkV3(reinterpret_cast<uchar*>(d.data()), c, type);
+    memcpy(d.data() + kUdmChunkV3Size, payload, size_t(len));
+    return d;
+}
+
+void UdpMediaClient::sendChunks(const QByteArray& blob, quint8 codec, int w, int h, qint64 ts) {
     const quint32 fid = ++frameSeq_;
-    const int total = int((jpeg.size() + kChunkPayload - 1) / kChunkPayload); // 都转成 int
-    const char* base = jpeg.constData();
+    const int total = int((blob.size() + kChunkPayload - 1) / kChunkPayload); // 都转成 int
+    const char* base = blob.constData();
+
+    // 校验分片负载：[u16 groupSize][u16 长度异或][异或数据]
+    const int group = session_ ? fecGroup_ : 0;
+    QByteArray parity;
+    int parityLen = 0;
+    quint16 lenXor = 0;
+    if (group > 0) parity = QByteArray(4 + kChunkPayload, '\0');
+
     for (int i = 0; i < total; ++i) {
         const int off = i * kChunkPayload;
-        const int remaining = int(jpeg.size()) - off;
+        const int remaining = int(blob.size()) - off;
         const int len = qMin<int>(kChunkPayload, remaining);      // 显式模板参数，避免类型不一致
-        QByteArray d = buildVideoChunk(roomId_, user_, fid, (quint16)i, (quint16)total,
-                                       (quint8)JPEG, w, h, tsMs, base + off, len);
+        const QByteArray d = session_
+            ? buildVideoChunkV3(session_, fid, (quint16)i, (quint16)total, codec, w, h, ts, base + off, len)
+            : buildVideoChunk(roomId_, user_, fid, (quint16)i, (quint16)total, codec, w, h, ts, base + off, len);
         sock_.writeDatagram(d, serverAddr_, serverPort_);
+
+        if (group == 0) continue;
+        xorInto(parity.data() + 4, base + off, len);
+        lenXor ^= quint16(len);
+        parityLen = qMax(parityLen, len);
+        if ((i + 1) % group == 0 || i == total - 1) {
+            uchar* p = reinterpret_cast<uchar*>(parity.data());
+            qToBigEndian<quint16>(quint16(group), p);
+            qToBigEndian<quint16>(lenXor, p + 2);
+            const QByteArray pd = buildVideoChunkV3(session_, fid, quint16(i / group), (quint16)total,
+                                                    codec, w, h, ts, parity.constData(), 4 + parityLen,
+                                                    UDM_PARITY);
+            sock_.writeDatagram(pd, serverAddr_, serverPort_);
+            parity.fill('\0');
+            parityLen = 0;
+            lenXor = 0;
+        }
     }
 }
 
+void UdpMediaClient::sendScreenJpeg(const QByteArray& jpeg, int w, int h, qint64 tsMs) {
+    if (serverPort_ == 0 || roomId_.isEmpty() || user_.isEmpty() || jpeg.isEmpty()) return;
+    sendChunks(jpeg, (quint8)JPEG, w, h, tsMs);
+}
+
 void UdpMediaClient::sendScreenDelta(const QByteArray& blob, int w, int h, qint64 tsMs) {
     if (serverPort_ == 0 || roomId_.isEmpty() || user_.isEmpty() || blob.isEmpty()) return;
-    const quint32 fid = ++frameSeq_;
-    const int total = int((blob.size() + kChunkPayload - 1) / kChunkPayload);
-    const char* base = blob.constData();
-    for (int i = 0; i < total; ++i) {
-        const int off = i * kChunkPayload;
-        const int remaining = int(blob.size()) - off;
-        const int len = qMin<int>(kChunkPayload, remaining);
-        QByteArray d = buildVideoChunk(roomId_, user_, fid, (quint16)i, (quint16)total,
-                                       (quint8)DELTA, w, h, tsMs, base + off, len);
-        sock_.writeDatagram(d, serverAddr_, serverPort_);
-    }
+    sendChunks(blob, (quint8)DELTA, w, h, tsMs);
 }
 
 void UdpMediaClient::onHeartbeat() {
@@ -110,70 +174,333 @@ void UdpMediaClient::onHeartbeat() {
 
 void UdpMediaClient::onCleanup() {
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
-    QStringList rm;
-    for (auto it = reassem_.begin(); it != reassem_.end(); ++it) {
-        if (now - it->startMs > 2000) rm << it.key();
+    for (auto it = rings_.begin(); it != rings_.end(); ) {
+        for (FrameSlot& fs : it->slots) {
+            if (fs.state == FrameSlot::Active && now - fs.startMs > 2000) {
+                fs.state = FrameSlot::Free;
+                noteLost(*it, 1);
+            }
+        }
+        // 长时间无数据的发送方整体释放
+        if (now - it->lastSeenMs > 30000) { it = rings_.erase(it); continue; }
+        if (it->session && now - it->lastSeenMs < 5000) {
+            sendFeedback(*it, 0, now);
+            it->framesDone = it->framesLost = 0;
+        }
+        ++it;
     }
-    for (const auto& k : rm) reassem_.remove(k);
+}
+
+void UdpMediaClient::requestKeyframe(const QString& sender) {
+    auto it = rings_.find(sender);
+    if (it == rings_.end() || !it->session) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - it->lastKeyReqMs < kKeyReqMinMs) return;
+    it->lastKeyReqMs = now;
+    sendFeedback(*it, UDM_FB_KEYFRAME, now);
+}
+
+// 帧不可恢复：背板已失步，计入丢帧并请求关键帧
+void UdpMediaClient::noteLost(SenderRing& ring, int frames) {
+    ring.framesLost += frames;
+    if (!ring.session) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - ring.lastKeyReqMs < kKeyReqMinMs) return;
+    ring.lastKeyReqMs = now;
+    sendFeedback(ring, UDM_FB_KEYFRAME, now);
+}
+
+void UdpMediaClient::sendFeedback(SenderRing& ring, quint8 flags, qint64 now) {
+    if (!session_ || serverPort_ == 0) return;
+    const int total = ring.framesDone + ring.framesLost;
+    const int loss = total > 0 ? ring.framesLost * 1000 / total : 0;
+    const qint64 windowMs = qMax<qint64>(1, cleanup_.interval());
+    const int fps10 = int(qMin<qint64>(0xFFFF, ring.framesDone * 10000LL / windowMs));
+    const int hold = ring.lastTs ? int(qBound<qint64>(0, now - ring.lastDoneMs, 0xFFFF)) : 0;
+
+    QByteArray d(kUdmFeedbackSize, Qt::Uninitialized);
+    uchar* p = reinterpret_cast<uchar*>(d.data());
+    writeUdmHeader(p, UDM_V3, UDM_FEEDBACK);   p += kUdmHeaderSize;
+    qToBigEndian<quint32>(session_, p);        p += 4;
+    qToBigEndian<quint32>(ring.session, p);    p += 4;
+    *p++ = flags;
+    qToBigEndian<quint16>(quint16(loss), p);   p += 2;
+    qToBigEndian<quint16>(quint16(fps10), p);  p += 2;
+    qToBigEndian<quint64>(ring.lastTs, p);     p += 8;
+    qToBigEndian<quint16>(quint16(hold), p);
+    sock_.writeDatagram(d, serverAddr_, serverPort_);
+}
+
+// 作为发送方：对端的接收报告
+void UdpMediaClient::parseFeedback(const uchar* d, int size) {
+    if (size < kUdmFeedbackSize) return;
+    d += kUdmHeaderSize;
+    const quint32 from = qFromBigEndian<quint32>(d);
+    if (qFromBigEndian<quint32>(d + 4) != session_) return;
+    const QString receiver = roster_.value(from);
+    if (receiver.isEmpty()) return;
+    const quint8 flags = d[8];
+    const int loss = qFromBigEndian<quint16>(d + 9);
+    const double fps = qFromBigEndian<quint16>(d + 11) / 10.0;
+    const quint64 ts = qFromBigEndian<quint64>(d + 13);
+    const int hold = qFromBigEndian<quint16>(d + 21);
+    const qint64 loopMs = ts ? qMax<qint64>(0, QDateTime::currentMSecsSinceEpoch() - qint64(ts) - hold) : -1;
+    if (flags & UDM_FB_KEYFRAME) emit keyframeRequested(receiver);
+    emit receiverReport(receiver, loss, fps, loopMs);
 }
 
 void UdpMediaClient::onReadyRead() {
     while (sock_.hasPendingDatagrams()) {
-        QByteArray d;
-        d.resize(int(sock_.pendingDatagramSize()));
-        QHostAddress from; quint16 port=0;
-        sock_.readDatagram(d.data(), d.size(), &from, &port);
-        parseDatagram(d, from, port);
+        const int size = int(sock_.pendingDatagramSize());
+        if (rxBuf_.size() < size) rxBuf_.resize(size);
+        const qint64 n = sock_.readDatagram(rxBuf_.data(), size);
+        if (n > 0) parseDatagram(rxBuf_.constData(), int(n));
     }
 }
 
-void UdpMediaClient::parseDatagram(const QByteArray& dgram, const QHostAddress&, quint16) {
-    QDataStream ds(dgram);
-    ds.setByteOrder(QDataStream::BigEndian);
-    quint32 magic=0; quint8 ver=0; quint8 type=0; quint16 reserved=0;
-    ds >> magic >> ver >> type >> reserved;
-    if (magic != kMagic || (ver != 1 && ver != 2)) return;
-
-    if (type == 2) {
-        QString room, sender;
-        quint32 fid=0; quint16 idx=0, cnt=0; quint16 w=0, h=0; quint64 ts=0; quint32 len=0;
-        quint8 codec = 0; // 默认 JPEG
+static inline bool testBit(const QVector<quint64>& bits, int i) {
+    return (bits[i >> 6] >> (i & 63)) & 1u;
+}
+static inline void setBit(QVector<quint64>& bits, int i) {
+    bits[i >> 6] |= quint64(1) << (i & 63);
+}
+
+void UdpMediaClient::parseDatagram(const char* dgram, int size) {
+    const uchar* raw = reinterpret_cast<const uchar*>(dgram);
+    quint8 ver=0; quint8 type=0;
+    if (!readUdmHeader(raw, size, ver, type)) return;
+
+    if (type == UDM_ROSTER) {
+        QDataStream ds(QByteArray::fromRawData(dgram, size));
+        ds.setByteOrder(QDataStream::BigEndian);
+        ds.skipRawData(kUdmHeaderSize);
+        quint32 yours=0; quint16 n=0;
+        ds >> yours >> n;
+        QHash<quint32, QString> roster;
+        for (int i = 0; i < n; ++i) {
+            quint32 id=0; QString u;
+            ds >> id >> u;
+            roster.insert(id, u);
+        }
+        if (ds.status() != QDataStream::Ok) return;
+        if (yours != 0) session_ = yours;
+        roster_ = roster;
+        return;
+    }
+    if (type == UDM_FEEDBACK && ver >= UDM_V3) {
+        parseFeedback(raw, size);
+        return;
+    }
+    const bool isParity = (type == UDM_PARITY && ver >= UDM_V3);
+    if (type != UDM_CHUNK && !isParity) return;
+
+    QString sender;
+    quint32 fid=0; quint16 idx=0, cnt=0; quint16 w=0, h=0; quint64 ts=0; quint32 len=0;
+    quint8 codec = 0; // 默认 JPEG
+    quint32 senderSession = 0;
+    const char* payload = nullptr;
+    if (ver >= UDM_V3) {
+        UdmChunkV3 c;
+        if (!readUdmChunkV3(raw, size, c)) return;
+        sender = roster_.value(c.session); // 中继只在房间内转发，无需再比对房间
+        if (sender.isEmpty()) return;      // 名单尚未同步，丢弃
+        fid = c.frameId; idx = c.idx; cnt = c.cnt; codec = c.codec;
+        w = c.w; h = c.h; ts = c.ts; len = c.len;
+        senderSession = c.session;
+        payload = dgram + kUdmChunkV3Size;
+    } else {
+        // v1/v2 带字符串头，走 QDataStream（仅兼容旧发送方）
+        const QByteArray view = QByteArray::fromRawData(dgram, size);
+        QDataStream ds(view);
+        ds.setByteOrder(QDataStream::BigEndian);
+        ds.skipRawData(kUdmHeaderSize);
+        QString room;
         ds >> room >> sender >> fid >> idx >> cnt;
-        if (ver >= 2) {
+        if (ver >= UDM_V2) {
             ds >> codec;
         }
         ds >> w >> h >> ts >> len;
         if (roomId_.isEmpty() || room != roomId_) return;
-        if (ds.status() != QDataStream::Ok || int(dgram.size()) < ds.device()->pos() + (qint64)len) return;
-
-        QByteArray payload;
-        payload.resize(int(len));
-        ds.readRawData(payload.data(), len);
-
-        const QString key = sender + '|' + QString::number(fid);
-        auto& as = reassem_[key];
-        if (as.startMs == 0) {
-            as.startMs = QDateTime::currentMSecsSinceEpoch();
-            as.codec = codec;
-            as.chunkCnt = cnt;
-            as.w = w; as.h = h; as.ts = (qint64)ts;
-            as.parts.resize(cnt);
-            as.received = 0;
-        }
-        if (idx < as.parts.size() && as.parts[int(idx)].isEmpty()) {
-            as.parts[int(idx)] = std::move(payload);
-            as.received++;
-        }
-        if (as.received == as.chunkCnt) {
-            QByteArray blob;
-            blob.reserve(int(as.chunkCnt) * 1000);
-            for (int i = 0; i < as.chunkCnt; ++i) blob.append(as.parts[i]);
-            if (as.codec == DELTA) {
-                emit udpScreenDeltaFrame(sender, blob, as.w, as.h, as.ts);
-            } else {
-                emit udpScreenFrame(sender, blob, as.w, as.h, as.ts);
-            }
-            reassem_.remove(key);
+        if (ds.status() != QDataStream::Ok || size < ds.device()->pos() + (qint64)len) return;
+        payload = dgram + ds.device()->pos();
+    }
+    if (cnt == 0 || cnt > kMaxChunks) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    SenderRing& ring = rings_[sender];
+    // 发送方重启（换了会话 id，或帧号回退超过环长且不是环内帧的补发）：按新流处理，
+    // 否则新流的帧都会被当作比槽中更旧的迟到分片丢弃
+    const bool restarted = (senderSession && ring.session && senderSession != ring.session) ||
+                           (ring.highestFid && qint32(fid - ring.highestFid) < -kRingSlots &&
+                            ring.slots[fid % kRingSlots].frameId != fid);
+    if (restarted) ring = SenderRing();
+    ring.lastSeenMs = now;
+    if (senderSession) ring.session = senderSession;
+    // 帧号跳变：中间的帧整帧丢失
+    if (ring.highestFid && qint32(fid - ring.highestFid) > 1)
+        noteLost(ring, qMin<int>(qint32(fid - ring.highestFid) - 1, 64));
+    if (!ring.highestFid || qint32(fid - ring.highestFid) > 0) ring.highestFid = fid;
+
+    const bool overwrite = ring.slots[fid % kRingSlots].state == FrameSlot::Active &&
+                           ring.slots[fid % kRingSlots].frameId != fid;
+    FrameSlot* fs = acquireSlot(ring, fid, cnt);
+    if (fs && overwrite) noteLost(ring, 1); // 未收齐的旧帧被新帧顶替
+    if (!fs) return;
+    if (fs->state == FrameSlot::Free) {
+        fs->state = FrameSlot::Active;
+        fs->codec = codec;
+        fs->w = w; fs->h = h; fs->ts = (qint64)ts;
+        fs->startMs = now;
+    }
+    fs->lastRecvMs = now;
+
+    if (isParity) {
+        if (len < 4) return;
+        const int g = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(payload));
+        storeParity(*fs, int(idx), g, payload + 2, int(len) - 2);
+    } else {
+        storeChunk(*fs, int(idx), payload, int(len));
+    }
+
+    if (fs->received == fs->chunkCnt) {
+        ring.framesDone++;
+        ring.lastTs = quint64(fs->ts);
+        ring.lastDoneMs = now;
+        deliver(sender, *fs);
+    } else if (ring.session && nackEnabled_ && session_ && !nackTimer_.isActive()) {
+        nackTimer_.start();
+    }
+}
+
+UdpMediaClient::FrameSlot* UdpMediaClient::acquireSlot(SenderRing& ring, quint32 frameId, int chunkCnt) {
+    FrameSlot& fs = ring.slots[frameId % kRingSlots];
+    if (fs.state != FrameSlot::Free && fs.frameId == frameId) {
+        if (fs.state == FrameSlot::Done) return nullptr;       // 已交付帧的迟到/重复分片
+        return fs.chunkCnt == chunkCnt ? &fs : nullptr;        // 与已收分片不一致，丢弃
+    }
+    // 槽位被更早的帧占用时由新帧覆盖（旧帧未完成即放弃）；比槽中更旧的迟到分片直接丢弃
+    if (fs.state != FrameSlot::Free && qint32(frameId - fs.frameId) < 0) return nullptr;
+
+    fs.state = FrameSlot::Free;
+    fs.frameId = frameId;
+    fs.chunkCnt = chunkCnt;
+    fs.received = 0;
+    fs.lastLen = -1;
+    fs.nackRounds = 0;
+    fs.fecGroup = 0;
+    fs.frame.resize(chunkCnt * kChunkPayload); // 容量足够且未被共享时不重新分配
+    fs.got.fill(0, (chunkCnt + 63) / 64);
+    return &fs;
+}
+
+void UdpMediaClient::storeChunk(FrameSlot& fs, int idx, const char* payload, int len) {
+    if (idx >= fs.chunkCnt || testBit(fs.got, idx)) return;
+    const bool last = (idx == fs.chunkCnt - 1);
+    // 除末片外所有分片都是满长，按 idx * kChunkPayload 定位
+    if (last ? (len <= 0 || len > kChunkPayload) : len != kChunkPayload) return;
+    memcpy(fs.frame.data() + idx * kChunkPayload, payload, size_t(len));
+    setBit(fs.got, idx);
+    if (last) fs.lastLen = len;
+    fs.received++;
+    if (fs.fecGroup) tryRecover(fs, idx / fs.fecGroup);
+}
+
+void UdpMediaClient::storeParity(FrameSlot& fs, int group, int groupSize, const char* payload, int len) {
+    if (groupSize <= 0 || len < 2 || len > 2 + kChunkPayload) return;
+    if (fs.fecGroup && fs.fecGroup != groupSize) return;
+    if (fs.fecGroup == 0) {
+        fs.fecGroup = groupSize;
+        const int groups = (fs.chunkCnt + groupSize - 1) / groupSize;
+        fs.parity.resize(groups * (2 + kChunkPayload));
+        fs.gotParity.fill(0, (groups + 63) / 64);
+    }
+    if (group >= (fs.chunkCnt + groupSize - 1) / groupSize || testBit(fs.gotParity, group)) return;
+    char* dst = fs.parity.data() + group * (2 + kChunkPayload);
+    memcpy(dst, payload, size_t(len));
+    memset(dst + len, 0, size_t(2 + kChunkPayload - len));
+    setBit(fs.gotParity, group);
+    tryRecover(fs, group);
+}
+
+void UdpMediaClient::tryRecover(FrameSlot& fs, int group) {
+    if (!testBit(fs.gotParity, group)) return;
+    const int first = group * fs.fecGroup;
+    const int last  = qMin(first + fs.fecGroup, fs.chunkCnt);
+    int missing = -1;
+    for (int i = first; i < last; ++i) {
+        if (testBit(fs.got, i)) continue;
+        if (missing >= 0) return; // 组内丢失超过 1 片，无法恢复
+        missing = i;
+    }
+    if (missing < 0) return;
+
+    // 校验数据先拷到缺失位置，再逐片异或，原地得到缺失分片
+    const char* p = fs.parity.constData() + group * (2 + kChunkPayload);
+    quint16 len = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(p));
+    char* dst = fs.frame.data() + missing * kChunkPayload;
+    memcpy(dst, p + 2, size_t(kChunkPayload));
+    for (int i = first; i < last; ++i) {
+        if (i == missing) continue;
+        const int li = (i == fs.chunkCnt - 1) ? fs.lastLen : kChunkPayload;
+        xorInto(dst, fs.frame.constData() + i * kChunkPayload, li);
+        len ^= quint16(li);
+    }
+    const bool isLast = (missing == fs.chunkCnt - 1);
+    if (isLast ? (len == 0 || len > kChunkPayload) : len != kChunkPayload) return;
+    setBit(fs.got, missing);
+    if (isLast) fs.lastLen = len;
+    fs.received++;
+    ++fecRecovered_;
+}
+
+void UdpMediaClient::deliver(const QString& sender, FrameSlot& fs) {
+    fs.frame.resize((fs.chunkCnt - 1) * kChunkPayload + fs.lastLen);
+    fs.state = FrameSlot::Done;
+    // 直接交付槽内缓冲（隐式共享）；下一次复用该槽时若仍被持有才会分离
+    if (fs.codec == DELTA) {
+        emit udpScreenDeltaFrame(sender, fs.frame, fs.w, fs.h, fs.ts);
+    } else {
+        emit udpScreenFrame(sender, fs.frame, fs.w, fs.h, fs.ts);
+    }
+}
+
+void UdpMediaClient::onNackTimer() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool pending = false;
+    QVector<quint16> missing;
+    missing.reserve(kUdmMaxNackIdx);
+    for (auto it = rings_.begin(); it != rings_.end(); ++it) {
+        if (!it->session) continue;
+        for (FrameSlot& fs : it->slots) {
+            if (fs.state != FrameSlot::Active) continue;
+            if (fs.nackRounds >= kMaxNackRounds || now - fs.startMs > kNackWindowMs) continue;
+            pending = true;
+            if (now - fs.lastRecvMs < kNackDelayMs) continue; // 分片仍在到达，或刚补发过
+
+            missing.clear();
+            for (int i = 0; i < fs.chunkCnt && missing.size() < kUdmMaxNackIdx; ++i)
+                if (!testBit(fs.got, i)) missing.push_back(quint16(i));
+            if (missing.isEmpty()) continue;
+            sendNack(it->session, fs.frameId, missing);
+            fs.nackRounds++;
+            fs.lastRecvMs = now;
         }
     }
+    if (!pending) nackTimer_.stop();
+}
+
+void UdpMediaClient::sendNack(quint32 senderSession, quint32 frameId, const QVector<quint16>& missing) {
+    if (!session_ || serverPort_ == 0) return;
+    QByteArray d(kUdmNackFixedSize + missing.size() * 2, Qt::Uninitialized);
+    uchar* p = reinterpret_cast<uchar*>(d.data());
+    writeUdmHeader(p, UDM_V3, UDM_NACK);       p += kUdmHeaderSize;
+    qToBigEndian<quint32>(session_, p);        p += 4;
+    qToBigEndian<quint32>(senderSession, p);   p += 4;
+    qToBigEndian<quint32>(frameId, p);         p += 4;
+    qToBigEndian<quint16>(quint16(missing.size()), p); p += 2;
+    for (quint16 idx : missing) {
+        qToBigEndian<quint16>(idx, p);         p += 2;
+    }
+    sock_.writeDatagram(d, serverAddr_, serverPort_);
+    ++nacksSent_;
 }
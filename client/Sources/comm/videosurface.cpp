@@ -0,0 +1,77 @@
+#include "videosurface.h"
+
+namespace {
+// GUI 线程统计：提交帧数、实际绘制帧数、绘制与缩放耗时
+struct ViewStats {
+    qint64 frames = 0, painted = 0, paintUs = 0, scaleUs = 0;
+    QElapsedTimer window;
+};
+ViewStats g_stats;
+
+// 每 5 秒最多输出一次：GUI 线程每秒花在视频绘制上的毫秒数
+void maybeLogStats()
+{
+    ViewStats& s = g_stats;
+    if (!s.window.isValid()) { s.window.start(); return; }
+    const qint64 ms = s.window.elapsed();
+    if (ms < 5000) return;
+    qInfo().noquote() << QString("[VIEW] paint=%1ms/s scale=%2ms/s frames=%3/s painted=%4/s")
+                         .arg(double(s.paintUs) / ms, 0, 'f', 1)
+                         .arg(double(s.scaleUs) / ms, 0, 'f', 1)
+                         .arg(s.frames * 1000.0 / ms, 0, 'f', 1)
+                         .arg(s.painted * 1000.0 / ms, 0, 'f', 1);
+    s.frames = s.painted = s.paintUs = s.scaleUs = 0;
+    s.window.restart();
+}
+} // namespace
+
+VideoSurface::VideoSurface(const QString& text, QWidget* parent)
+    : QLabel(text, parent)
+{
+}
+
+void VideoSurface::setFrame(const QImage& img)
+{
+    if (img.isNull()) { showText(QString()); return; }
+    frame_ = img;
+    scaled_ = QImage();
+    if (!text().isEmpty()) setText(QString());
+    ++g_stats.frames;
+    update();
+}
+
+void VideoSurface::showText(const QString& text)
+{
+    frame_ = QImage();
+    scaled_ = QImage();
+    setText(text);
+    update();
+}
+
+void VideoSurface::paintEvent(QPaintEvent* e)
+{
+    QLabel::paintEvent(e);   // 背景、边框与（无图像时的）文字
+    if (frame_.isNull()) return;
+
+    QElapsedTimer t; t.start();
+    const QRect cr = contentsRect();
+    if (cr.width() < 2 || cr.height() < 2) return;
+    if (scaled_.isNull() || scaledFor_ != cr.size()) {
+        QElapsedTimer ts; ts.start();
+        const QSize fit = frame_.size().scaled(cr.size(), Qt::KeepAspectRatio);
+        // 尺寸已匹配（调用方按 frameTarget 合成）时直接共享原图，不做任何复制
+        scaled_ = fit == frame_.size() ? frame_
+                                       : frame_.scaled(fit, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        scaledFor_ = cr.size();
+        g_stats.scaleUs += ts.nsecsElapsed() / 1000;
+    }
+
+    QPainter p(this);
+    p.drawImage(cr.x() + (cr.width() - scaled_.width()) / 2,
+                cr.y() + (cr.height() - scaled_.height()) / 2, scaled_);
+    p.end();
+
+    ++g_stats.painted;
+    g_stats.paintUs += t.nsecsElapsed() / 1000;
+    maybeLogStats();
+}
@@ -0,0 +1,273 @@
+#include "yuvconvert.h"
+#include <QVideoFrame>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YC_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace YuvConvert {
+namespace {
+
+// 一行 I420 -> RGB32（u/v 为半宽色度行）
+void convertRow(const uchar* y, const uchar* u, const uchar* v, QRgb* out, int w)
+{
+    int x = 0;
+#ifdef YC_HAVE_SSE2
+    // 每次 8 像素，16 位定点：输入左移 7 位，系数 ×8192，取乘积高 16 位得到 ×16 的结果，
+    // 与标量公式的差异不超过 1
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i c16   = _mm_set1_epi16(16);
+    const __m128i c128  = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(8);
+    const __m128i kY  = _mm_set1_epi16(9535);    // 298/256
+    const __m128i kRV = _mm_set1_epi16(13087);   // 409/256
+    const __m128i kGU = _mm_set1_epi16(3200);    // 100/256
+    const __m128i kGV = _mm_set1_epi16(6656);    // 208/256
+    const __m128i kBU = _mm_set1_epi16(16512);   // 516/256
+    const __m128i alpha = _mm_set1_epi8(char(0xFF));
+    for (; x + 8 <= w; x += 8) {
+        quint32 u4, v4;
+        memcpy(&u4, u + x / 2, 4);
+        memcpy(&v4, v + x / 2, 4);
+        __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero);
+        __m128i uu = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(u4)), zero);
+        __m128i vv = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(v4)), zero);
+        yy = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(yy, c16), 7), kY);
+        uu = _mm_slli_epi16(_mm_sub_epi16(uu, c128), 7);
+        vv = _mm_slli_epi16(_mm_sub_epi16(vv, c128), 7);
+        uu = _mm_unpacklo_epi16(uu, uu);   // 每个色度样本对应两个像素
+        vv = _mm_unpacklo_epi16(vv, vv);
+
+        __m128i r = _mm_adds_epi16(yy, _mm_mulhi_epi16(vv, kRV));
+        __m128i g = _mm_subs_epi16(_mm_subs_epi16(yy, _mm_mulhi_epi16(uu, kGU)), _mm_mulhi_epi16(vv, kGV));
+        __m128i b = _mm_adds_epi16(yy, _mm_mulhi_epi16(uu, kBU));
+        r = _mm_srai_epi16(_mm_adds_epi16(r, round), 4);
+        g = _mm_srai_epi16(_mm_adds_epi16(g, round), 4);
+        b = _mm_srai_epi16(_mm_adds_epi16(b, round), 4);
+
+        // RGB32 内存序 B,G,R,A
+        const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+        const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x),     _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + 4), _mm_unpackhi_epi16(bg, ra));
+    }
+#endif
+    for (; x < w; ++x) out[x] = yuvToRgb(y[x], u[x / 2], v[x / 2]);
+}
+
+// 统一的源访问方式：样本间距与行距
+struct Source {
+    const uchar* y = nullptr;
+    int yStride = 0, yStep = 1;
+    const uchar* u = nullptr;
+    const uchar* v = nullptr;
+    int cStride = 0, cStep = 1;
+    int cWidth = 0, cHeight = 0;   // 色度平面尺寸（打包格式色度行与亮度行同数）
+};
+
+bool describe(const Frame& f, Source& s)
+{
+    const int w = f.width, h = f.height;
+    const uchar* p0 = f.planes[0];
+    if (!p0 || w < 2 || h < 2 || f.strides[0] <= 0) return false;
+    s.y = p0;
+    s.yStride = f.strides[0];
+    switch (f.fmt) {
+    case YUYV:
+    case UYVY:
+        s.yStep = 2;
+        s.y = p0 + (f.fmt == UYVY ? 1 : 0);
+        s.u = p0 + (f.fmt == UYVY ? 0 : 1);
+        s.v = s.u + 2;
+        s.cStride = f.strides[0];
+        s.cStep = 4;
+        s.cWidth = w / 2;
+        s.cHeight = h;
+        return true;
+    case NV12:
+    case NV21: {
+        const uchar* uv = f.planes[1] ? f.planes[1] : p0 + f.strides[0] * h;
+        s.u = uv + (f.fmt == NV21 ? 1 : 0);
+        s.v = uv + (f.fmt == NV21 ? 0 : 1);
+        s.cStride = f.planes[1] ? f.strides[1] : f.strides[0];
+        s.cStep = 2;
+        s.cWidth = (w + 1) / 2;
+        s.cHeight = (h + 1) / 2;
+        return true;
+    }
+    case I420:
+    case YV12: {
+        // 单平面交付时按紧密排列推算 U/V
+        const int cs = f.planes[1] ? f.strides[1] : f.strides[0] / 2;
+        const uchar* p1 = f.planes[1] ? f.planes[1] : p0 + f.strides[0] * h;
+        const uchar* p2 = f.planes[2] ? f.planes[2] : p1 + cs * ((h + 1) / 2);
+        s.u = f.fmt == I420 ? p1 : p2;
+        s.v = f.fmt == I420 ? p2 : p1;
+        s.cStride = cs;
+        s.cWidth = (w + 1) / 2;
+        s.cHeight = (h + 1) / 2;
+        return cs > 0;
+    }
+    default:
+        return false;
+    }
+}
+
+// 输出第 i 个样本在源上的位置；box 时为以采样中心为中心的相邻两点中的前一点
+void buildMap(int srcN, int dstN, bool box, QVector<int>& map)
+{
+    map.resize(dstN);
+    for (int i = 0; i < dstN; ++i) {
+        const qint64 c2 = qint64(2 * i + 1) * srcN;   // 采样中心 × 2dstN
+        const int p = int(box ? (c2 - dstN) / (2 * dstN) : c2 / (2 * dstN));
+        map[i] = qBound(0, p, srcN - (box ? 2 : 1));
+    }
+}
+
+// 按映射表取样一个平面：boxX/boxY 时对相邻两列/两行取平均
+void samplePlane(const uchar* src, int stride, int step, bool boxX, bool boxY,
+                 const QVector<int>& xmap, const QVector<int>& ymap, uchar* dst, int dstStride)
+{
+    const int w = xmap.size(), h = ymap.size();
+    const int dx = boxX ? step : 0;
+    // 常见比例（同宽、正好一半）不查表，便于编译器向量化
+    const bool same = !boxX && xmap.constLast() == w - 1;
+    const bool half = boxX && xmap.constLast() == 2 * (w - 1);
+    for (int y = 0; y < h; ++y) {
+        const uchar* r0 = src + qint64(ymap[y]) * stride;
+        const uchar* r1 = boxY ? r0 + stride : r0;
+        uchar* out = dst + qint64(y) * dstStride;
+        if (same && !boxY) {
+            if (step == 1) memcpy(out, r0, size_t(w));
+            else for (int x = 0; x < w; ++x) out[x] = r0[x * step];
+        } else if (same) {
+            for (int x = 0; x < w; ++x) out[x] = uchar((r0[x * step] + r1[x * step] + 1) >> 1);
+        } else if (half) {
+            for (int x = 0; x < w; ++x) {
+                const int o = 2 * x * step;
+                out[x] = uchar((r0[o] + r0[o + step] + r1[o] + r1[o + step] + 2) >> 2);
+            }
+        } else {
+            for (int x = 0; x < w; ++x) {
+                const int o = xmap[x] * step;
+                out[x] = uchar((r0[o] + r0[o + dx] + r1[o] + r1[o + dx] + 2) >> 2);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void Planar::resize(int w, int h)
+{
+    width = w;
+    height = h;
+    const int n = w * h + 2 * (w / 2) * (h / 2);
+    // 仍被别处共享时换新缓冲，避免把旧内容复制一遍
+    if (data.isDetached()) data.resize(n);
+    else data = QByteArray(n, Qt::Uninitialized);
+}
+
+uchar* Planar::plane(int i)
+{
+    uchar* p = reinterpret_cast<uchar*>(data.data());
+    return i == 0 ? p : p + width * height + (i - 1) * (width / 2) * (height / 2);
+}
+
+const uchar* Planar::plane(int i) const
+{
+    const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+    return i == 0 ? p : p + width * height + (i - 1) * (width / 2) * (height / 2);
+}
+
+bool fromVideoFrame(const QVideoFrame& mapped, Frame& out)
+{
+    switch (mapped.pixelFormat()) {
+    case QVideoFrame::Format_YUYV:    out.fmt = YUYV; break;
+    case QVideoFrame::Format_UYVY:    out.fmt = UYVY; break;
+    case QVideoFrame::Format_NV12:    out.fmt = NV12; break;
+    case QVideoFrame::Format_NV21:    out.fmt = NV21; break;
+    case QVideoFrame::Format_YUV420P: out.fmt = I420; break;
+    case QVideoFrame::Format_YV12:    out.fmt = YV12; break;
+    default: return false;
+    }
+    out.width = mapped.width();
+    out.height = mapped.height();
+    const int n = qMin(3, mapped.planeCount());
+    for (int i = 0; i < 3; ++i) {
+        out.planes[i] = i < n ? mapped.bits(i) : nullptr;
+        out.strides[i] = i < n ? mapped.bytesPerLine(i) : 0;
+    }
+    return out.planes[0] != nullptr;
+}
+
+Frame frameOf(const Planar& p)
+{
+    Frame f;
+    f.fmt = I420;
+    f.width = p.width;
+    f.height = p.height;
+    for (int i = 0; i < 3; ++i) {
+        f.planes[i] = p.plane(i);
+        f.strides[i] = p.stride(i);
+    }
+    return f;
+}
+
+QSize fitSize(const QSize& src, const QSize& bound)
+{
+    QSize s = src;
+    if (bound.isValid() && (s.width() > bound.width() || s.height() > bound.height()))
+        s.scale(bound, Qt::KeepAspectRatio);
+    return QSize(qMax(2, s.width() & ~1), qMax(2, s.height() & ~1));
+}
+
+bool scaleToI420(const Frame& src, const QSize& dstSize, Planar& out)
+{
+    Source s;
+    if (!describe(src, s)) return false;
+    const int dw = dstSize.width(), dh = dstSize.height();
+    if (dw < 2 || dh < 2 || (dw | dh) & 1 || dw > src.width || dh > src.height) return false;
+    out.resize(dw, dh);
+
+    // 缩小 2 倍及以上时 2x2 盒式平均，避免隔点取样的混叠
+    const bool boxX = src.width >= 2 * dw, boxY = src.height >= 2 * dh;
+    QVector<int> xmap, ymap;
+    buildMap(src.width, dw, boxX, xmap);
+    buildMap(src.height, dh, boxY, ymap);
+    samplePlane(s.y, s.yStride, s.yStep, boxX, boxY, xmap, ymap, out.plane(0), out.stride(0));
+
+    // 色度：4:2:2 打包格式的色度行与亮度同数，纵向总是两行合一
+    const int cw = dw / 2, ch = dh / 2;
+    const bool cBoxX = s.cWidth >= 2 * cw, cBoxY = s.cHeight >= 2 * ch;
+    buildMap(s.cWidth, cw, cBoxX, xmap);
+    buildMap(s.cHeight, ch, cBoxY, ymap);
+    samplePlane(s.u, s.cStride, s.cStep, cBoxX, cBoxY, xmap, ymap, out.plane(1), out.stride(1));
+    samplePlane(s.v, s.cStride, s.cStep, cBoxX, cBoxY, xmap, ymap, out.plane(2), out.stride(2));
+    return true;
+}
+
+bool i420ToRgb32(const Planar& src, QImage& dst)
+{
+    const QSize size(src.width, src.height);
+    if (size.isEmpty()) return false;
+    if (dst.size() != size || dst.format() != QImage::Format_RGB32 || !dst.isDetached())
+        dst = QImage(size, QImage::Format_RGB32);
+    if (dst.isNull()) return false;
+    const uchar* y = src.plane(0);
+    const uchar* u = src.plane(1);
+    const uchar* v = src.plane(2);
+    const int cs = src.stride(1);
+    for (int row = 0; row < src.height; ++row)
+        convertRow(y + row * src.width, u + (row / 2) * cs, v + (row / 2) * cs,
+                   reinterpret_cast<QRgb*>(dst.scanLine(row)), src.width);
+    return true;
+}
+
+bool toRgb32(const Frame& src, const QSize& dstSize, Planar& scratch, QImage& dst)
+{
+    return scaleToI420(src, dstSize, scratch) && i420ToRgb32(scratch, dst);
+}
+
+} // namespace YuvConvert
@@ -1,4 +1,4 @@
-QT += core gui widgets network multimedia multimediawidgets
+QT += core gui widgets network multimedia multimediawidgets concurrent
 CONFIG += c++17
 # 如需调试控制台输出可解开：CONFIG += console
 
@@ -7,6 +7,16 @@ TARGET = cloudmeeting-client
 
 INCLUDEPATH += $$PWD/Headers $$PWD/Headers/comm
 
+# libjpeg-turbo（TurboJPEG API）可用时启用快速 JPEG 路径，否则 JpegCodec 回退 QImageWriter/QImageReader
+CONFIG += link_pkgconfig
+packagesExist(libturbojpeg) {
+    PKGCONFIG += libturbojpeg
+    DEFINES += HAVE_TURBOJPEG
+}
+
+# 协议实现统一来自顶层 common（client/Headers/protocol.h 仅做转发）
+include($$PWD/../common/common.pri)
+
 # 递归纳入所有头/源（Qt 5.12.8）
 HEADERS += $$files($$PWD/Headers/*.h, true)
 SOURCES += $$files($$PWD/Sources/*.cpp, true)
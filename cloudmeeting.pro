@@ -1,3 +1,7 @@
 TEMPLATE = subdirs
 CONFIG  += ordered
-SUBDIRS += server client
+SUBDIRS += server hub client bench
+
+server.file = server/server.pro
+hub.file    = server/hub.pro
+hub.makefile = Makefile.hub   # 与 server.pro 同目录，避免 Makefile 重名
@@ -4,5 +4,6 @@ isEmpty(COMMON_DIR) {
 }
 
 INCLUDEPATH += $$COMMON_DIR
-HEADERS += $$COMMON_DIR/protocol.h
+HEADERS += $$COMMON_DIR/protocol.h \
+           $$COMMON_DIR/udm.h
 SOURCES += $$COMMON_DIR/protocol.cpp
@@ -3,6 +3,7 @@
 static const int kLenFieldSize = 4; // uint32 length（大端）
 static const int kTypeSize     = 2; // uint16
 static const int kJsonSizeSize = 4; // uint32
+static const int kHeaderSize   = kLenFieldSize + kTypeSize + kJsonSizeSize;
 
 QByteArray buildPacket(quint16 type,
                        const QJsonObject& json,
@@ -29,61 +30,174 @@ QByteArray buildPacket(quint16 type,
     return out;
 }
 
+QByteArray buildMediaPacket(quint16 type, const MediaHeader& h, const QByteArray& payload)
+{
+    const int hdrSize = kMediaHeaderSize + (type == MSG_VIDEO_FRAME_V2 ? kMediaVideoExtSize : 0);
+    const quint32 length = static_cast<quint32>(kTypeSize + kJsonSizeSize + hdrSize + payload.size());
+
+    QByteArray out(kLenFieldSize + static_cast<int>(length), Qt::Uninitialized);
+    uchar* d = reinterpret_cast<uchar*>(out.data());
+    qToBigEndian<quint32>(length, d);                 d += kLenFieldSize;
+    qToBigEndian<quint16>(type, d);                   d += kTypeSize;
+    qToBigEndian<quint32>(0, d);                      d += kJsonSizeSize; // 无 JSON
+    qToBigEndian<quint16>(h.streamId, d);             d += 2;
+    *d++ = h.codec;
+    *d++ = h.flags;
+    qToBigEndian<quint32>(h.seq, d);                  d += 4;
+    qToBigEndian<quint32>(h.ts, d);                   d += 4;
+    if (type == MSG_VIDEO_FRAME_V2) {
+        qToBigEndian<quint16>(h.w, d);                d += 2;
+        qToBigEndian<quint16>(h.h, d);                d += 2;
+    }
+    if (!payload.isEmpty())
+        memcpy(d, payload.constData(), size_t(payload.size()));
+    return out;
+}
+
+bool parseMediaHeader(quint16 type, const QByteArray& bin, MediaHeader& h, int& payloadOff)
+{
+    if (!isMediaV2(type)) return false;
+    const int hdrSize = kMediaHeaderSize + (type == MSG_VIDEO_FRAME_V2 ? kMediaVideoExtSize : 0);
+    if (bin.size() < hdrSize) return false;
+
+    const uchar* s = reinterpret_cast<const uchar*>(bin.constData());
+    h.streamId = qFromBigEndian<quint16>(s);      s += 2;
+    h.codec    = *s++;
+    h.flags    = *s++;
+    h.seq      = qFromBigEndian<quint32>(s);      s += 4;
+    h.ts       = qFromBigEndian<quint32>(s);      s += 4;
+    if (type == MSG_VIDEO_FRAME_V2) {
+        h.w    = qFromBigEndian<quint16>(s);      s += 2;
+        h.h    = qFromBigEndian<quint16>(s);
+    }
+    payloadOff = hdrSize;
+    return true;
+}
+
+// 单帧原地解析结果（偏移均相对帧首）
+namespace {
+enum class FrameStatus { NeedMore, Corrupt, Skip, Ok };
+
+struct FrameSpan {
+    int     total    = 0; // 整帧字节数（含长度头）
+    quint16 type     = 0;
+    int     jsonOff  = 0;
+    int     jsonSize = 0;
+    int     binOff   = 0;
+    int     binSize  = 0;
+};
+
+FrameStatus parseFrame(const char* p, int avail, FrameSpan& f)
+{
+    if (avail < kLenFieldSize) return FrameStatus::NeedMore;
+
+    const quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(p));
+    if (length < static_cast<quint32>(kTypeSize + kJsonSizeSize) ||
+        length > kMaxPacketLen) {
+        return FrameStatus::Corrupt;
+    }
+
+    f.total = kLenFieldSize + static_cast<int>(length);
+    if (avail < f.total) return FrameStatus::NeedMore;
+
+    f.type = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(p + kLenFieldSize));
+    const quint32 jsonSize =
+        qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(p + kLenFieldSize + kTypeSize));
+
+    const int payloadBytes = f.total - kHeaderSize;
+    if (jsonSize > static_cast<quint32>(payloadBytes) || jsonSize > kMaxJsonLen) {
+        return FrameStatus::Skip;
+    }
+
+    f.jsonOff  = kHeaderSize;
+    f.jsonSize = static_cast<int>(jsonSize);
+    f.binOff   = f.jsonOff + f.jsonSize;
+    f.binSize  = payloadBytes - f.jsonSize;
+    return FrameStatus::Ok;
+}
+} // namespace
+
 bool drainPackets(QByteArray& buffer, QVector<Packet>& out)
 {
     bool produced = false;
+    const char* base = buffer.constData();
+    int off = 0;
 
     for (;;) {
-        if (buffer.size() < kLenFieldSize) break;
-
-        quint32 length = 0;
-        {
-            QDataStream peek(buffer.left(kLenFieldSize));
-            peek.setByteOrder(QDataStream::BigEndian);
-            peek >> length;
-        }
-
-        if (length < static_cast<quint32>(kTypeSize + kJsonSizeSize) ||
-            length > kMaxPacketLen) {
+        FrameSpan f;
+        const FrameStatus st = parseFrame(base + off, buffer.size() - off, f);
+        if (st == FrameStatus::NeedMore) break;
+        if (st == FrameStatus::Corrupt) {
             buffer.clear();
-            break;
+            return produced;
         }
+        if (st == FrameStatus::Ok) {
+            const char* frame = base + off;
+            Packet pkt;
+            pkt.type = f.type;
+            if (f.jsonSize > 0)
+                pkt.json = fromJsonBytes(QByteArray::fromRawData(frame + f.jsonOff, f.jsonSize));
+            if (f.binSize > 0) pkt.bin = QByteArray(frame + f.binOff, f.binSize);
+            out.push_back(std::move(pkt));
+            produced = true;
+        }
+        off += f.total;
+    }
 
-        const int totalNeed = kLenFieldSize + static_cast<int>(length);
-        if (buffer.size() < totalNeed) break;
-
-        QByteArray block = buffer.left(totalNeed);
-        buffer.remove(0, totalNeed);
+    // 一次性移除已消费部分（原先每帧一次 remove）
+    if (off > 0) buffer.remove(0, off);
+    return produced;
+}
 
-        QDataStream ds(block);
-        ds.setByteOrder(QDataStream::BigEndian);
+void RecvBuffer::append(const QByteArray& data)
+{
+    if (data.isEmpty()) return;
+    if (rpos_ >= buf_.size()) {
+        // 已全部消费：直接共享新数据块
+        buf_ = data;
+        rpos_ = 0;
+        return;
+    }
+    if (rpos_ > 0) {
+        buf_.remove(0, rpos_);
+        rpos_ = 0;
+    }
+    buf_.append(data);
+}
 
-        quint32 lenField = 0; ds >> lenField; Q_UNUSED(lenField);
-        quint16 type = 0;     ds >> type;
-        quint32 jsonSize = 0; ds >> jsonSize;
+Packet PacketView::toPacket() const
+{
+    Packet pkt;
+    pkt.type = type;
+    pkt.json = json();
+    if (!bin.isEmpty()) pkt.bin = QByteArray(bin.constData(), bin.size());
+    return pkt;
+}
 
-        const int payloadBytes = totalNeed - kLenFieldSize - kTypeSize - kJsonSizeSize;
-        if (jsonSize > static_cast<quint32>(payloadBytes) || jsonSize > kMaxJsonLen) {
-            continue;
-        }
+bool drainPacketViews(RecvBuffer& buffer, QVector<PacketView>& out)
+{
+    bool produced = false;
 
-        QByteArray jsonBytes(jsonSize, Qt::Uninitialized);
-        if (jsonSize > 0) {
-            ds.readRawData(jsonBytes.data(), jsonBytes.size());
+    for (;;) {
+        FrameSpan f;
+        const FrameStatus st = parseFrame(buffer.data(), buffer.size(), f);
+        if (st == FrameStatus::NeedMore) break;
+        if (st == FrameStatus::Corrupt) {
+            buffer.clear();
+            break;
         }
-        QByteArray bin;
-        const int binSize = payloadBytes - static_cast<int>(jsonSize);
-        if (binSize > 0) {
-            bin = block.right(binSize);
+        if (st == FrameStatus::Ok) {
+            const char* frame = buffer.data();
+            PacketView v;
+            v.type = f.type;
+            v.raw = QByteArray::fromRawData(frame, f.total);
+            v.jsonBytes = QByteArray::fromRawData(frame + f.jsonOff, f.jsonSize);
+            if (f.binSize > 0) v.bin = QByteArray::fromRawData(frame + f.binOff, f.binSize);
+            out.push_back(std::move(v));
+            produced = true;
         }
-
-        Packet pkt;
-        pkt.type = type;
-        pkt.json = fromJsonBytes(jsonBytes);
-        pkt.bin  = bin;
-        out.push_back(std::move(pkt));
-        produced = true;
+        buffer.consume(f.total);
     }
 
     return produced;
-}
\ No newline at end of file
+}
@@ -22,12 +22,20 @@ enum MsgType : quint16 {
     MSG_TEXT             = 10,
     MSG_DEVICE_DATA      = 20,
     MSG_VIDEO_FRAME      = 30,  // bin: JPEG
+    MSG_VIDEO_FRAME_V2   = 31,  // 无 JSON，bin: MediaHeader + 视频扩展(w,h) + JPEG
     MSG_AUDIO_FRAME      = 40,  // 预留
+    MSG_AUDIO_FRAME_V2   = 41,  // 无 JSON，bin: MediaHeader + 音频负载
     MSG_CONTROL          = 50,  // 控制/状态，如 {kind:"video", state:"on/off"}
 
     MSG_SERVER_EVENT     = 90   // 服务器事件，如房间成员列表
 };
 
+// 协议版本：加入房间时由客户端在 MSG_JOIN_WORKORDER 中携带 "proto"，服务器在确认中回应
+// - v1: 所有消息均带 JSON 头
+// - v2: 媒体帧使用紧凑二进制头（MediaHeader），JSON 仅用于控制消息；
+//       服务器为每个连接分配数值 streamId，并在房间事件 "streams" 中下发 user -> streamId 映射
+constexpr int kProtoVersion = 2;
+
 // 安全上限（防御异常/恶意输入）
 constexpr quint32 kMaxPacketLen = 8u * 1024u * 1024u; // 8MB
 constexpr quint32 kMaxJsonLen   = 1u * 1024u * 1024u; // 1MB
@@ -39,6 +47,37 @@ struct Packet {
     QByteArray bin; // 可为空
 };
 
+// v2 媒体编码
+enum MediaCodec : quint8 {
+    CODEC_MULAW = 1,  // G.711 µ-law, 8kHz 单声道
+    CODEC_PCM16 = 2,  // PCM16LE, 8kHz 单声道
+    CODEC_JPEG  = 3
+};
+
+// v2 媒体头（大端）：
+// [u16 streamId][u8 codec][u8 flags][u32 seq][u32 ts] 共 12 字节
+// 视频帧额外附加 [u16 w][u16 h]
+struct MediaHeader {
+    quint16 streamId = 0;
+    quint8  codec    = 0;
+    quint8  flags    = 0;  // kMediaFlag*
+    quint32 seq      = 0;
+    quint32 ts       = 0;  // 毫秒时间戳低 32 位
+    quint16 w = 0, h = 0;  // 仅视频
+};
+constexpr quint8 kMediaFlagKey    = 0x01; // flags bit0：关键帧（可独立解码）
+constexpr int kMediaHeaderSize   = 12;
+constexpr int kMediaVideoExtSize = 4;
+
+// 从完整帧（含长度头）中读取消息类型，无需解析
+inline quint16 peekPacketType(const QByteArray& frame) {
+    return frame.size() >= 6 ? qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(frame.constData()) + 4) : 0;
+}
+
+inline bool isMediaV2(quint16 type) {
+    return type == MSG_AUDIO_FRAME_V2 || type == MSG_VIDEO_FRAME_V2;
+}
+
 inline QByteArray toJsonBytes(const QJsonObject& j) {
     return QJsonDocument(j).toJson(QJsonDocument::Compact);
 }
@@ -53,5 +92,41 @@ QByteArray buildPacket(quint16 type,
 
 bool drainPackets(QByteArray& buffer, QVector<Packet>& out);
 
+// v2 媒体帧打包/解析（jsonSize 固定为 0，外层帧结构不变）
+QByteArray buildMediaPacket(quint16 type, const MediaHeader& h, const QByteArray& payload);
+// 成功时 payloadOff 为负载在 bin 中的起始偏移
+bool parseMediaHeader(quint16 type, const QByteArray& bin, MediaHeader& h, int& payloadOff);
+
+// 接收缓冲：读游标 + 惰性整理
+// - consume() 只移动游标，不再逐帧 remove(0, n)
+// - append() 时若已读完则直接共享新数据（隐式共享，零拷贝），否则只搬移一次未读尾部
+class RecvBuffer {
+public:
+    void append(const QByteArray& data);
+    void consume(int n) { rpos_ = qMin(rpos_ + n, buf_.size()); }
+    void clear() { buf_.clear(); rpos_ = 0; }
+
+    int size() const { return buf_.size() - rpos_; }
+    const char* data() const { return buf_.constData() + rpos_; }
+
+private:
+    QByteArray buf_;
+    int rpos_ = 0;
+};
+
+// 原地解析出的消息视图：jsonBytes/bin 通过 QByteArray::fromRawData 直接引用 RecvBuffer 内存
+// 注意：仅在下一次 RecvBuffer::append()/clear() 之前有效，需要跨事件保存时请用 toPacket()
+struct PacketView {
+    quint16 type = 0;
+    QByteArray raw;       // 整帧原始字节（含长度头），可原样转发
+    QByteArray jsonBytes;
+    QByteArray bin; // 可为空
+
+    QJsonObject json() const { return jsonBytes.isEmpty() ? QJsonObject{} : fromJsonBytes(jsonBytes); }
+    Packet toPacket() const; // 深拷贝 bin，得到可长期持有的 Packet
+};
+
+bool drainPacketViews(RecvBuffer& buffer, QVector<PacketView>& out);
+
 
 static const quint16 MSG_ANNOT = 1206;
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+// ===============================================
+// common/udm.h
+// UDP 媒体报文（UDM）公共定义，客户端 UdpMediaClient 与服务器 UdpRelay 共用
+// 公共头（大端）: [u32 magic 'UDM1'][u8 ver][u8 type][u16 reserved]
+// - v1/v2: 分片携带 QString room/sender（QDataStream 编码，UTF-16 + 4 字节长度）
+// - v3   : 注册后由中继分配数值会话 id，分片只携带该 id，中继按数组下标路由
+// 升级须整体切换（flag day）：中继原样转发 v3 分片，不转换为 v2，也不区分成员版本
+// （注册仍用 v2 头，中继无从得知客户端版本）。旧客户端收不到新客户端的画面，
+// 新客户端仍可接收旧客户端的 v2 分片；中继与全部客户端须同时升级
+// ===============================================
+
+#include <QtCore>
+
+constexpr quint32 kUdmMagic      = 0x55444D31; // 'UDM1'
+constexpr int     kUdmHeaderSize = 8;
+
+enum UdmVersion : quint8 {
+    UDM_V1 = 1,
+    UDM_V2 = 2,  // 分片增加 codec 字节
+    UDM_V3 = 3   // 数值会话 id
+};
+
+enum UdmType : quint8 {
+    UDM_REGISTER = 1, // 客户端 -> 中继: [QString room][QString user]；兼作心跳
+    UDM_CHUNK    = 2, // 视频分片
+    UDM_ROSTER   = 3, // 中继 -> 客户端: [u32 yourSession(0=仅名单更新)][u16 n] n×([u32 session][QString user])
+    UDM_PARITY   = 4, // v3 FEC 校验分片：头同 v3 分片，idx 为组号，cnt 为数据分片数；
+                      // 负载 [u16 groupSize][u16 组内长度异或][组内数据分片按字节异或（补零到组内最大长度）]
+    UDM_NACK     = 5, // v3 接收方 -> 中继: [u32 mySession][u32 senderSession][u32 frameId][u16 n] n×[u16 idx]
+                      // 中继从重传缓存中只向请求方补发这些分片
+    UDM_FEEDBACK = 6  // v3 接收方 -> 中继 -> 发送方: [u32 mySession][u32 senderSession][u8 flags]
+                      // [u16 丢帧千分比][u16 收帧 fps×10][u64 最近完整帧 ts][u16 该帧收到后到本报告的毫秒数]
+                      // 发送方以自身时钟算回路时延 = now - ts - hold，无需对时
+};
+
+// 接收报告
+enum UdmFeedbackFlag : quint8 {
+    UDM_FB_KEYFRAME = 0x01  // 请求关键帧（背板失步：丢帧或解码失败）
+};
+constexpr int kUdmFeedbackSize = kUdmHeaderSize + 23;
+
+// NACK 上限：单条最多请求的分片数
+constexpr int kUdmMaxNackIdx = 64;
+constexpr int kUdmNackFixedSize = kUdmHeaderSize + 14;
+
+// v3 分片头，紧跟公共头：
+// [u32 session][u32 frameId][u16 idx][u16 cnt][u8 codec][u16 w][u16 h][u64 ts][u32 len][payload]
+struct UdmChunkV3 {
+    quint32 session = 0;
+    quint32 frameId = 0;
+    quint16 idx = 0, cnt = 0;
+    quint8  codec = 0;
+    quint16 w = 0, h = 0;
+    quint64 ts = 0;
+    quint32 len = 0;
+};
+constexpr int kUdmChunkV3Size = kUdmHeaderSize + 29;
+
+inline void writeUdmHeader(uchar* d, quint8 ver, quint8 type) {
+    qToBigEndian<quint32>(kUdmMagic, d);
+    d[4] = ver;
+    d[5] = type;
+    d[6] = d[7] = 0;
+}
+
+// 读取公共头；失败返回 false
+inline bool readUdmHeader(const uchar* d, int len, quint8& ver, quint8& type) {
+    if (len < kUdmHeaderSize || qFromBigEndian<quint32>(d) != kUdmMagic) return false;
+    ver  = d[4];
+    type = d[5];
+    return ver >= UDM_V1 && ver <= UDM_V3;
+}
+
+// 写入含公共头的完整 v3 分片头（kUdmChunkV3Size 字节）
+inline void writeUdmChunkV3(uchar* d, const UdmChunkV3& c, quint8 type = UDM_CHUNK) {
+    writeUdmHeader(d, UDM_V3, type);                d += kUdmHeaderSize;
+    qToBigEndian<quint32>(c.session, d);            d += 4;
+    qToBigEndian<quint32>(c.frameId, d);            d += 4;
+    qToBigEndian<quint16>(c.idx, d);                d += 2;
+    qToBigEndian<quint16>(c.cnt, d);                d += 2;
+    *d++ = c.codec;
+    qToBigEndian<quint16>(c.w, d);                  d += 2;
+    qToBigEndian<quint16>(c.h, d);                  d += 2;
+    qToBigEndian<quint64>(c.ts, d);                 d += 8;
+    qToBigEndian<quint32>(c.len, d);
+}
+
+// 解析 v3 分片头（d 指向公共头），并校验负载长度
+inline bool readUdmChunkV3(const uchar* d, int len, UdmChunkV3& c) {
+    if (len < kUdmChunkV3Size) return false;
+    d += kUdmHeaderSize;
+    c.session = qFromBigEndian<quint32>(d);         d += 4;
+    c.frameId = qFromBigEndian<quint32>(d);         d += 4;
+    c.idx     = qFromBigEndian<quint16>(d);         d += 2;
+    c.cnt     = qFromBigEndian<quint16>(d);         d += 2;
+    c.codec   = *d++;
+    c.w       = qFromBigEndian<quint16>(d);         d += 2;
+    c.h       = qFromBigEndian<quint16>(d);         d += 2;
+    c.ts      = qFromBigEndian<quint64>(d);         d += 8;
+    c.len     = qFromBigEndian<quint32>(d);
+    return c.len <= quint32(len - kUdmChunkV3Size);
+}
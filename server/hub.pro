@@ -0,0 +1,26 @@
+TEMPLATE = app
+TARGET   = cloudmeeting-hub
+
+QT += core network
+CONFIG += console c++17
+QMAKE_CXXFLAGS += -Wall
+macx: CONFIG -= app_bundle
+
+include($$PWD/../common/common.pri)
+
+HEADERS += \
+    $$PWD/src/hubstats.h \
+    $$PWD/src/retranscache.h \
+    $$PWD/src/roomhub.h \
+    $$PWD/src/roomshard.h \
+    $$PWD/src/sendqueue.h \
+    $$PWD/src/udprelay.h
+
+SOURCES += \
+    $$PWD/src/hub_main.cpp \
+    $$PWD/src/hubstats.cpp \
+    $$PWD/src/retranscache.cpp \
+    $$PWD/src/roomhub.cpp \
+    $$PWD/src/roomshard.cpp \
+    $$PWD/src/sendqueue.cpp \
+    $$PWD/src/udprelay.cpp
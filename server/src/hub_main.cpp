@@ -0,0 +1,42 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "roomhub.h"
+#include "udprelay.h"
+
+// 媒体服务器：TCP 房间分发（RoomHub）+ UDP 分片中继（UdpRelay，端口为 TCP 端口 + 1）
+// 与客户端默认端口 9000 / 9001 对应；登录/聊天服务仍由 cloudmeeting-server（5555）提供
+static const quint16 DEFAULT_HUB_PORT = 9000;
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cloudmeeting-hub");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption portOpt({"p", "port"}, "TCP port (UDP relay uses port + 1)", "port",
+                               QString::number(DEFAULT_HUB_PORT));
+    QCommandLineOption shardsOpt("shards", "room shard threads (0 = CPU count)", "n", "0");
+    QCommandLineOption noBatchOpt("no-batch", "UDP relay without recvmmsg/sendmmsg");
+    parser.addOption(portOpt);
+    parser.addOption(shardsOpt);
+    parser.addOption(noBatchOpt);
+    parser.process(app);
+
+    bool ok = false;
+    const uint port = parser.value(portOpt).toUInt(&ok);
+    if (!ok || port == 0 || port >= 65535) {
+        qCritical() << "invalid port" << parser.value(portOpt);
+        return 1;
+    }
+
+    // 中继先于 RoomHub 构造（后析构），并在分片线程启动前交给 RoomHub
+    UdpRelay relay;
+    if (!relay.start(quint16(port + 1), !parser.isSet(noBatchOpt))) return 1;
+
+    RoomHub hub;
+    hub.setUdpRelay(&relay);
+    if (!hub.start(quint16(port), parser.value(shardsOpt).toInt())) return 1;
+
+    return app.exec();
+}
@@ -0,0 +1,71 @@
+#include "hubstats.h"
+#include "protocol.h"
+#include <cmath>
+#include <limits>
+
+StatKind statKindOf(quint16 msgType)
+{
+    switch (msgType) {
+    case MSG_TEXT:           return STAT_TEXT;
+    case MSG_DEVICE_DATA:    return STAT_DEVICE;
+    case MSG_VIDEO_FRAME:
+    case MSG_VIDEO_FRAME_V2: return STAT_VIDEO;
+    case MSG_AUDIO_FRAME:
+    case MSG_AUDIO_FRAME_V2: return STAT_AUDIO;
+    case MSG_CONTROL:        return STAT_CONTROL;
+    case MSG_ANNOT:          return STAT_ANNOT;
+    case MSG_SERVER_EVENT:   return STAT_EVENT;
+    default:                 return STAT_OTHER;
+    }
+}
+
+const char* statKindName(int kind)
+{
+    static const char* const names[STAT_KIND_COUNT] = {
+        "text", "device", "video", "audio", "control", "annot", "event", "other"
+    };
+    return (kind >= 0 && kind < STAT_KIND_COUNT) ? names[kind] : "other";
+}
+
+const qint64 LatencyHistogram::kBoundsUs[kBuckets] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 50000, std::numeric_limits<qint64>::max()
+};
+
+void LatencyHistogram::record(qint64 us)
+{
+    int i = 0;
+    while (i < kBuckets - 1 && us > kBoundsUs[i]) ++i;
+    buckets_[i].fetchAndAddRelaxed(1);
+}
+
+quint64 LatencyHistogram::count() const
+{
+    quint64 n = 0;
+    for (const auto& b : buckets_) n += b.load();
+    return n;
+}
+
+qint64 LatencyHistogram::percentileUs(double p) const
+{
+    const quint64 total = count();
+    if (total == 0) return 0;
+    const quint64 rank = quint64(std::ceil(p * double(total)));
+    quint64 acc = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        acc += buckets_[i].load();
+        if (acc >= rank) return i == kBuckets - 1 ? kBoundsUs[kBuckets - 2] : kBoundsUs[i];
+    }
+    return kBoundsUs[kBuckets - 2];
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonArray b;
+    for (const auto& v : buckets_) b.append(double(v.load()));
+    return QJsonObject{
+        {"count", double(count())},
+        {"p50Us", double(percentileUs(0.50))},
+        {"p99Us", double(percentileUs(0.99))},
+        {"buckets", b}
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <QtCore>
+
+// ===============================================
+// 服务器热路径计数器
+// - 每个计数器只有一个写者（所属分片/中继线程）；跨线程读取用 QAtomicInteger::load()（relaxed），无锁
+// - 分片内的每房间/每客户端计数用普通整数，分片总计与直方图用原子量，便于全局汇总
+// ===============================================
+
+enum StatKind { STAT_TEXT = 0, STAT_DEVICE, STAT_VIDEO, STAT_AUDIO, STAT_CONTROL,
+                STAT_ANNOT, STAT_EVENT, STAT_OTHER, STAT_KIND_COUNT };
+
+StatKind statKindOf(quint16 msgType);
+const char* statKindName(int kind);
+
+inline void statAdd(quint64& c, quint64 v) { c += v; }
+inline void statAdd(QAtomicInteger<quint64>& c, quint64 v) { c.fetchAndAddRelaxed(v); }
+inline quint64 statLoad(quint64 c) { return c; }
+inline quint64 statLoad(const QAtomicInteger<quint64>& c) { return c.load(); }
+
+template <typename T>
+struct TrafficCounters {
+    T pktIn[STAT_KIND_COUNT]    = {};
+    T bytesIn[STAT_KIND_COUNT]  = {};
+    T pktOut[STAT_KIND_COUNT]   = {};
+    T bytesOut[STAT_KIND_COUNT] = {};
+
+    void addIn(quint16 type, int bytes) {
+        const StatKind k = statKindOf(type);
+        statAdd(pktIn[k], 1); statAdd(bytesIn[k], quint64(bytes));
+    }
+    void addOut(quint16 type, int bytes) {
+        const StatKind k = statKindOf(type);
+        statAdd(pktOut[k], 1); statAdd(bytesOut[k], quint64(bytes));
+    }
+
+    // {"video":{"in":[pkts,bytes],"out":[pkts,bytes]}, ...}，只输出非零类型
+    QJsonObject toJson() const {
+        QJsonObject o;
+        for (int k = 0; k < STAT_KIND_COUNT; ++k) {
+            const quint64 pi = statLoad(pktIn[k]), po = statLoad(pktOut[k]);
+            if (pi == 0 && po == 0) continue;
+            o.insert(statKindName(k), QJsonObject{
+                {"in",  QJsonArray{double(pi), double(statLoad(bytesIn[k]))}},
+                {"out", QJsonArray{double(po), double(statLoad(bytesOut[k]))}}
+            });
+        }
+        return o;
+    }
+    quint64 totalPktIn() const  { quint64 n = 0; for (const auto& v : pktIn)  n += statLoad(v); return n; }
+    quint64 totalPktOut() const { quint64 n = 0; for (const auto& v : pktOut) n += statLoad(v); return n; }
+    quint64 totalBytesIn() const  { quint64 n = 0; for (const auto& v : bytesIn)  n += statLoad(v); return n; }
+    quint64 totalBytesOut() const { quint64 n = 0; for (const auto& v : bytesOut) n += statLoad(v); return n; }
+};
+
+// 固定桶延迟直方图（微秒）
+class LatencyHistogram {
+public:
+    static constexpr int kBuckets = 10;
+    void record(qint64 us);
+    qint64 percentileUs(double p) const; // 返回所在桶上界；无样本返回 0
+    quint64 count() const;
+    QJsonObject toJson() const;
+
+private:
+    static const qint64 kBoundsUs[kBuckets]; // 最后一个桶为上溢桶
+    QAtomicInteger<quint64> buckets_[kBuckets];
+};
+
+// 每行日志限速：窗口内只放行一条，其余计数，下次放行时报告被抑制的条数
+class LogLimiter {
+public:
+    explicit LogLimiter(qint64 windowMs = 1000) : windowMs_(windowMs) {}
+    bool allow(qint64 nowMs, int* suppressed) {
+        if (nowMs - lastMs_ < windowMs_) { ++suppressed_; return false; }
+        lastMs_ = nowMs;
+        if (suppressed) *suppressed = suppressed_;
+        suppressed_ = 0;
+        return true;
+    }
+private:
+    qint64 windowMs_;
+    qint64 lastMs_ = 0;
+    int suppressed_ = 0;
+};
@@ -0,0 +1,56 @@
+#include "retranscache.h"
+
+void RetransCache::put(quint32 frameId, quint16 idx, const char* d, int len)
+{
+    if (len <= 0 || len > kSlotBytes) return;
+    if (slots_.isEmpty()) slots_.resize(kSlots);
+
+    if (lastRun_ < 0 || runs_[lastRun_].frameId != frameId) {
+        lastRun_ = (lastRun_ + 1) % kRuns;
+        runs_[lastRun_] = Run{ frameId, written_, 0 };
+    }
+    Slot& s = slots_[int(written_ % kSlots)];
+    s.frameId = frameId;
+    s.idx = idx;
+    s.len = quint16(len);
+    memcpy(s.data, d, size_t(len));
+    ++runs_[lastRun_].count;
+    ++written_;
+}
+
+const char* RetransCache::find(quint32 frameId, quint16 idx, int* len) const
+{
+    if (slots_.isEmpty() || lastRun_ < 0) return nullptr;
+    // 写序号小于 oldest 的槽已被覆盖
+    const quint64 oldest = written_ > quint64(kSlots) ? written_ - kSlots : 0;
+    auto match = [&](quint64 pos) -> const char* {
+        const Slot& s = slots_[int(pos % kSlots)];
+        if (s.len == 0 || s.frameId != frameId || s.idx != idx) return nullptr;
+        *len = s.len;
+        return s.data;
+    };
+    // 从最近一段往回找；同一帧可能因乱序被拆成多段
+    for (int k = 0; k < kRuns; ++k) {
+        const Run& r = runs_[(lastRun_ - k + kRuns) % kRuns];
+        const quint64 end = r.first + r.count;
+        if (r.count == 0 || end <= oldest) break;   // 更早的段也都已覆盖
+        if (r.frameId != frameId) continue;
+        const quint64 begin = qMax(r.first, oldest);
+        const quint64 guess = r.first + idx;
+        if (guess >= begin && guess < end) {
+            if (const char* p = match(guess)) return p;
+        }
+        for (quint64 pos = begin; pos < end; ++pos) {
+            if (const char* p = match(pos)) return p;
+        }
+    }
+    return nullptr;
+}
+
+void RetransCache::clear()
+{
+    slots_ = QVector<Slot>();   // 会话释放：连同缓冲一起归还
+    for (Run& r : runs_) r = Run();
+    lastRun_ = -1;
+    written_ = 0;
+}
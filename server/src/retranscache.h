@@ -0,0 +1,39 @@
+#pragma once
+#include <QtCore>
+
+// 单个发送方的重传缓存（UdpRelay 补发 NACK 请求的分片）
+// - 分片按到达顺序写入 kSlots 个槽组成的环，写游标前进即覆盖最旧的分片：始终保留最近 kSlots 个分片
+// - 最近 kRuns 段连续写入各记一条 [帧号, 起始写序号, 个数]；查找只在该帧写过的区间内进行，
+//   按序到达时起始序号 + idx 一次命中
+// - 槽内保存 (frameId, idx) 作校验，已被覆盖的分片返回未命中
+// 缓冲在首次写入时分配
+class RetransCache {
+public:
+    enum { kSlots = 256, kSlotBytes = 1536, kRuns = 64 };
+
+    // d/len 为完整数据报，超出槽容量的不缓存
+    void put(quint32 frameId, quint16 idx, const char* d, int len);
+    // 未命中返回 nullptr；返回的指针在下一次 put 之前有效
+    const char* find(quint32 frameId, quint16 idx, int* len) const;
+    void clear();
+    bool isEmpty() const { return slots_.isEmpty(); }
+
+private:
+    struct Slot {
+        quint32 frameId = 0;
+        quint16 idx = 0;
+        quint16 len = 0;  // 0 表示空
+        char data[kSlotBytes];
+    };
+    // 同一帧的一段连续写入
+    struct Run {
+        quint32 frameId = 0;
+        quint64 first = 0;
+        quint32 count = 0;  // 0 表示空
+    };
+
+    QVector<Slot> slots_;
+    Run runs_[kRuns];
+    int lastRun_ = -1;
+    quint64 written_ = 0;   // 累计写入的分片数（写游标）
+};
@@ -1,197 +1,108 @@
 #include "roomhub.h"
+#include "roomshard.h"
+#include "udprelay.h"
 
-RoomHub::RoomHub(QObject* parent) : QObject(parent) {}
+RoomHub::RoomHub(QObject* parent) : QObject(parent) {
+    statsDump_.setInterval(10000);
+    connect(&statsDump_, &QTimer::timeout, this, &RoomHub::onStatsDump);
+}
+
+RoomHub::~RoomHub() {
+    for (QThread* t : qAsConst(threads_)) {
+        t->quit();
+        t->wait();
+        delete t;
+    }
+}
+
+bool RoomHub::start(quint16 port, int shards) {
+    if (shards <= 0) shards = qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < shards; ++i) {
+        auto* t = new QThread;
+        t->setObjectName(QString("room-shard-%1").arg(i));
+        auto* s = new RoomShard(this, i);
+        s->moveToThread(t);
+        connect(t, &QThread::finished, s, &QObject::deleteLater);
+        threads_.push_back(t);
+        shards_.push_back(s);
+        t->start();
+    }
 
-bool RoomHub::start(quint16 port) {
     connect(&server_, &QTcpServer::newConnection, this, &RoomHub::onNewConnection);
     if (!server_.listen(QHostAddress::Any, port)) {
         qWarning() << "Listen failed on port" << port << ":" << server_.errorString();
         return false;
     }
-    qInfo() << "Server listening on" << server_.serverAddress().toString() << ":" << port;
+    qInfo() << "Server listening on" << server_.serverAddress().toString() << ":" << port
+            << "shards" << shards_.size();
+    statsDump_.start();
     return true;
 }
 
+RoomShard* RoomHub::shardFor(const QString& roomId) const {
+    if (roomId.isEmpty() || shards_.isEmpty()) return nullptr;
+    return shards_.at(int(qHash(roomId) % uint(shards_.size())));
+}
+
 void RoomHub::onNewConnection() {
     while (server_.hasPendingConnections()) {
         QTcpSocket* sock = server_.nextPendingConnection();
-        auto* ctx = new ClientCtx;
-        ctx->sock = sock;
-        clients_.insert(sock, ctx);
-
-        qInfo() << "New client from" << sock->peerAddress().toString() << sock->peerPort();
-
-        connect(sock, &QTcpSocket::readyRead, this, &RoomHub::onReadyRead);
-        connect(sock, &QTcpSocket::disconnected, this, &RoomHub::onDisconnected);
-    }
-}
-
-void RoomHub::onDisconnected() {
-    auto* sock = qobject_cast<QTcpSocket*>(sender());
-    if (!sock) return;
-    auto it = clients_.find(sock);
-    if (it == clients_.end()) return;
-    ClientCtx* c = it.value();
-
-    const QString oldRoom = c->roomId;
-    if (!oldRoom.isEmpty()) {
-        auto range = rooms_.equal_range(oldRoom);
-        for (auto i = range.first; i != range.second; ) {
-            if (i.value() == sock) i = rooms_.erase(i);
-            else ++i;
-        }
-        broadcastRoomMembers(oldRoom, "leave", c->user);
-    }
-
-    qInfo() << "Client disconnected" << c->user << c->roomId;
-    clients_.erase(it);
-    sock->deleteLater();
-    delete c;
-}
-
-void RoomHub::onReadyRead() {
-    auto* sock = qobject_cast<QTcpSocket*>(sender());
-    if (!sock) return;
-    auto it = clients_.find(sock);
-    if (it == clients_.end()) return;
-    ClientCtx* c = it.value();
-
-    c->buffer.append(sock->readAll());
-
-    QVector<Packet> pkts;
-    if (drainPackets(c->buffer, pkts)) {
-        for (const Packet& p : pkts) {
-            handlePacket(c, p);
-        }
-    }
-}
+        RoomShard* shard = shards_.at(nextShard_);
+        nextShard_ = (nextShard_ + 1) % shards_.size();
 
-void RoomHub::handlePacket(ClientCtx* c, const Packet& p) {
-    if (p.type == MSG_JOIN_WORKORDER) {
-        const QString roomId = p.json.value("roomId").toString();
-        const QString user   = p.json.value("user").toString();
-        if (roomId.isEmpty()) {
-            QJsonObject j{{"code",400},{"message","roomId required"}};
-            c->sock->write(buildPacket(MSG_SERVER_EVENT, j));
-            return;
-        }
-        c->user = user;
-        joinRoom(c, roomId);
-
-        // 加入确认
-        QJsonObject ack{{"code",0},{"message","joined"},{"roomId",roomId}};
-        c->sock->write(buildPacket(MSG_SERVER_EVENT, ack));
-
-        // 1) 单发当前成员列表给新加入者（快照）
-        sendRoomMembersTo(c->sock, roomId, "snapshot", c->user);
-
-        // 2) 广播“加入”事件给全房间
-        qInfo() << "Join" << roomId << "user" << (user.isEmpty() ? "(anonymous)" : user);
-        broadcastRoomMembers(roomId, "join", c->user);
-        return;
-    }
-
-    if (c->roomId.isEmpty()) {
-        QJsonObject j{{"code",403},{"message","join a room first"}};
-        c->sock->write(buildPacket(MSG_SERVER_EVENT, j));
-        return;
-    }
-
-    // 统一转发：文本/设备/视频/音频/控制/标注
-    if (p.type == MSG_TEXT ||
-        p.type == MSG_DEVICE_DATA ||
-        p.type == MSG_VIDEO_FRAME ||
-        p.type == MSG_AUDIO_FRAME ||
-        p.type == MSG_CONTROL ||
-        p.type == MSG_ANNOT)            // 新增：标注消息
-    {
-        // 标注没有二进制（bin 为空），但用统一打包即可
-        QByteArray raw = buildPacket(p.type, p.json, p.bin);
-        const bool isVideo = (p.type == MSG_VIDEO_FRAME);
-        // 视频帧在对端 backlog 太大时丢弃；其他消息（包含标注）不丢
-        broadcastToRoom(c->roomId, raw, c->sock, isVideo);
-
-        if (p.type == MSG_ANNOT) {
-            // 简单日志，便于排查
-            qInfo() << "[ANNOT] forwarded"
-                    << "room="   << c->roomId
-                    << "sender=" << p.json.value("sender").toString()
-                    << "target=" << p.json.value("target").toString()
-                    << "op="     << p.json.value("op").toString();
-        }
-        return;
-    }
-
-    QJsonObject j{{"code",404},{"message",QString("unknown type %1").arg(p.type)}};
-    c->sock->write(buildPacket(MSG_SERVER_EVENT, j));
-}
-
-void RoomHub::joinRoom(ClientCtx* c, const QString& roomId) {
-    if (!c->roomId.isEmpty()) {
-        auto range = rooms_.equal_range(c->roomId);
-        for (auto i = range.first; i != range.second; ) {
-            if (i.value() == c->sock) i = rooms_.erase(i);
-            else ++i;
-        }
+        // 交给分片线程：须先脱离 QTcpServer 父对象
+        sock->setParent(nullptr);
+        sock->moveToThread(shard->thread());
+        QMetaObject::invokeMethod(shard, [shard, sock]{ shard->adoptSocket(sock); }, Qt::QueuedConnection);
     }
-    c->roomId = roomId;
-    rooms_.insert(roomId, c->sock);
 }
 
-void RoomHub::broadcastToRoom(const QString& roomId,
-                              const QByteArray& packet,
-                              QTcpSocket* except,
-                              bool dropVideoIfBacklog) {
-    auto range = rooms_.equal_range(roomId);
-    for (auto i = range.first; i != range.second; ++i) {
-        QTcpSocket* s = i.value();
-        if (s == except) continue;
-        if (dropVideoIfBacklog && s->bytesToWrite() > kBacklogDropThreshold) {
-            continue; // 丢弃视频帧
+QJsonObject RoomHub::statsJson() const {
+    TrafficCounters<quint64> sum;
+    QJsonArray shards;
+    quint64 drops = 0;
+    int clients = 0;
+    for (const RoomShard* sh : shards_) {
+        const auto& t = sh->totals();
+        for (int k = 0; k < STAT_KIND_COUNT; ++k) {
+            sum.pktIn[k]    += t.pktIn[k].load();
+            sum.bytesIn[k]  += t.bytesIn[k].load();
+            sum.pktOut[k]   += t.pktOut[k].load();
+            sum.bytesOut[k] += t.bytesOut[k].load();
         }
-        s->write(packet);
-    }
-}
-
-QStringList RoomHub::listMembers(const QString& roomId) const {
-    QStringList members;
-    auto range = rooms_.equal_range(roomId);
-    for (auto i = range.first; i != range.second; ++i) {
-        QTcpSocket* s = i.value();
-        if (!clients_.contains(s)) continue;
-        auto* c = clients_.value(s);
-        if (!c->user.isEmpty()) members << c->user;
-        else members << QString("peer-%1").arg(reinterpret_cast<quintptr>(s));
+        drops   += sh->queueDrops();
+        clients += sh->clientCount();
+        shards.append(QJsonObject{
+            {"clients", sh->clientCount()},
+            {"drops", double(sh->queueDrops())},
+            {"fanout", sh->fanout().toJson()}
+        });
     }
-    members.removeDuplicates();
-    members.sort();
-    return members;
-}
-
-void RoomHub::broadcastRoomMembers(const QString& roomId, const QString& event, const QString& whoChanged) {
     QJsonObject j{
-        {"code", 0},
-        {"kind", "room"},
-        {"event", event},          // "join"/"leave"/"snapshot"
-        {"roomId", roomId},
-        {"who", whoChanged},
-        {"members", QJsonArray::fromStringList(listMembers(roomId))},
-        {"ts", QDateTime::currentMSecsSinceEpoch()}
+        {"clients", clients},
+        {"drops", double(drops)},
+        {"traffic", sum.toJson()},
+        {"shards", shards}
     };
-    QByteArray pkt = buildPacket(MSG_SERVER_EVENT, j);
-    broadcastToRoom(roomId, pkt, nullptr, false);
+    if (relay_) j["udp"] = relay_->statsJson();
+    return j;
 }
 
-void RoomHub::sendRoomMembersTo(QTcpSocket* target, const QString& roomId, const QString& event, const QString& whoChanged) {
-    if (!target) return;
-    QJsonObject j{
-        {"code", 0},
-        {"kind", "room"},
-        {"event", event},          // 如 "snapshot"
-        {"roomId", roomId},
-        {"who", whoChanged},
-        {"members", QJsonArray::fromStringList(listMembers(roomId))},
-        {"ts", QDateTime::currentMSecsSinceEpoch()}
-    };
-    target->write(buildPacket(MSG_SERVER_EVENT, j));
-}
\ No newline at end of file
+void RoomHub::onStatsDump() {
+    quint64 in = 0, out = 0, bin = 0, bout = 0, drops = 0;
+    qint64 p99 = 0;
+    int clients = 0;
+    for (const RoomShard* sh : qAsConst(shards_)) {
+        in   += sh->totals().totalPktIn();
+        out  += sh->totals().totalPktOut();
+        bin  += sh->totals().totalBytesIn();
+        bout += sh->totals().totalBytesOut();
+        drops   += sh->queueDrops();
+        clients += sh->clientCount();
+        p99 = qMax(p99, sh->fanout().percentileUs(0.99));
+    }
+    if (in == lastDumpIn_) return; // 无流量不刷屏
+    lastDumpIn_ = in;
+    qInfo().noquote() << QString("[STATS] hub clients=%1 in=%2/%3B out=%4/%5B drops=%6 fanout p99(max shard)=%7us")
+                         .arg(clients).arg(in).arg(bin).arg(out).arg(bout).arg(drops).arg(p99);
+}
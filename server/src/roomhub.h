@@ -3,41 +3,37 @@
 #include <QtNetwork>
 #include "protocol.h"
 
-struct ClientCtx {
-    QTcpSocket* sock = nullptr;
-    QString user;
-    QString roomId;
-    QByteArray buffer;
-};
+class RoomShard;
+class UdpRelay;
 
+// 接入层：只负责 accept，把连接分发给各 RoomShard 工作线程
 class RoomHub : public QObject {
     Q_OBJECT
 public:
     explicit RoomHub(QObject* parent=nullptr);
-    bool start(quint16 port);
+    ~RoomHub() override;
+
+    // shards <= 0 时按 CPU 核数创建
+    bool start(quint16 port, int shards = 0);
+
+    // 房间固定所在的分片（线程安全：分片表在 start() 后不再变化）
+    RoomShard* shardFor(const QString& roomId) const;
+
+    // 全局统计快照：只读各分片/中继的原子计数，可在任意线程调用
+    QJsonObject statsJson() const;
+    // 须在 start() 之前调用：relay_ 之后由分片线程只读；relay 须比 RoomHub 活得久
+    void setUdpRelay(const UdpRelay* relay) { relay_ = relay; }
 
 private slots:
     void onNewConnection();
-    void onReadyRead();
-    void onDisconnected();
+    void onStatsDump();
 
 private:
     QTcpServer server_;
-    QHash<QTcpSocket*, ClientCtx*> clients_;
-    QMultiHash<QString, QTcpSocket*> rooms_; // roomId -> sockets
-
-    static constexpr qint64 kBacklogDropThreshold = 3 * 1024 * 1024; // 3MB
-
-    void handlePacket(ClientCtx* c, const Packet& p);
-    void joinRoom(ClientCtx* c, const QString& roomId);
-    void broadcastToRoom(const QString& roomId,
-                         const QByteArray& packet,
-                         QTcpSocket* except = nullptr,
-                         bool dropVideoIfBacklog = false);
-
-    QStringList listMembers(const QString& roomId) const;
-    void broadcastRoomMembers(const QString& roomId, const QString& event, const QString& whoChanged);
-
-    // 新增：给指定 socket 发送当前成员列表（用于刚加入的人）
-    void sendRoomMembersTo(QTcpSocket* target, const QString& roomId, const QString& event, const QString& whoChanged);
+    QVector<QThread*>   threads_;
+    QVector<RoomShard*> shards_;
+    int nextShard_ = 0; // 新连接轮询分配，JOIN 后再迁往房间所在分片
+    const UdpRelay* relay_ = nullptr;
+    QTimer statsDump_;
+    quint64 lastDumpIn_ = 0;
 };
@@ -0,0 +1,475 @@
+#include "roomshard.h"
+#include "roomhub.h"
+
+RoomShard::RoomShard(RoomHub* hub, int index, QObject* parent)
+    : QObject(parent), hub_(hub), index_(index), report_(this)
+{
+    report_.setInterval(10000);
+    connect(&report_, &QTimer::timeout, this, &RoomShard::onReport);
+}
+
+void RoomShard::adoptSocket(QTcpSocket* sock) {
+    if (!report_.isActive()) report_.start(); // 须在分片线程内启动
+    auto* ctx = new ClientCtx;
+    ctx->sock = sock;
+    qInfo() << "New client from" << sock->peerAddress().toString() << sock->peerPort()
+            << "shard" << index_;
+    adoptClient(ctx);
+}
+
+void RoomShard::adoptClient(ClientCtx* c) {
+    clients_.insert(c->sock, c);
+    clientCount_.store(clients_.size());
+    connect(c->sock, &QTcpSocket::readyRead, this, &RoomShard::onReadyRead);
+    connect(c->sock, &QTcpSocket::disconnected, this, &RoomShard::onDisconnected);
+    connect(c->sock, &QTcpSocket::bytesWritten, this, &RoomShard::onBytesWritten);
+
+    // 迁移途中可能已断开或已有数据到达（此前无接收者，信号已丢失）
+    if (c->sock->state() != QAbstractSocket::ConnectedState) {
+        dropClient(c);
+        return;
+    }
+    processIncoming(c);
+}
+
+void RoomShard::onDisconnected() {
+    auto* sock = qobject_cast<QTcpSocket*>(sender());
+    if (!sock) return;
+    if (ClientCtx* c = clients_.value(sock, nullptr)) dropClient(c);
+}
+
+void RoomShard::dropClient(ClientCtx* c) {
+    leaveRoom(c);
+    qInfo() << "Client disconnected" << c->user << "shard" << index_;
+    clients_.remove(c->sock);
+    clientCount_.store(clients_.size());
+    droppedGone_ += c->txq.totalDropped();
+    c->sock->deleteLater();
+    delete c;
+}
+
+void RoomShard::onReadyRead() {
+    auto* sock = qobject_cast<QTcpSocket*>(sender());
+    if (!sock) return;
+    if (ClientCtx* c = clients_.value(sock, nullptr)) processIncoming(c);
+}
+
+void RoomShard::processIncoming(ClientCtx* c) {
+    c->rx.append(c->sock->readAll());
+
+    // 视图引用 c->rx 内存，需在下一次 append 之前同步处理完
+    QVector<PacketView> pkts;
+    if (!drainPacketViews(c->rx, pkts)) return;
+
+    for (int i = 0; i < pkts.size(); ++i) {
+        const PacketView& p = pkts[i];
+        if (p.type == MSG_JOIN_WORKORDER) {
+            RoomShard* target = hub_->shardFor(p.json().value("roomId").toString());
+            if (target && target != this) {
+                // 房间固定在其他分片：本条 JOIN 及其后字节随连接一并移交
+                QByteArray pending;
+                for (int k = i; k < pkts.size(); ++k) pending.append(pkts[k].raw);
+                pending.append(c->rx.data(), c->rx.size());
+                migrateClient(c, target, pending);
+                return;
+            }
+        }
+        c->traffic.addIn(p.type, p.raw.size());
+        if (c->roomStats) c->roomStats->traffic.addIn(p.type, p.raw.size());
+        totals_.addIn(p.type, p.raw.size());
+        handlePacket(c, p);
+    }
+}
+
+void RoomShard::migrateClient(ClientCtx* c, RoomShard* target, const QByteArray& pending) {
+    leaveRoom(c);
+    clients_.remove(c->sock);
+    clientCount_.store(clients_.size());
+    disconnect(c->sock, nullptr, this, nullptr);
+
+    c->streamId = 0;    // 由目标分片重新分配
+    c->rx.clear();
+    c->rx.append(pending);
+
+    // 只能由当前所属线程推送给目标线程
+    c->sock->moveToThread(target->thread());
+    QMetaObject::invokeMethod(target, [target, c]{ target->adoptClient(c); }, Qt::QueuedConnection);
+}
+
+void RoomShard::handlePacket(ClientCtx* c, const PacketView& p) {
+    if (p.type == MSG_JOIN_WORKORDER) {
+        const QJsonObject json = p.json();
+        const QString roomId = json.value("roomId").toString();
+        const QString user   = json.value("user").toString();
+        if (roomId.isEmpty()) {
+            QJsonObject j{{"code",400},{"message","roomId required"}};
+            sendTo(c, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, j));
+            return;
+        }
+        c->user = user;
+        // 协议协商：新客户端携带 proto>=2，可收发 v2 二进制媒体帧
+        c->mediaV2 = json.value("proto").toInt(1) >= 2;
+        if (c->streamId == 0) c->streamId = allocStreamId();
+        joinRoom(c, roomId);
+
+        // 加入确认（带协商结果与本连接的 streamId）
+        QJsonObject ack{{"code",0},{"message","joined"},{"roomId",roomId},
+                        {"proto", c->mediaV2 ? kProtoVersion : 1},
+                        {"streamId", int(c->streamId)}};
+        sendTo(c, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, ack));
+
+        // 1) 单发当前成员列表给新加入者（快照）
+        sendRoomMembersTo(c, roomId, "snapshot", c->user);
+
+        // 2) 广播“加入”事件给全房间
+        qInfo() << "Join" << roomId << "user" << (user.isEmpty() ? "(anonymous)" : user) << "shard" << index_;
+        broadcastRoomMembers(roomId, "join", c->user);
+        return;
+    }
+
+    // 统计查询：{kind:"stats"}，无需先加入房间
+    if (p.type == MSG_SERVER_EVENT) {
+        if (p.json().value("kind").toString() == QLatin1String("stats")) {
+            sendTo(c, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, statsJson(c)));
+        }
+        return;
+    }
+
+    if (c->roomId.isEmpty()) {
+        QJsonObject j{{"code",403},{"message","join a room first"}};
+        sendTo(c, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, j));
+        return;
+    }
+
+    // v2 媒体帧：校验流 id，老客户端回退为 v1 JSON 帧
+    if (isMediaV2(p.type)) {
+        forwardMediaV2(c, p);
+        return;
+    }
+
+    // 统一转发：文本/设备/视频/音频/控制/标注
+    if (p.type == MSG_TEXT ||
+        p.type == MSG_DEVICE_DATA ||
+        p.type == MSG_VIDEO_FRAME ||
+        p.type == MSG_AUDIO_FRAME ||
+        p.type == MSG_CONTROL ||
+        p.type == MSG_ANNOT)            // 新增：标注消息
+    {
+        // 快速路径：路由只依赖连接上下文中的 roomId，JSON 头无需解析/重打包，原始帧字节直接转发
+        // 优先级：控制/标注 > 音频 > 视频；媒体按时延预算丢弃，其他消息（包含标注）不丢
+        const SendQueue::Prio prio = p.type == MSG_VIDEO_FRAME ? SendQueue::Video
+                                   : p.type == MSG_AUDIO_FRAME ? SendQueue::Audio
+                                   : SendQueue::Control;
+        QElapsedTimer fan; fan.start();
+        broadcastToRoom(c->roomId, p.raw, c->sock, prio);
+        fanout_.record(fan.nsecsElapsed() / 1000);
+
+        int suppressed = 0;
+        if (p.type == MSG_ANNOT && annotLog_.allow(QDateTime::currentMSecsSinceEpoch(), &suppressed)) {
+            // 限速日志，便于排查（仅放行时解析 JSON）
+            const QJsonObject json = p.json();
+            qInfo() << "[ANNOT] forwarded"
+                    << "room="   << c->roomId
+                    << "sender=" << json.value("sender").toString()
+                    << "target=" << json.value("target").toString()
+                    << "op="     << json.value("op").toString()
+                    << "suppressed=" << suppressed;
+        }
+        return;
+    }
+
+    QJsonObject j{{"code",404},{"message",QString("unknown type %1").arg(p.type)}};
+    sendTo(c, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, j));
+}
+
+void RoomShard::forwardMediaV2(ClientCtx* c, const PacketView& p) {
+    MediaHeader h; int payloadOff = 0;
+    if (!parseMediaHeader(p.type, p.bin, h, payloadOff)) return;
+    if (h.streamId != c->streamId) return; // 冒用他人流 id，丢弃
+
+    // 仅当房间内存在 v1 客户端时才构造回退帧（每次广播最多一次）
+    QByteArray legacy;
+    auto range = rooms_.equal_range(c->roomId);
+    for (auto i = range.first; i != range.second; ++i) {
+        const ClientCtx* peer = clients_.value(i.value(), nullptr);
+        if (peer && peer != c && !peer->mediaV2) {
+            legacy = buildLegacyMedia(c, p, h, payloadOff);
+            break;
+        }
+    }
+
+    const SendQueue::Prio prio = p.type == MSG_AUDIO_FRAME_V2     ? SendQueue::Audio
+                               : (h.flags & kMediaFlagKey)        ? SendQueue::VideoKey
+                               : SendQueue::Video;
+    QElapsedTimer fan; fan.start();
+    broadcastToRoom(c->roomId, p.raw, c->sock, prio, legacy);
+    fanout_.record(fan.nsecsElapsed() / 1000);
+}
+
+QByteArray RoomShard::buildLegacyMedia(const ClientCtx* c, const PacketView& p,
+                                     const MediaHeader& h, int payloadOff) const {
+    const QByteArray payload = QByteArray::fromRawData(p.bin.constData() + payloadOff,
+                                                       p.bin.size() - payloadOff);
+    // v2 头只带 32 位时间戳，回退帧使用服务器时间
+    QJsonObject j{
+        {"roomId", c->roomId},
+        {"sender", c->user},
+        {"seq",    int(h.seq)},
+        {"ts",     QDateTime::currentMSecsSinceEpoch()}
+    };
+    if (p.type == MSG_AUDIO_FRAME_V2) {
+        if (h.codec == CODEC_MULAW)      j["codec"] = "mulaw";
+        else if (h.codec == CODEC_PCM16) j["codec"] = "pcm16";
+        else return QByteArray();
+        j["sr"] = 8000;
+        j["ch"] = 1;
+        return buildPacket(MSG_AUDIO_FRAME, j, payload);
+    }
+    if (h.codec != CODEC_JPEG) return QByteArray();
+    j["media"] = "camera";
+    j["w"] = int(h.w);
+    j["h"] = int(h.h);
+    return buildPacket(MSG_VIDEO_FRAME, j, payload);
+}
+
+quint16 RoomShard::allocStreamId() {
+    for (;;) {
+        const quint16 id = nextStreamId_++;
+        if (id == 0) continue; // 0 表示未分配
+        bool used = false;
+        for (const ClientCtx* c : qAsConst(clients_)) {
+            if (c->streamId == id) { used = true; break; }
+        }
+        if (!used) return id;
+    }
+}
+
+void RoomShard::joinRoom(ClientCtx* c, const QString& roomId) {
+    if (!c->roomId.isEmpty()) {
+        auto range = rooms_.equal_range(c->roomId);
+        for (auto i = range.first; i != range.second; ) {
+            if (i.value() == c->sock) i = rooms_.erase(i);
+            else ++i;
+        }
+        c->roomStats = nullptr;
+        releaseRoomStats(c->roomId);
+    }
+    c->roomId = roomId;
+    rooms_.insert(roomId, c->sock);
+    RoomStats*& rs = roomStats_[roomId];
+    if (!rs) rs = new RoomStats;
+    c->roomStats = rs;
+}
+
+void RoomShard::releaseRoomStats(const QString& roomId) {
+    if (rooms_.contains(roomId)) return;
+    delete roomStats_.take(roomId);
+}
+
+void RoomShard::leaveRoom(ClientCtx* c) {
+    const QString oldRoom = c->roomId;
+    if (oldRoom.isEmpty()) return;
+    auto range = rooms_.equal_range(oldRoom);
+    for (auto i = range.first; i != range.second; ) {
+        if (i.value() == c->sock) i = rooms_.erase(i);
+        else ++i;
+    }
+    c->roomId.clear();
+    c->roomStats = nullptr;
+    broadcastRoomMembers(oldRoom, "leave", c->user);
+    releaseRoomStats(oldRoom);
+}
+
+void RoomShard::broadcastToRoom(const QString& roomId,
+                              const QByteArray& packet,
+                              QTcpSocket* except,
+                              SendQueue::Prio prio,
+                              const QByteArray& legacyPacket) {
+    QByteArray owned; // packet 可能是接收缓冲视图：仅在需要入队时复制一次，各订阅者队列共享
+    auto range = rooms_.equal_range(roomId);
+    for (auto i = range.first; i != range.second; ++i) {
+        QTcpSocket* s = i.value();
+        if (s == except) continue;
+        ClientCtx* peer = clients_.value(s, nullptr);
+        if (!peer) continue;
+        if (!legacyPacket.isEmpty() && !peer->mediaV2) {
+            sendTo(peer, prio, legacyPacket);
+            continue;
+        }
+        sendTo(peer, prio, packet, &owned);
+    }
+}
+
+void RoomShard::sendTo(ClientCtx* c, SendQueue::Prio prio, const QByteArray& pkt, QByteArray* owned) {
+    if (c->closing) return;
+    const quint16 type = peekPacketType(pkt);
+    c->traffic.addOut(type, pkt.size());
+    if (c->roomStats) c->roomStats->traffic.addOut(type, pkt.size());
+    totals_.addOut(type, pkt.size());
+
+    // 畅通时直接写 socket（socket 自行拷贝），不经过队列
+    if (c->txq.isEmpty() && c->sock->bytesToWrite() < kSocketHighWater) {
+        c->sock->write(pkt);
+        return;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool queued;
+    if (owned) {
+        if (owned->isNull()) *owned = QByteArray(pkt.constData(), pkt.size());
+        queued = c->txq.push(prio, *owned, now);
+    } else {
+        queued = c->txq.push(prio, pkt, now);
+    }
+    if (!queued) {
+        // 控制消息不能丢：订阅者长期跟不上，断开让其重连后重新同步
+        // 调用方可能正在遍历房间成员，断开推迟到事件循环（disconnected -> dropClient）
+        qWarning() << "Control backlog over limit, disconnect" << c->user << "shard" << index_;
+        c->closing = true;
+        QTcpSocket* sock = c->sock;
+        QTimer::singleShot(0, sock, [sock]{ sock->abort(); });
+        return;
+    }
+    pumpQueue(c);
+}
+
+void RoomShard::pumpQueue(ClientCtx* c) {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QByteArray pkt;
+    while (c->sock->bytesToWrite() < kSocketHighWater && c->txq.pop(now, pkt)) {
+        c->sock->write(pkt);
+    }
+}
+
+void RoomShard::onBytesWritten() {
+    auto* sock = qobject_cast<QTcpSocket*>(sender());
+    if (!sock) return;
+    if (ClientCtx* c = clients_.value(sock, nullptr)) pumpQueue(c);
+}
+
+void RoomShard::onReport() {
+    // 分片汇总 + 每房间一行（仅有流量的房间）
+    quint64 drops = droppedGone_;
+    for (const ClientCtx* c : qAsConst(clients_)) drops += c->txq.totalDropped();
+    queueDrops_.store(drops);
+
+    if (totals_.totalPktIn() != lastReportedIn_) {
+        lastReportedIn_ = totals_.totalPktIn();
+        qInfo().noquote() << QString("[STATS] shard %1 clients=%2 rooms=%3 in=%4/%5B out=%6/%7B drops=%8 fanout p50=%9us p99=%10us")
+                             .arg(index_).arg(clients_.size()).arg(roomStats_.size())
+                             .arg(totals_.totalPktIn()).arg(totals_.totalBytesIn())
+                             .arg(totals_.totalPktOut()).arg(totals_.totalBytesOut())
+                             .arg(drops).arg(fanout_.percentileUs(0.50)).arg(fanout_.percentileUs(0.99));
+        for (auto it = roomStats_.constBegin(); it != roomStats_.constEnd(); ++it) {
+            const auto& t = it.value()->traffic;
+            qInfo().noquote() << QString("[STATS]   room %1 members=%2 in=%3/%4B out=%5/%6B")
+                                 .arg(it.key()).arg(rooms_.count(it.key()))
+                                 .arg(t.totalPktIn()).arg(t.totalBytesIn())
+                                 .arg(t.totalPktOut()).arg(t.totalBytesOut());
+        }
+    }
+
+    // 只报告新增丢弃的订阅者，便于定位谁在掉队
+    for (ClientCtx* c : qAsConst(clients_)) {
+        const quint64 drops = c->txq.totalDropped();
+        if (drops == c->reportedDrops) continue;
+        c->reportedDrops = drops;
+        qInfo() << "[QUEUE] shard" << index_ << "user" << c->user << "room" << c->roomId
+                << "depth c/a/k/v"
+                << c->txq.depth(SendQueue::Control) << c->txq.depth(SendQueue::Audio)
+                << c->txq.depth(SendQueue::VideoKey) << c->txq.depth(SendQueue::Video)
+                << "drops a/k/v"
+                << c->txq.dropped(SendQueue::Audio) << c->txq.dropped(SendQueue::VideoKey)
+                << c->txq.dropped(SendQueue::Video)
+                << "socketBacklog" << c->sock->bytesToWrite();
+    }
+}
+
+QJsonObject RoomShard::statsJson(const ClientCtx* requester) const {
+    QJsonObject j{
+        {"code", 0},
+        {"kind", "stats"},
+        {"shard", index_},
+        {"server", hub_->statsJson()},
+        {"ts", QDateTime::currentMSecsSinceEpoch()}
+    };
+    const QString roomId = requester->roomId;
+    if (roomId.isEmpty()) return j;
+
+    QJsonArray clients;
+    auto range = rooms_.equal_range(roomId);
+    for (auto i = range.first; i != range.second; ++i) {
+        const ClientCtx* c = clients_.value(i.value(), nullptr);
+        if (!c) continue;
+        clients.append(QJsonObject{
+            {"user", c->user},
+            {"traffic", c->traffic.toJson()},
+            {"queue", QJsonArray{c->txq.depth(SendQueue::Control), c->txq.depth(SendQueue::Audio),
+                                 c->txq.depth(SendQueue::VideoKey), c->txq.depth(SendQueue::Video)}},
+            {"drops", double(c->txq.totalDropped())},
+            {"socketBacklog", double(c->sock->bytesToWrite())}
+        });
+    }
+    const RoomStats* rs = roomStats_.value(roomId, nullptr);
+    j["room"] = QJsonObject{
+        {"roomId", roomId},
+        {"traffic", rs ? rs->traffic.toJson() : QJsonObject{}},
+        {"clients", clients}
+    };
+    return j;
+}
+
+QJsonObject RoomShard::listStreams(const QString& roomId) const {
+    QJsonObject streams; // user -> streamId，供 v2 客户端还原媒体帧发送者
+    auto range = rooms_.equal_range(roomId);
+    for (auto i = range.first; i != range.second; ++i) {
+        const ClientCtx* c = clients_.value(i.value(), nullptr);
+        if (!c || c->user.isEmpty() || c->streamId == 0) continue;
+        streams.insert(c->user, int(c->streamId));
+    }
+    return streams;
+}
+
+QStringList RoomShard::listMembers(const QString& roomId) const {
+    QStringList members;
+    auto range = rooms_.equal_range(roomId);
+    for (auto i = range.first; i != range.second; ++i) {
+        QTcpSocket* s = i.value();
+        if (!clients_.contains(s)) continue;
+        auto* c = clients_.value(s);
+        if (!c->user.isEmpty()) members << c->user;
+        else members << QString("peer-%1").arg(reinterpret_cast<quintptr>(s));
+    }
+    members.removeDuplicates();
+    members.sort();
+    return members;
+}
+
+void RoomShard::broadcastRoomMembers(const QString& roomId, const QString& event, const QString& whoChanged) {
+    QJsonObject j{
+        {"code", 0},
+        {"kind", "room"},
+        {"event", event},          // "join"/"leave"/"snapshot"
+        {"roomId", roomId},
+        {"who", whoChanged},
+        {"members", QJsonArray::fromStringList(listMembers(roomId))},
+        {"streams", listStreams(roomId)},
+        {"ts", QDateTime::currentMSecsSinceEpoch()}
+    };
+    QByteArray pkt = buildPacket(MSG_SERVER_EVENT, j);
+    broadcastToRoom(roomId, pkt, nullptr, SendQueue::Control);
+}
+
+void RoomShard::sendRoomMembersTo(ClientCtx* target, const QString& roomId, const QString& event, const QString& whoChanged) {
+    if (!target) return;
+    QJsonObject j{
+        {"code", 0},
+        {"kind", "room"},
+        {"event", event},          // 如 "snapshot"
+        {"roomId", roomId},
+        {"who", whoChanged},
+        {"members", QJsonArray::fromStringList(listMembers(roomId))},
+        {"streams", listStreams(roomId)},
+        {"ts", QDateTime::currentMSecsSinceEpoch()}
+    };
+    sendTo(target, SendQueue::Control, buildPacket(MSG_SERVER_EVENT, j));
+}
\ No newline at end of file
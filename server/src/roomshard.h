@@ -0,0 +1,102 @@
+#pragma once
+#include <QtCore>
+#include <QtNetwork>
+#include "protocol.h"
+#include "sendqueue.h"
+#include "hubstats.h"
+
+class RoomHub;
+
+struct RoomStats {
+    TrafficCounters<quint64> traffic;
+};
+
+struct ClientCtx {
+    QTcpSocket* sock = nullptr;
+    QString user;
+    QString roomId;
+    RecvBuffer rx;   // 读游标式接收缓冲，拆包不逐帧拷贝
+    quint16 streamId = 0;  // v2 媒体头中的数值流 id（加入房间时分配）
+    bool mediaV2 = false;  // 加入时协商：是否支持 v2 媒体帧
+    SendQueue txq;         // socket 积压时的有界优先级队列
+    bool closing = false;  // 控制消息积压超限，已安排断开，不再发送
+    quint64 reportedDrops = 0;
+    TrafficCounters<quint64> traffic;  // 本连接收发统计（分片线程独写）
+    RoomStats* roomStats = nullptr;    // 所在房间统计（由分片持有）
+};
+
+// 房间分片：运行在独立线程的事件循环上，独占其连接与房间
+// - 房间按 roomId 固定到某个分片（RoomHub::shardFor），广播只在本线程内进行
+// - 加入其他分片的房间时，连接连同未处理字节迁移到目标分片
+class RoomShard : public QObject {
+    Q_OBJECT
+public:
+    RoomShard(RoomHub* hub, int index, QObject* parent=nullptr);
+    int index() const { return index_; }
+
+    // 以下两个入口只能在本分片线程内调用（跨线程请用 QueuedConnection）
+    void adoptSocket(QTcpSocket* sock);
+    void adoptClient(ClientCtx* c);
+
+    // 以下统计可在任意线程读取（原子量）
+    const TrafficCounters<QAtomicInteger<quint64>>& totals() const { return totals_; }
+    const LatencyHistogram& fanout() const { return fanout_; }
+    quint64 queueDrops() const { return queueDrops_.load(); }
+    int clientCount() const { return clientCount_.load(); }
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+    void onBytesWritten();
+    void onReport();
+
+private:
+    RoomHub* hub_;
+    int index_;
+    QHash<QTcpSocket*, ClientCtx*> clients_;
+    QMultiHash<QString, QTcpSocket*> rooms_; // roomId -> sockets
+    quint16 nextStreamId_ = 1;
+    QTimer report_;
+
+    // 统计：每房间/每客户端为普通计数，分片总计为原子量（供 RoomHub 跨线程汇总）
+    QHash<QString, RoomStats*> roomStats_;
+    TrafficCounters<QAtomicInteger<quint64>> totals_;
+    LatencyHistogram fanout_;        // 单次广播扇出耗时
+    QAtomicInteger<quint64> queueDrops_{0};
+    QAtomicInt clientCount_{0};
+    quint64 droppedGone_ = 0;        // 已断开连接累计的丢弃数
+    quint64 lastReportedIn_ = 0;
+    LogLimiter annotLog_;
+
+    // socket 内部缓冲的高水位：超过后改走 SendQueue，让音频/控制插队、过期视频丢弃
+    static constexpr qint64 kSocketHighWater = 128 * 1024;
+
+    void processIncoming(ClientCtx* c);
+    void migrateClient(ClientCtx* c, RoomShard* target, const QByteArray& pending);
+    void dropClient(ClientCtx* c);
+
+    void handlePacket(ClientCtx* c, const PacketView& p);
+    void joinRoom(ClientCtx* c, const QString& roomId);
+    void leaveRoom(ClientCtx* c);
+    void releaseRoomStats(const QString& roomId);
+    QJsonObject statsJson(const ClientCtx* requester) const;
+    void broadcastToRoom(const QString& roomId,
+                         const QByteArray& packet,
+                         QTcpSocket* except = nullptr,
+                         SendQueue::Prio prio = SendQueue::Control,
+                         const QByteArray& legacyPacket = QByteArray()); // 非空时发给未协商 v2 的客户端
+    // owned 非空表示 pkt 可能是视图，入队前需持有副本（由调用方在一次广播内复用）
+    void sendTo(ClientCtx* c, SendQueue::Prio prio, const QByteArray& pkt, QByteArray* owned = nullptr);
+    void pumpQueue(ClientCtx* c);
+
+    void forwardMediaV2(ClientCtx* c, const PacketView& p);
+    QByteArray buildLegacyMedia(const ClientCtx* c, const PacketView& p, const MediaHeader& h, int payloadOff) const;
+    quint16 allocStreamId();
+
+    QStringList listMembers(const QString& roomId) const;
+    QJsonObject listStreams(const QString& roomId) const;
+    void broadcastRoomMembers(const QString& roomId, const QString& event, const QString& whoChanged);
+
+    // 新增：给指定 socket 发送当前成员列表（用于刚加入的人）
+    void sendRoomMembersTo(ClientCtx* target, const QString& roomId, const QString& event, const QString& whoChanged);
+};
@@ -0,0 +1,69 @@
+#include "sendqueue.h"
+
+int SendQueue::maxDepth(Prio prio)
+{
+    switch (prio) {
+    case Audio:    return 25; // 约 500ms（20ms/帧）
+    case VideoKey: return 2;
+    case Video:    return 3;
+    default:       return 0;  // 控制消息不丢，上限见 kMaxControl/kMaxControlBytes
+    }
+}
+
+qint64 SendQueue::budgetMs(Prio prio)
+{
+    switch (prio) {
+    case Audio:    return 400;
+    case VideoKey: return 1000;
+    case Video:    return 300;
+    default:       return 0;
+    }
+}
+
+bool SendQueue::push(Prio prio, const QByteArray& pkt, qint64 nowMs)
+{
+    QQueue<Item>& q = q_[prio];
+    if (prio == Control) {
+        if (q.size() >= kMaxControl || controlBytes_ + pkt.size() > kMaxControlBytes) return false;
+        controlBytes_ += pkt.size();
+    }
+    const int cap = maxDepth(prio);
+    while (cap > 0 && q.size() >= cap) { // 丢最旧，保留最新
+        q.dequeue();
+        ++drops_[prio];
+    }
+    q.enqueue(Item{pkt, nowMs});
+    return true;
+}
+
+bool SendQueue::pop(qint64 nowMs, QByteArray& out)
+{
+    for (int p = 0; p < PrioCount; ++p) {
+        QQueue<Item>& q = q_[p];
+        const qint64 budget = budgetMs(Prio(p));
+        while (!q.isEmpty()) {
+            Item it = q.dequeue();
+            if (p == Control) controlBytes_ -= it.pkt.size();
+            if (budget > 0 && nowMs - it.enqMs > budget) { // 已超时延预算，发出去也没意义
+                ++drops_[p];
+                continue;
+            }
+            out = it.pkt;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SendQueue::isEmpty() const
+{
+    for (const auto& q : q_) if (!q.isEmpty()) return false;
+    return true;
+}
+
+quint64 SendQueue::totalDropped() const
+{
+    quint64 n = 0;
+    for (quint64 d : drops_) n += d;
+    return n;
+}
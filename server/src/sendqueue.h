@@ -0,0 +1,35 @@
+#pragma once
+#include <QtCore>
+
+// 每个订阅者的小型有界发送队列（按优先级出队）
+// - 控制/标注不丢弃；积压超过条数/字节上限时 push 返回 false，由调用方断开该订阅者
+// - 音频/视频按“时延预算”丢弃过期帧，超出深度时丢弃最旧帧
+// - 只在 socket 积压时才入队；畅通时直接写 socket，不经过队列
+class SendQueue {
+public:
+    enum Prio { Control = 0, Audio, VideoKey, Video, PrioCount };
+
+    // 控制队列超限时不入队并返回 false（订阅者已跟不上，应断开）
+    bool push(Prio prio, const QByteArray& pkt, qint64 nowMs);
+    bool pop(qint64 nowMs, QByteArray& out);
+
+    bool isEmpty() const;
+    int depth(Prio prio) const { return q_[prio].size(); }
+    quint64 dropped(Prio prio) const { return drops_[prio]; }
+    quint64 totalDropped() const;
+
+private:
+    struct Item {
+        QByteArray pkt;
+        qint64 enqMs = 0;
+    };
+
+    enum { kMaxControl = 512, kMaxControlBytes = 8 * 1024 * 1024 };
+
+    static int maxDepth(Prio prio);
+    static qint64 budgetMs(Prio prio); // 0 表示不限
+
+    QQueue<Item> q_[PrioCount];
+    quint64 drops_[PrioCount] = {};
+    qint64 controlBytes_ = 0;
+};
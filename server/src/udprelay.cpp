@@ -1,86 +1,543 @@
 #include "udprelay.h"
+#include "hubstats.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+namespace {
+// QDataStream 序列化的 QString：[u32 字节数][UTF-16BE]，0xFFFFFFFF 表示空串
+bool readRawString(const uchar*& p, const uchar* end, const uchar*& s, int& bytes)
+{
+    if (end - p < 4) return false;
+    const quint32 n = qFromBigEndian<quint32>(p);
+    p += 4;
+    if (n == 0xFFFFFFFFu) { s = p; bytes = 0; return true; }
+    if ((n & 1u) || n > quint32(end - p)) return false;
+    s = p; bytes = int(n);
+    p += n;
+    return true;
+}
+
+QString decodeUtf16BE(const uchar* s, int bytes)
+{
+    QString out(bytes / 2, Qt::Uninitialized);
+    QChar* dst = out.data();
+    for (int i = 0; i < bytes / 2; ++i)
+        dst[i] = QChar(qFromBigEndian<quint16>(s + i * 2));
+    return out;
+}
+} // namespace
+
+#ifdef Q_OS_LINUX
+// 预分配的收发数组：一次 new，生命周期与中继相同
+struct UdpRelay::BatchIo {
+    static constexpr int kBatch    = 64;    // 每次 recvmmsg 最多收取
+    static constexpr int kSlotSize = 2048;  // 单个数据报上限（分片 ~1.3KB），超长按坏包丢弃
+    static constexpr int kTxBatch  = 256;   // 攒满即 sendmmsg
+    static constexpr int kMaxRounds = 16;   // 单次就绪最多收取轮数，避免饿死事件循环
+
+    int fd = -1;
+    QSocketNotifier* notifier = nullptr;
+
+    char        rxBuf[kBatch][kSlotSize];
+    iovec       rxIov[kBatch];
+    sockaddr_in rxFrom[kBatch];
+    mmsghdr     rxMsgs[kBatch];
+
+    iovec       txIov[kTxBatch];
+    sockaddr_in txTo[kTxBatch];
+    mmsghdr     txMsgs[kTxBatch];
+    int txCount = 0;
+
+    BatchIo() {
+        memset(rxMsgs, 0, sizeof(rxMsgs));
+        memset(txMsgs, 0, sizeof(txMsgs));
+        for (int i = 0; i < kBatch; ++i) {
+            rxIov[i].iov_base = rxBuf[i];
+            rxIov[i].iov_len  = kSlotSize;
+            rxMsgs[i].msg_hdr.msg_iov    = &rxIov[i];
+            rxMsgs[i].msg_hdr.msg_iovlen = 1;
+            rxMsgs[i].msg_hdr.msg_name   = &rxFrom[i];
+        }
+        for (int i = 0; i < kTxBatch; ++i) {
+            txMsgs[i].msg_hdr.msg_iov     = &txIov[i];
+            txMsgs[i].msg_hdr.msg_iovlen  = 1;
+            txMsgs[i].msg_hdr.msg_name    = &txTo[i];
+            txMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+    }
+    ~BatchIo() { if (fd >= 0) ::close(fd); }
+};
+#else
+struct UdpRelay::BatchIo {};
+#endif
 
 UdpRelay::UdpRelay(QObject* parent) : QObject(parent)
 {
     cleanup_.setInterval(5000);
     connect(&cleanup_, &QTimer::timeout, this, &UdpRelay::onCleanup);
+    statsDump_.setInterval(10000);
+    connect(&statsDump_, &QTimer::timeout, this, &UdpRelay::onStatsDump);
 }
 
-bool UdpRelay::start(quint16 port)
+UdpRelay::~UdpRelay()
 {
-    if (!sock_.bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
-        qWarning() << "[UDP] bind failed on" << port << sock_.errorString();
-        return false;
+    delete io_;
+}
+
+bool UdpRelay::start(quint16 port, bool batched)
+{
+    if (batched && startBatched(port)) {
+        qInfo() << "[UDP] relay listening on" << port_ << "(recvmmsg/sendmmsg)";
+    } else {
+        if (!sock_.bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+            qWarning() << "[UDP] bind failed on" << port << sock_.errorString();
+            return false;
+        }
+        port_ = port;
+        connect(&sock_, &QUdpSocket::readyRead, this, &UdpRelay::onReadyRead);
+        qInfo() << "[UDP] relay listening on" << port_;
     }
-    port_ = port;
-    connect(&sock_, &QUdpSocket::readyRead, this, &UdpRelay::onReadyRead);
     cleanup_.start();
-    qInfo() << "[UDP] relay listening on" << port_;
+    statsDump_.start();
     return true;
 }
 
-bool UdpRelay::parseHeader(QDataStream& ds, quint8& ver, quint8& type)
+bool UdpRelay::startBatched(quint16 port)
 {
-    ds.setByteOrder(QDataStream::BigEndian);
-    quint32 magic=0; quint16 reserved=0;
-    ds >> magic >> ver >> type >> reserved;
-    if (ds.status()!=QDataStream::Ok) return false;
-    if (magic != kMagic) return false;
-    if (ver != 1 && ver != 2) return false; // 兼容 v1/v2
+#ifdef Q_OS_LINUX
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int bufSize = 4 * 1024 * 1024; // 突发分片较多，放大内核缓冲
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        qWarning() << "[UDP] batched bind failed on" << port << strerror(errno) << "- fallback to QUdpSocket";
+        ::close(fd);
+        return false;
+    }
+
+    io_ = new BatchIo;
+    io_->fd = fd;
+    io_->notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(io_->notifier, &QSocketNotifier::activated, this, &UdpRelay::onBatchReadable);
+    port_ = port;
     return true;
+#else
+    Q_UNUSED(port);
+    return false;
+#endif
 }
 
 void UdpRelay::onReadyRead()
 {
+    QByteArray d; // 复用同一块缓冲，只在遇到更大的数据报时扩容
     while (sock_.hasPendingDatagrams()) {
-        QByteArray d;
-        d.resize(int(sock_.pendingDatagramSize()));
+        const int size = int(sock_.pendingDatagramSize());
+        if (d.size() < size) d.resize(size);
         QHostAddress from; quint16 port=0;
-        sock_.readDatagram(d.data(), d.size(), &from, &port);
-
-        QDataStream ds(d);
-        quint8 ver=0, type=0;
-        if (!parseHeader(ds, ver, type)) continue;
-
-        if (type == 1) {
-            // register
-            QString room, user;
-            ds >> room >> user;
-            if (ds.status()!=QDataStream::Ok) continue;
-            auto& m = rooms_[room];
-            Peer p; p.addr = from; p.port = port; p.lastSeen = QDateTime::currentMSecsSinceEpoch();
-            m.insert(user, p);
-        } else if (type == 2) {
-            // video chunk - 转发给房间内其他用户
-            QString room, sender;
-            ds >> room >> sender;
-            if (ds.status()!=QDataStream::Ok) continue;
-
-            const auto now = QDateTime::currentMSecsSinceEpoch();
-            auto it = rooms_.find(room);
-            if (it != rooms_.end()) {
-                for (auto pit = it->begin(); pit != it->end(); ++pit) {
-                    const Peer& peer = pit.value();
-                    if (now - peer.lastSeen > 10000) continue;
-                    if (peer.addr == from && peer.port == port) continue;
-                    sock_.writeDatagram(d, peer.addr, peer.port);
-                }
+        const qint64 n = sock_.readDatagram(d.data(), size, &from, &port);
+        if (n < 0) continue;
+        statAdd(stats_.dgramIn, 1);
+        statAdd(stats_.bytesIn, quint64(n));
+        handleDatagram(d.constData(), int(n), from.toIPv4Address(), port,
+                       QDateTime::currentMSecsSinceEpoch());
+    }
+}
+
+void UdpRelay::onBatchReadable()
+{
+#ifdef Q_OS_LINUX
+    BatchIo& io = *io_;
+    for (int round = 0; round < BatchIo::kMaxRounds; ++round) {
+        for (int i = 0; i < BatchIo::kBatch; ++i) {
+            io.rxMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            io.rxMsgs[i].msg_hdr.msg_flags = 0;
+        }
+        const int n = ::recvmmsg(io.fd, io.rxMsgs, BatchIo::kBatch, MSG_DONTWAIT, nullptr);
+        if (n <= 0) break; // EAGAIN：已收空；其他错误留给下次就绪
+        statAdd(stats_.batches, 1);
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        for (int i = 0; i < n; ++i) {
+            const mmsghdr& m = io.rxMsgs[i];
+            statAdd(stats_.dgramIn, 1);
+            statAdd(stats_.bytesIn, quint64(m.msg_len));
+            if (m.msg_hdr.msg_flags & MSG_TRUNC) { statAdd(stats_.badHeader, 1); continue; }
+            handleDatagram(io.rxBuf[i], int(m.msg_len),
+                           ntohl(io.rxFrom[i].sin_addr.s_addr), ntohs(io.rxFrom[i].sin_port), now);
+        }
+        // 转发项引用本批接收缓冲，须在下一次 recvmmsg 之前发出
+        flushBatch();
+        if (n < BatchIo::kBatch) break;
+    }
+#endif
+}
+
+void UdpRelay::flushBatch()
+{
+#ifdef Q_OS_LINUX
+    BatchIo& io = *io_;
+    int off = 0;
+    while (off < io.txCount) {
+        const int sent = ::sendmmsg(io.fd, io.txMsgs + off, unsigned(io.txCount - off), 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                // 发送缓冲已满：UDP 媒体直接丢弃剩余部分
+                statAdd(stats_.sendErrors, quint64(io.txCount - off));
+                break;
             }
+            // 单个目的地出错（如 ICMP 不可达），跳过该项继续
+            statAdd(stats_.sendErrors, 1);
+            ++off;
+            continue;
+        }
+        quint64 bytes = 0;
+        for (int i = off; i < off + sent; ++i) bytes += io.txIov[i].iov_len;
+        statAdd(stats_.forwarded, quint64(sent));
+        statAdd(stats_.bytesOut, bytes);
+        off += sent;
+    }
+    io.txCount = 0;
+#endif
+}
+
+void UdpRelay::forward(const Peer& peer, const char* d, int len)
+{
+#ifdef Q_OS_LINUX
+    if (io_) {
+        BatchIo& io = *io_;
+        if (io.txCount == BatchIo::kTxBatch) flushBatch();
+        const int i = io.txCount++;
+        io.txIov[i].iov_base = const_cast<char*>(d);
+        io.txIov[i].iov_len  = size_t(len);
+        sockaddr_in& to = io.txTo[i];
+        memset(&to, 0, sizeof(to));
+        to.sin_family = AF_INET;
+        to.sin_port = htons(peer.port);
+        to.sin_addr.s_addr = htonl(peer.ip4);
+        return;
+    }
+#endif
+    if (sock_.writeDatagram(d, len, QHostAddress(peer.ip4), peer.port) < 0) {
+        statAdd(stats_.sendErrors, 1);
+        return;
+    }
+    statAdd(stats_.forwarded, 1);
+    statAdd(stats_.bytesOut, quint64(len));
+}
+
+void UdpRelay::handleDatagram(const char* d, int len, quint32 fromIp, quint16 fromPort, qint64 now)
+{
+    const uchar* p = reinterpret_cast<const uchar*>(d);
+    const uchar* end = p + len;
+    quint8 ver=0, type=0;
+    if (!readUdmHeader(p, len, ver, type)) { statAdd(stats_.badHeader, 1); return; }
+
+    if ((type == UDM_CHUNK || type == UDM_PARITY) && ver >= UDM_V3) {
+        // v3：会话 id 直接定位发送方及其房间，无字符串解析（FEC 校验分片同样转发）
+        if (len < kUdmHeaderSize + 4) { statAdd(stats_.badHeader, 1); return; }
+        statAdd(stats_.chunksIn, 1);
+        const int idx = sessionIndex(qFromBigEndian<quint32>(p + kUdmHeaderSize));
+        if (idx < 0) { statAdd(stats_.badSession, 1); return; }
+        Session& s = sessions_[idx];
+        // 只接受会话登记端点发出的分片，防止伪造 id 注入
+        if (s.peer.ip4 != fromIp || s.peer.port != fromPort) { statAdd(stats_.badSession, 1); return; }
+        if (type == UDM_CHUNK) cacheChunk(s, d, len);
+        forwardToRoom(s.room, idx, fromIp, fromPort, d, len, now);
+        return;
+    }
+    if (type == UDM_NACK && ver >= UDM_V3) {
+        handleNack(p, len, fromIp, fromPort, now);
+        return;
+    }
+    if (type == UDM_FEEDBACK && ver >= UDM_V3) {
+        handleFeedback(d, len, fromIp, fromPort);
+        return;
+    }
+
+    p += kUdmHeaderSize;
+    const uchar* roomRaw = nullptr; int roomBytes = 0;
+    if (!readRawString(p, end, roomRaw, roomBytes)) { statAdd(stats_.badHeader, 1); return; }
+
+    if (type == UDM_REGISTER) {
+        const uchar* userRaw = nullptr; int userBytes = 0;
+        if (!readRawString(p, end, userRaw, userBytes)) { statAdd(stats_.badHeader, 1); return; }
+        registerPeer(decodeUtf16BE(roomRaw, roomBytes), decodeUtf16BE(userRaw, userBytes),
+                     fromIp, fromPort, now);
+    } else if (type == UDM_CHUNK) {
+        // v1/v2 分片 - 按房间名转发给房间内其他用户（sender 字段无需解析）
+        statAdd(stats_.chunksIn, 1);
+
+        int room = -1;
+        if (lastRoom_ >= 0 && lastRoomRaw_.size() == roomBytes &&
+            memcmp(lastRoomRaw_.constData(), roomRaw, size_t(roomBytes)) == 0) {
+            room = lastRoom_;
+        } else {
+            room = roomIndex_.value(decodeUtf16BE(roomRaw, roomBytes), -1);
+            if (room < 0) { statAdd(stats_.noRoom, 1); return; }
+            lastRoomRaw_ = QByteArray(reinterpret_cast<const char*>(roomRaw), roomBytes);
+            lastRoom_ = room;
+        }
+        forwardToRoom(room, -1, fromIp, fromPort, d, len, now);
+    }
+}
+
+void UdpRelay::forwardToRoom(int room, int exceptSession, quint32 fromIp, quint16 fromPort,
+                             const char* d, int len, qint64 now)
+{
+    for (int m : roomSlots_[room].members) {
+        if (m == exceptSession) continue;
+        const Peer& peer = sessions_[m].peer;
+        if (now - peer.lastSeen > 10000) continue;
+        if (peer.ip4 == fromIp && peer.port == fromPort) continue;
+        forward(peer, d, len);
+    }
+}
+
+int UdpRelay::sessionIndex(quint32 id) const
+{
+    const int idx = int(id & 0xFFFFu);
+    if (id == 0 || idx >= sessions_.size() || sessions_[idx].id != id) return -1;
+    return idx;
+}
+
+void UdpRelay::registerPeer(const QString& roomName, const QString& user,
+                            quint32 fromIp, quint16 fromPort, qint64 now)
+{
+    statAdd(stats_.registers, 1);
+
+    int room = roomIndex_.value(roomName, -1);
+    // 新用户需要会话槽：先查容量，满时不建房（空房间只在 releaseSession 中回收）
+    if ((room < 0 || !roomSlots_[room].byUser.contains(user)) &&
+        freeSessions_.isEmpty() && sessions_.size() >= kMaxSessions) {
+        qWarning() << "[UDP] session table full, drop register from" << user;
+        return;
+    }
+    if (room < 0) {
+        if (!freeRooms_.isEmpty()) {
+            room = freeRooms_.takeLast();
+        } else {
+            room = roomSlots_.size();
+            roomSlots_.append(Room());
+        }
+        roomSlots_[room].name = roomName;
+        roomIndex_.insert(roomName, room);
+    }
+
+    int idx = roomSlots_[room].byUser.value(user, -1);
+    const bool fresh = idx < 0;
+    if (fresh) {
+        if (!freeSessions_.isEmpty()) {
+            idx = freeSessions_.takeLast();
+        } else {
+            idx = sessions_.size();
+            sessions_.append(Session());
         }
+        Session& s = sessions_[idx];
+        s.gen = quint16(s.gen + 1);
+        if (s.gen == 0) s.gen = 1;
+        s.id = (quint32(s.gen) << 16) | quint32(idx);
+        s.room = room;
+        s.user = user;
+        roomSlots_[room].members.append(idx);
+        roomSlots_[room].byUser.insert(user, idx);
+    }
+
+    Session& s = sessions_[idx];
+    s.peer.ip4 = fromIp;
+    s.peer.port = fromPort;
+    s.peer.lastSeen = now;
+
+    // 回执：分配的会话 id + 房间名单（心跳时也回，客户端据此恢复）；新成员加入时向其他人推送名单
+    sendDirect(s.peer, buildRoster(room, s.id));
+    if (fresh) {
+        const QByteArray update = buildRoster(room, 0);
+        for (int m : roomSlots_[room].members)
+            if (m != idx) sendDirect(sessions_[m].peer, update);
     }
 }
 
+void UdpRelay::releaseSession(int idx)
+{
+    Session& s = sessions_[idx];
+    const int room = s.room;
+    Room& r = roomSlots_[room];
+    r.members.removeOne(idx);
+    r.byUser.remove(s.user);
+    s.id = 0;
+    s.room = -1;
+    s.user.clear();
+    s.retrans.clear();
+    s.nackBudgetUsed = 0;
+    freeSessions_.append(idx);
+
+    if (r.members.isEmpty()) {
+        roomIndex_.remove(r.name);
+        r = Room();
+        freeRooms_.append(room);
+        if (lastRoom_ == room) lastRoom_ = -1;
+    }
+}
+
+QByteArray UdpRelay::buildRoster(int room, quint32 yourSession) const
+{
+    const Room& r = roomSlots_[room];
+    QByteArray d(kUdmHeaderSize, Qt::Uninitialized);
+    writeUdmHeader(reinterpret_cast<uchar*>(d.data()), UDM_V3, UDM_ROSTER);
+    QDataStream ds(&d, QIODevice::WriteOnly | QIODevice::Append);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << yourSession << quint16(r.members.size());
+    for (int m : r.members) ds << sessions_[m].id << sessions_[m].user;
+    return d;
+}
+
+void UdpRelay::sendDirect(const Peer& peer, const char* d, int len)
+{
+#ifdef Q_OS_LINUX
+    if (io_) {
+        sockaddr_in to;
+        memset(&to, 0, sizeof(to));
+        to.sin_family = AF_INET;
+        to.sin_port = htons(peer.port);
+        to.sin_addr.s_addr = htonl(peer.ip4);
+        if (::sendto(io_->fd, d, size_t(len), 0,
+                     reinterpret_cast<const sockaddr*>(&to), sizeof(to)) < 0)
+            statAdd(stats_.sendErrors, 1);
+        return;
+    }
+#endif
+    if (sock_.writeDatagram(d, len, QHostAddress(peer.ip4), peer.port) < 0)
+        statAdd(stats_.sendErrors, 1);
+}
+
+void UdpRelay::cacheChunk(Session& s, const char* d, int len)
+{
+    if (len < kUdmChunkV3Size) return;
+    const uchar* p = reinterpret_cast<const uchar*>(d) + kUdmHeaderSize + 4;
+    s.retrans.put(qFromBigEndian<quint32>(p), qFromBigEndian<quint16>(p + 4), d, len);
+}
+
+void UdpRelay::handleNack(const uchar* p, int len, quint32 fromIp, quint16 fromPort, qint64 now)
+{
+    if (len < kUdmNackFixedSize) { statAdd(stats_.badHeader, 1); return; }
+    statAdd(stats_.nacks, 1);
+    p += kUdmHeaderSize;
+    const int me = sessionIndex(qFromBigEndian<quint32>(p));
+    const int src = sessionIndex(qFromBigEndian<quint32>(p + 4));
+    const quint32 fid = qFromBigEndian<quint32>(p + 8);
+    int n = qFromBigEndian<quint16>(p + 12);
+    p += 14;
+    if (me < 0 || src < 0) { statAdd(stats_.badSession, 1); return; }
+    Session& req = sessions_[me];
+    const Session& sender = sessions_[src];
+    if (req.peer.ip4 != fromIp || req.peer.port != fromPort || req.room != sender.room) {
+        statAdd(stats_.badSession, 1);
+        return;
+    }
+    n = qMin(n, qMin(kUdmMaxNackIdx, (len - kUdmNackFixedSize) / 2));
+    if (sender.retrans.isEmpty()) { statAdd(stats_.nackMiss, quint64(n)); return; }
+
+    // 每秒补发配额：丢包严重时宁可等关键帧，也不放大流量
+    if (now - req.nackWindowMs >= 1000) {
+        req.nackWindowMs = now;
+        req.nackBudgetUsed = 0;
+    }
+    for (int i = 0; i < n; ++i) {
+        const quint16 idx = qFromBigEndian<quint16>(p + i * 2);
+        int slotLen = 0;
+        const char* data = sender.retrans.find(fid, idx, &slotLen);
+        if (!data) { statAdd(stats_.nackMiss, 1); continue; }
+        if (req.nackBudgetUsed >= kRetransPerSec) { statAdd(stats_.nackLimited, quint64(n - i)); break; }
+        ++req.nackBudgetUsed;
+        // 缓存槽可能被同批后续分片覆盖，补发不走批量队列，立即发出
+        sendDirect(req.peer, data, slotLen);
+        statAdd(stats_.retransmits, 1);
+    }
+}
+
+// 接收报告原样转给发送方（同房间、端点与会话一致才转发）
+void UdpRelay::handleFeedback(const char* d, int len, quint32 fromIp, quint16 fromPort)
+{
+    if (len < kUdmFeedbackSize) { statAdd(stats_.badHeader, 1); return; }
+    const uchar* p = reinterpret_cast<const uchar*>(d) + kUdmHeaderSize;
+    const int me = sessionIndex(qFromBigEndian<quint32>(p));
+    const int src = sessionIndex(qFromBigEndian<quint32>(p + 4));
+    if (me < 0 || src < 0) { statAdd(stats_.badSession, 1); return; }
+    const Session& req = sessions_[me];
+    const Session& sender = sessions_[src];
+    if (req.peer.ip4 != fromIp || req.peer.port != fromPort || req.room != sender.room) {
+        statAdd(stats_.badSession, 1);
+        return;
+    }
+    statAdd(stats_.feedbacks, 1);
+    if (p[8] & UDM_FB_KEYFRAME) statAdd(stats_.keyRequests, 1);
+    sendDirect(sender.peer, d, len);
+}
+
 void UdpRelay::onCleanup()
 {
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
-    QStringList emptyRooms;
-    for (auto it = rooms_.begin(); it != rooms_.end(); ++it) {
-        QStringList rmUsers;
-        for (auto pit = it->begin(); pit != it->end(); ++pit) {
-            if (now - pit->lastSeen > 15000) rmUsers << pit.key();
-        }
-        for (const auto& u : rmUsers) it->remove(u);
-        if (it->isEmpty()) emptyRooms << it.key();
+    for (int i = 0; i < sessions_.size(); ++i) {
+        if (sessions_[i].id != 0 && now - sessions_[i].peer.lastSeen > 15000)
+            releaseSession(i);
     }
-    for (const auto& k : emptyRooms) rooms_.remove(k);
-}
\ No newline at end of file
+}
+QJsonObject UdpRelay::statsJson() const
+{
+    return QJsonObject{
+        {"dgramIn",    double(stats_.dgramIn.load())},
+        {"bytesIn",    double(stats_.bytesIn.load())},
+        {"registers",  double(stats_.registers.load())},
+        {"chunksIn",   double(stats_.chunksIn.load())},
+        {"forwarded",  double(stats_.forwarded.load())},
+        {"bytesOut",   double(stats_.bytesOut.load())},
+        {"badHeader",  double(stats_.badHeader.load())},
+        {"noRoom",     double(stats_.noRoom.load())},
+        {"sendErrors", double(stats_.sendErrors.load())},
+        {"badSession", double(stats_.badSession.load())},
+        {"nacks",       double(stats_.nacks.load())},
+        {"retransmits", double(stats_.retransmits.load())},
+        {"nackMiss",    double(stats_.nackMiss.load())},
+        {"nackLimited", double(stats_.nackLimited.load())},
+        {"feedbacks",   double(stats_.feedbacks.load())},
+        {"keyRequests", double(stats_.keyRequests.load())},
+        {"batches",    double(stats_.batches.load())},
+        {"batched",    isBatched()}
+    };
+}
+
+void UdpRelay::onStatsDump()
+{
+    const quint64 in = stats_.dgramIn.load();
+    if (in == lastDumpIn_) return; // 无流量不刷屏
+    lastDumpIn_ = in;
+    qInfo().noquote() << QString("[UDP] stats in=%1/%2B chunks=%3 fwd=%4/%5B reg=%6 bad=%7 noRoom=%8 sendErr=%9 badSess=%10 batches=%11")
+                         .arg(in).arg(stats_.bytesIn.load()).arg(stats_.chunksIn.load())
+                         .arg(stats_.forwarded.load()).arg(stats_.bytesOut.load())
+                         .arg(stats_.registers.load()).arg(stats_.badHeader.load())
+                         .arg(stats_.noRoom.load()).arg(stats_.sendErrors.load())
+                         .arg(stats_.badSession.load()).arg(stats_.batches.load());
+    if (stats_.nacks.load())
+        qInfo().noquote() << QString("[UDP] nack req=%1 resent=%2 miss=%3 limited=%4")
+                             .arg(stats_.nacks.load()).arg(stats_.retransmits.load())
+                             .arg(stats_.nackMiss.load()).arg(stats_.nackLimited.load());
+    if (stats_.feedbacks.load())
+        qInfo().noquote() << QString("[UDP] feedback=%1 keyReq=%2")
+                             .arg(stats_.feedbacks.load()).arg(stats_.keyRequests.load());
+}
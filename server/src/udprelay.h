@@ -1,33 +1,108 @@
 #pragma once
 #include <QtCore>
 #include <QtNetwork>
+#include "udm.h"
+#include "retranscache.h"
 
+// UDP 媒体中继
+// - 通用路径：QUdpSocket，逐个 readDatagram/writeDatagram
+// - 注册时分配数值会话 id（UDM v3），分片按会话下标 -> 房间成员数组路由；v1/v2 仍按房间名转发
+//   v3 分片不转换为 v2，房间内的旧客户端收不到（整体升级，见 udm.h）
+// - Linux 批量路径：自建 socket + QSocketNotifier，recvmmsg 一次收一批到预分配缓冲池，
+//   sendmmsg 一次发出整批转发，热路径无逐包堆分配
 class UdpRelay : public QObject {
     Q_OBJECT
 public:
     explicit UdpRelay(QObject* parent=nullptr);
+    ~UdpRelay() override;
 
-    bool start(quint16 port);
+    // batched=true 时在 Linux 上优先使用 recvmmsg/sendmmsg，失败则回退 QUdpSocket
+    bool start(quint16 port, bool batched = true);
     quint16 port() const { return port_; }
+    bool isBatched() const { return io_ != nullptr; }
+
+    // 统计快照：原子计数，可在任意线程读取
+    QJsonObject statsJson() const;
 
 private slots:
     void onReadyRead();
+    void onBatchReadable();
     void onCleanup();
+    void onStatsDump();
 
 private:
     struct Peer {
-        QHostAddress addr;
+        quint32 ip4=0;   // 主机序 IPv4（中继只绑定 AnyIPv4）
         quint16 port=0;
         qint64 lastSeen=0;
     };
-    // roomId -> user -> Peer
-    QHash<QString, QHash<QString, Peer>> rooms_;
+    // 会话 id = (gen << 16) | 下标；槽位复用时 gen 递增，旧 id 自动失效
+    // 重传缓存见 RetransCache：每个发送方保留最近 256 个分片（按到达顺序覆盖，约 390KB），首次发送时才分配
+    static constexpr int kRetransPerSec = 256;    // 每个请求方每秒最多补发的分片数，防止放大
+    struct Session {
+        quint32 id = 0;   // 0 表示空闲
+        quint16 gen = 0;
+        int room = -1;
+        Peer peer;
+        QString user;
+        RetransCache retrans;
+        qint64 nackWindowMs = 0;
+        int nackBudgetUsed = 0;
+    };
+    struct Room {
+        QString name;
+        QVector<int> members;          // 会话下标
+        QHash<QString, int> byUser;    // 仅注册时使用
+    };
+    QVector<Session> sessions_;
+    QVector<int> freeSessions_;
+    QVector<Room> roomSlots_;
+    QVector<int> freeRooms_;
+    QHash<QString, int> roomIndex_;    // 房间名 -> roomSlots_ 下标
+    static constexpr int kMaxSessions = 0xFFFF;
+
+    void registerPeer(const QString& room, const QString& user, quint32 fromIp, quint16 fromPort, qint64 now);
+    void releaseSession(int idx);
+    int sessionIndex(quint32 id) const;
+    void forwardToRoom(int room, int exceptSession, quint32 fromIp, quint16 fromPort,
+                       const char* d, int len, qint64 now);
+    QByteArray buildRoster(int room, quint32 yourSession) const;
+    void sendDirect(const Peer& peer, const QByteArray& d) { sendDirect(peer, d.constData(), d.size()); }
+    void sendDirect(const Peer& peer, const char* d, int len);
+    void cacheChunk(Session& s, const char* d, int len);
+    void handleNack(const uchar* p, int len, quint32 fromIp, quint16 fromPort, qint64 now);
+    void handleFeedback(const char* d, int len, quint32 fromIp, quint16 fromPort);
+
     QUdpSocket sock_;
     quint16 port_{0};
     QTimer cleanup_;
+    QTimer statsDump_;
+
+    // 批量收发上下文（仅 Linux，定义见 .cpp）
+    struct BatchIo;
+    BatchIo* io_ = nullptr;
+    bool startBatched(quint16 port);
+    void flushBatch();
+
+    // v1/v2 分片：最近一次命中的房间，同一房间的连续分片直接比较原始名字节，免去 QString 解码与哈希
+    // 房间释放时失效
+    QByteArray lastRoomRaw_;
+    int lastRoom_ = -1;
 
-    // 统一的头部解析：三个参数（引用）
-    static bool parseHeader(QDataStream& ds, quint8& ver, quint8& type);
+    // 热路径计数（中继线程独写）
+    struct Stats {
+        QAtomicInteger<quint64> dgramIn{0}, bytesIn{0};
+        QAtomicInteger<quint64> registers{0}, chunksIn{0};
+        QAtomicInteger<quint64> forwarded{0}, bytesOut{0};
+        QAtomicInteger<quint64> badHeader{0}, noRoom{0}, sendErrors{0};
+        QAtomicInteger<quint64> badSession{0};
+        QAtomicInteger<quint64> nacks{0}, retransmits{0}, nackMiss{0}, nackLimited{0};
+        QAtomicInteger<quint64> feedbacks{0}, keyRequests{0};
+        QAtomicInteger<quint64> batches{0};
+    } stats_;
+    quint64 lastDumpIn_ = 0;
 
-    static constexpr quint32 kMagic = 0x55444D31; // 'UDM1'
-};
\ No newline at end of file
+    // 单个数据报的解析与路由，两条路径共用；d 仅在本次调用（批量路径为本批）内有效
+    void handleDatagram(const char* d, int len, quint32 fromIp, quint16 fromPort, qint64 now);
+    void forward(const Peer& peer, const char* d, int len);
+};